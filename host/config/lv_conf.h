@@ -0,0 +1,50 @@
+/**
+ * @file lv_conf.h
+ * @brief LVGL configuration for the host build.
+ *
+ * Follows the firmware's CONFIG_LV_* settings in sdkconfig (colour depth,
+ * fonts, refresh period, built-in allocator) so the same widgets are drawn the
+ * same way. Two differences: LVGL runs on pthreads instead of FreeRTOS, and
+ * the pool is doubled because objects on a 64-bit host carry 8-byte pointers;
+ * it then holds about as many widgets as the 48 KB pool on the ESP32-S3.
+ */
+#ifndef LV_CONF_H
+#define LV_CONF_H
+
+#define LV_COLOR_DEPTH 16
+
+#define LV_USE_STDLIB_MALLOC LV_STDLIB_BUILTIN
+#define LV_USE_STDLIB_STRING LV_STDLIB_BUILTIN
+#define LV_USE_STDLIB_SPRINTF LV_STDLIB_BUILTIN
+#define LV_MEM_SIZE (2 * 48U * 1024U)
+
+#define LV_DEF_REFR_PERIOD 33
+#define LV_USE_OS LV_OS_PTHREAD
+
+#define LV_USE_DRAW_SW 1
+#define LV_DRAW_SW_DRAW_UNIT_CNT 1
+#define LV_DRAW_SW_COMPLEX 1
+#define LV_DRAW_SW_SHADOW_CACHE_SIZE 0
+#define LV_DRAW_SW_CIRCLE_CACHE_SIZE 4
+
+#define LV_USE_LOG 0
+#define LV_USE_ASSERT_NULL 1
+#define LV_USE_ASSERT_MALLOC 1
+
+#define LV_FONT_MONTSERRAT_14 1
+#define LV_FONT_MONTSERRAT_16 1
+#define LV_FONT_MONTSERRAT_20 1
+#define LV_FONT_MONTSERRAT_22 1
+#define LV_FONT_MONTSERRAT_24 1
+#define LV_FONT_MONTSERRAT_30 1
+#define LV_FONT_DEFAULT &lv_font_montserrat_14
+#define LV_USE_FONT_PLACEHOLDER 1
+
+#define LV_USE_THEME_DEFAULT 1
+#define LV_USE_THEME_SIMPLE 1
+#define LV_USE_FLEX 1
+#define LV_USE_GRID 1
+#define LV_USE_SNAPSHOT 1
+#define LV_USE_OBSERVER 1
+
+#endif // LV_CONF_H
@@ -0,0 +1,12 @@
+#pragma once
+
+// Kconfig values for the host build. Mirrors the firmware's sdkconfig for the
+// options the UI code reads; the benchmark is always on.
+#define CONFIG_UI_BENCHMARK 1
+#define CONFIG_SCREEN_CACHE_MAX_SCREENS 4
+#define CONFIG_SCREEN_CACHE_MIN_FREE_KB 12
+#define CONFIG_TRACK_DIAGRAM_PATH "/spiffs/layout.txt"
+#define CONFIG_LVGL_TASK_CORE 1
+#define CONFIG_LVGL_TASK_PRIORITY 2
+#define CONFIG_LVGL_TASK_STACK_SIZE 16384
+#define CONFIG_FREERTOS_HZ 1000
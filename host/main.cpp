@@ -0,0 +1,51 @@
+/**
+ * @file main.cpp
+ * @brief Host (Linux) entry point: runs the UI benchmark without a board.
+ *
+ * Sets LVGL up the way app_main does, on the same panel size, buffers and
+ * flush callback, except that the panel is an in-memory framebuffer (see
+ * shim/include/LovyanGFX.hpp). Then runs display::UiBenchmark once and exits.
+ * Frame times measure the host CPU, so compare host runs with each other, not
+ * with the ESP32-S3.
+ */
+#include "display/DisplayManager.h"
+#include "display/LvglTask.h"
+#include "display/UiBenchmark.h"
+#include "ui/LvglTheme.h"
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <lvgl.h>
+#include <memory>
+
+static const char *TAG = "main";
+
+static uint32_t lv_tick_ms_cb() { return static_cast<uint32_t>(esp_timer_get_time() / 1000ULL); }
+
+int main() {
+  lv_init();
+  lv_tick_set_cb(lv_tick_ms_cb);
+
+  DisplayManager::gfx.begin();
+  DisplayManager::gfx.setRotation(0);
+  DisplayManager::gfx.fillScreen(TFT_BLACK);
+
+  display::LvglLock lvglLock;
+  auto theme = std::make_shared<ui::LvglTheme>("Default");
+  ui::LvglTheme::setActive(theme);
+
+  auto buffer_size = DisplayManager::bufferSize();
+  lv_color_t *buf1 = new lv_color_t[buffer_size];
+  lv_color_t *buf2 = new lv_color_t[buffer_size];
+  lv_display_t *disp = lv_display_create(DisplayManager::gfx.screenWidth, DisplayManager::gfx.screenHeight);
+  if (!disp) {
+    ESP_LOGE(TAG, "lv_display_create failed");
+    return 1;
+  }
+  lv_display_set_default(disp);
+  lv_display_set_buffers(disp, buf1, buf2, buffer_size * sizeof(lv_color_t), LV_DISPLAY_RENDER_MODE_PARTIAL);
+  lv_display_set_flush_cb(disp, DisplayManager::disp_flush);
+
+  display::UiBenchmark::instance()->run();
+  return 0;
+}
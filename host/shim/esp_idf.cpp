@@ -0,0 +1,238 @@
+/**
+ * @file esp_idf.cpp
+ * @brief ESP-IDF services for the host build: logging, time, heap, NVS,
+ * Wi-Fi and lwIP address helpers.
+ *
+ * Only what the host-built UI code calls is here. NVS is an in-memory map that
+ * starts empty on every run, so the UI behaves as on a freshly erased board
+ * (no saved Wi-Fi networks or DCC-EX server). Wi-Fi scans find nothing.
+ */
+#include <esp_err.h>
+#include <esp_heap_caps.h>
+#include <esp_log.h>
+#include <esp_system.h>
+#include <esp_timer.h>
+#include <esp_wifi.h>
+#include <lwip/ip4_addr.h>
+#include <nvs_flash.h>
+#include <nvs_handle.hpp>
+
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace {
+
+// namespace -> key -> value bytes
+using NvsNamespace = std::map<std::string, std::vector<uint8_t>>;
+std::mutex nvsMutex;
+std::map<std::string, NvsNamespace> nvsStore;
+
+} // namespace
+
+void esp_log_write(esp_log_level_t level, const char *tag, const char *format, ...) {
+  static const char kLetters[] = "NEWIDV";
+  if (level > ESP_LOG_INFO) {
+    return;
+  }
+  flockfile(stdout);
+  printf("%c (%lld) %s: ", kLetters[level], static_cast<long long>(esp_timer_get_time() / 1000), tag);
+  va_list args;
+  va_start(args, format);
+  vprintf(format, args);
+  va_end(args);
+  putchar('\n');
+  funlockfile(stdout);
+}
+
+const char *esp_err_to_name(esp_err_t code) {
+  switch (code) {
+  case ESP_OK:
+    return "ESP_OK";
+  case ESP_FAIL:
+    return "ESP_FAIL";
+  case ESP_ERR_NO_MEM:
+    return "ESP_ERR_NO_MEM";
+  case ESP_ERR_INVALID_ARG:
+    return "ESP_ERR_INVALID_ARG";
+  case ESP_ERR_INVALID_STATE:
+    return "ESP_ERR_INVALID_STATE";
+  case ESP_ERR_INVALID_SIZE:
+    return "ESP_ERR_INVALID_SIZE";
+  case ESP_ERR_NOT_FOUND:
+    return "ESP_ERR_NOT_FOUND";
+  case ESP_ERR_NOT_SUPPORTED:
+    return "ESP_ERR_NOT_SUPPORTED";
+  case ESP_ERR_TIMEOUT:
+    return "ESP_ERR_TIMEOUT";
+  case ESP_ERR_NVS_NOT_FOUND:
+    return "ESP_ERR_NVS_NOT_FOUND";
+  case ESP_ERR_NVS_READ_ONLY:
+    return "ESP_ERR_NVS_READ_ONLY";
+  case ESP_ERR_NVS_INVALID_LENGTH:
+    return "ESP_ERR_NVS_INVALID_LENGTH";
+  case ESP_ERR_WIFI_NOT_INIT:
+    return "ESP_ERR_WIFI_NOT_INIT";
+  default:
+    return "UNKNOWN ERROR";
+  }
+}
+
+int64_t esp_timer_get_time(void) {
+  static const auto start = std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) { return timer ? ESP_ERR_INVALID_STATE : ESP_ERR_INVALID_ARG; }
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) { return timer ? ESP_OK : ESP_ERR_INVALID_ARG; }
+
+void *heap_caps_malloc(size_t size, uint32_t caps) {
+  (void)caps;
+  return malloc(size);
+}
+
+void heap_caps_free(void *ptr) { free(ptr); }
+
+size_t heap_caps_get_free_size(uint32_t caps) {
+  (void)caps;
+  return 0;
+}
+
+size_t heap_caps_get_largest_free_block(uint32_t caps) {
+  (void)caps;
+  return 0;
+}
+
+void esp_restart(void) {
+  ESP_LOGW("HOST", "esp_restart() called, exiting");
+  fflush(stdout);
+  exit(0);
+}
+
+esp_err_t esp_wifi_start(void) { return ESP_OK; }
+
+esp_err_t esp_wifi_get_country(wifi_country_t *country) {
+  *country = wifi_country_t{{'0', '1', 0}, 1, 13, 20};
+  return ESP_OK;
+}
+
+esp_err_t esp_wifi_scan_start(const wifi_scan_config_t *config, bool block) {
+  (void)config;
+  (void)block;
+  return ESP_OK;
+}
+
+esp_err_t esp_wifi_scan_get_ap_num(uint16_t *number) {
+  *number = 0;
+  return ESP_OK;
+}
+
+esp_err_t esp_wifi_scan_get_ap_records(uint16_t *number, wifi_ap_record_t *ap_records) {
+  (void)ap_records;
+  *number = 0;
+  return ESP_OK;
+}
+
+esp_err_t esp_wifi_clear_ap_list(void) { return ESP_OK; }
+
+char *ip4addr_ntoa_r(const ip4_addr_t *addr, char *buf, int buflen) {
+  in_addr in{};
+  in.s_addr = addr->addr;
+  return inet_ntop(AF_INET, &in, buf, static_cast<socklen_t>(buflen)) ? buf : nullptr;
+}
+
+int ip4addr_aton(const char *cp, ip4_addr_t *addr) {
+  in_addr in{};
+  if (inet_aton(cp, &in) == 0) {
+    return 0;
+  }
+  if (addr) {
+    addr->addr = in.s_addr;
+  }
+  return 1;
+}
+
+esp_err_t nvs_flash_init(void) { return ESP_OK; }
+
+esp_err_t nvs_flash_erase(void) {
+  std::lock_guard<std::mutex> lock(nvsMutex);
+  nvsStore.clear();
+  return ESP_OK;
+}
+
+namespace nvs {
+
+std::unique_ptr<NVSHandle> open_nvs_handle(const char *ns_name, nvs_open_mode_t open_mode, esp_err_t *err,
+                                           const char *partition_name) {
+  (void)partition_name;
+  std::lock_guard<std::mutex> lock(nvsMutex);
+  if (open_mode == NVS_READONLY && nvsStore.find(ns_name) == nvsStore.end()) {
+    if (err) {
+      *err = ESP_ERR_NVS_NOT_FOUND;
+    }
+    return nullptr;
+  }
+  nvsStore[ns_name];
+  if (err) {
+    *err = ESP_OK;
+  }
+  return std::make_unique<NVSHandle>(ns_name, open_mode);
+}
+
+esp_err_t NVSHandle::set_blob(const char *key, const void *blob, size_t len) {
+  if (mode_ == NVS_READONLY) {
+    return ESP_ERR_NVS_READ_ONLY;
+  }
+  std::lock_guard<std::mutex> lock(nvsMutex);
+  const auto *bytes = static_cast<const uint8_t *>(blob);
+  nvsStore[ns_][key].assign(bytes, bytes + len);
+  return ESP_OK;
+}
+
+esp_err_t NVSHandle::set_string(const char *key, const char *value) { return set_blob(key, value, strlen(value) + 1); }
+
+esp_err_t NVSHandle::get_bytes(const char *key, void *out, size_t *len) {
+  std::lock_guard<std::mutex> lock(nvsMutex);
+  const NvsNamespace &items = nvsStore[ns_];
+  const auto it = items.find(key);
+  if (it == items.end()) {
+    return ESP_ERR_NVS_NOT_FOUND;
+  }
+  if (it->second.size() > *len) {
+    return ESP_ERR_NVS_INVALID_LENGTH;
+  }
+  memcpy(out, it->second.data(), it->second.size());
+  *len = it->second.size();
+  return ESP_OK;
+}
+
+esp_err_t NVSHandle::get_blob(const char *key, void *blob, size_t len) { return get_bytes(key, blob, &len); }
+
+esp_err_t NVSHandle::get_string(const char *key, char *out, size_t len) { return get_bytes(key, out, &len); }
+
+esp_err_t NVSHandle::erase_item(const char *key) {
+  if (mode_ == NVS_READONLY) {
+    return ESP_ERR_NVS_READ_ONLY;
+  }
+  std::lock_guard<std::mutex> lock(nvsMutex);
+  return nvsStore[ns_].erase(key) ? ESP_OK : ESP_ERR_NVS_NOT_FOUND;
+}
+
+esp_err_t NVSHandle::erase_all() {
+  if (mode_ == NVS_READONLY) {
+    return ESP_ERR_NVS_READ_ONLY;
+  }
+  std::lock_guard<std::mutex> lock(nvsMutex);
+  nvsStore[ns_].clear();
+  return ESP_OK;
+}
+
+} // namespace nvs
@@ -0,0 +1,181 @@
+/**
+ * @file freertos.cpp
+ * @brief FreeRTOS tasks, semaphores and event groups for the host build.
+ *
+ * Each task is a detached std::thread. vTaskDelete(nullptr) unwinds the
+ * calling task back to its trampoline with an exception, which is how every
+ * firmware task ends. Blocking calls honour their tick timeouts, with one tick
+ * equal to portTICK_PERIOD_MS of wall time.
+ */
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#include <esp_timer.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+
+struct tskTaskControlBlock {
+  std::string name;
+};
+
+struct QueueDefinition {
+  std::mutex mutex;
+  std::condition_variable cv;
+  UBaseType_t count;
+};
+
+struct EventGroupDef_t {
+  std::mutex mutex;
+  std::condition_variable cv;
+  EventBits_t bits = 0;
+};
+
+namespace {
+
+// Thrown by vTaskDelete(nullptr); caught only by task_trampoline.
+struct TaskDeleted {};
+
+tskTaskControlBlock mainTask{"main"};
+thread_local tskTaskControlBlock *currentTask = &mainTask;
+
+std::chrono::milliseconds ticksToDuration(TickType_t ticks) {
+  return std::chrono::milliseconds(static_cast<uint64_t>(ticks) * portTICK_PERIOD_MS);
+}
+
+// Waits on cv until pred holds or the tick timeout passes; portMAX_DELAY
+// waits forever. Returns the final value of pred.
+template <typename Pred>
+bool waitTicks(std::condition_variable &cv, std::unique_lock<std::mutex> &lock, TickType_t ticks, Pred pred) {
+  if (ticks == portMAX_DELAY) {
+    cv.wait(lock, pred);
+    return true;
+  }
+  return cv.wait_for(lock, ticksToDuration(ticks), pred);
+}
+
+void task_trampoline(tskTaskControlBlock *task, TaskFunction_t code, void *param) {
+  currentTask = task;
+  try {
+    code(param);
+  } catch (const TaskDeleted &) {
+  }
+  delete task;
+}
+
+} // namespace
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t pxTaskCode, const char *pcName, uint32_t usStackDepth,
+                                   void *pvParameters, UBaseType_t uxPriority, TaskHandle_t *pxCreatedTask,
+                                   BaseType_t xCoreID) {
+  (void)usStackDepth;
+  (void)uxPriority;
+  (void)xCoreID;
+  auto *task = new tskTaskControlBlock{pcName ? pcName : ""};
+  if (pxCreatedTask) {
+    *pxCreatedTask = task;
+  }
+  std::thread(task_trampoline, task, pxTaskCode, pvParameters).detach();
+  return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t pxTaskCode, const char *pcName, uint32_t usStackDepth, void *pvParameters,
+                       UBaseType_t uxPriority, TaskHandle_t *pxCreatedTask) {
+  return xTaskCreatePinnedToCore(pxTaskCode, pcName, usStackDepth, pvParameters, uxPriority, pxCreatedTask, 0);
+}
+
+void vTaskDelete(TaskHandle_t xTaskToDelete) {
+  if (xTaskToDelete == nullptr || xTaskToDelete == currentTask) {
+    throw TaskDeleted{};
+  }
+  // Deleting another task is not supported; the firmware never does it.
+  std::terminate();
+}
+
+void vTaskDelay(TickType_t xTicksToDelay) {
+  if (xTicksToDelay == 0) {
+    std::this_thread::yield();
+    return;
+  }
+  std::this_thread::sleep_for(ticksToDuration(xTicksToDelay));
+}
+
+TickType_t xTaskGetTickCount(void) { return static_cast<TickType_t>(esp_timer_get_time() / 1000 / portTICK_PERIOD_MS); }
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) { return currentTask; }
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) { return new QueueDefinition{{}, {}, 1}; }
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void) { return new QueueDefinition{{}, {}, 0}; }
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t xSemaphore, TickType_t xBlockTime) {
+  std::unique_lock<std::mutex> lock(xSemaphore->mutex);
+  if (!waitTicks(xSemaphore->cv, lock, xBlockTime, [&] { return xSemaphore->count > 0; })) {
+    return pdFALSE;
+  }
+  --xSemaphore->count;
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t xSemaphore) {
+  {
+    std::lock_guard<std::mutex> lock(xSemaphore->mutex);
+    if (xSemaphore->count > 0) {
+      return pdFALSE;
+    }
+    xSemaphore->count = 1;
+  }
+  xSemaphore->cv.notify_one();
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t xSemaphore, BaseType_t *pxHigherPriorityTaskWoken) {
+  if (pxHigherPriorityTaskWoken) {
+    *pxHigherPriorityTaskWoken = pdFALSE;
+  }
+  return xSemaphoreGive(xSemaphore);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t xSemaphore) { delete xSemaphore; }
+
+EventGroupHandle_t xEventGroupCreate(void) { return new EventGroupDef_t; }
+
+void vEventGroupDelete(EventGroupHandle_t xEventGroup) { delete xEventGroup; }
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t xEventGroup, EventBits_t uxBitsToSet) {
+  EventBits_t bits;
+  {
+    std::lock_guard<std::mutex> lock(xEventGroup->mutex);
+    bits = xEventGroup->bits |= uxBitsToSet;
+  }
+  xEventGroup->cv.notify_all();
+  return bits;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t xEventGroup, EventBits_t uxBitsToClear) {
+  std::lock_guard<std::mutex> lock(xEventGroup->mutex);
+  const EventBits_t bits = xEventGroup->bits;
+  xEventGroup->bits &= ~uxBitsToClear;
+  return bits;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t xEventGroup, EventBits_t uxBitsToWaitFor, BaseType_t xClearOnExit,
+                                BaseType_t xWaitForAllBits, TickType_t xTicksToWait) {
+  std::unique_lock<std::mutex> lock(xEventGroup->mutex);
+  auto satisfied = [&] {
+    const EventBits_t set = xEventGroup->bits & uxBitsToWaitFor;
+    return xWaitForAllBits ? set == uxBitsToWaitFor : set != 0;
+  };
+  const bool ok = waitTicks(xEventGroup->cv, lock, xTicksToWait, satisfied);
+  const EventBits_t bits = xEventGroup->bits;
+  if (ok && xClearOnExit) {
+    xEventGroup->bits &= ~uxBitsToWaitFor;
+  }
+  return bits;
+}
@@ -0,0 +1,192 @@
+#pragma once
+
+// Host stand-in for LovyanGFX. The device keeps the panel in an RGB565
+// framebuffer in memory: pushImageDMA() copies each flushed area into it, so
+// DisplayManager::disp_flush does the same per-pixel work as on the panel,
+// minus the SPI transfer. The bus, backlight and touch parts only hold their
+// configuration; there is no touch input.
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+typedef enum {
+  SPI1_HOST = 0,
+  SPI2_HOST = 1,
+  SPI3_HOST = 2,
+} spi_host_device_t;
+
+enum {
+  SPI_DMA_DISABLED = 0,
+  SPI_DMA_CH_AUTO = 3,
+};
+
+#define TFT_BLACK 0x0000
+#define TFT_WHITE 0xFFFF
+
+namespace lgfx {
+
+struct rgb565_t {
+  uint16_t raw;
+};
+
+class Bus_SPI {
+public:
+  struct config_t {
+    spi_host_device_t spi_host = SPI2_HOST;
+    uint8_t spi_mode = 0;
+    uint32_t freq_write = 16000000;
+    uint32_t freq_read = 8000000;
+    bool spi_3wire = true;
+    bool use_lock = true;
+    int dma_channel = SPI_DMA_DISABLED;
+    int16_t pin_sclk = -1;
+    int16_t pin_mosi = -1;
+    int16_t pin_miso = -1;
+    int16_t pin_dc = -1;
+  };
+
+  const config_t &config() const { return cfg_; }
+  void config(const config_t &cfg) { cfg_ = cfg; }
+
+private:
+  config_t cfg_;
+};
+
+class Light_PWM {
+public:
+  struct config_t {
+    int16_t pin_bl = -1;
+    bool invert = false;
+    uint32_t freq = 1200;
+    uint8_t pwm_channel = 7;
+  };
+
+  const config_t &config() const { return cfg_; }
+  void config(const config_t &cfg) { cfg_ = cfg; }
+
+private:
+  config_t cfg_;
+};
+
+class Touch_XPT2046 {
+public:
+  struct config_t {
+    spi_host_device_t spi_host = SPI2_HOST;
+    uint32_t freq = 1000000;
+    int16_t pin_sclk = -1;
+    int16_t pin_mosi = -1;
+    int16_t pin_miso = -1;
+    int16_t pin_cs = -1;
+    int16_t pin_int = -1;
+    uint16_t x_min = 0;
+    uint16_t x_max = 4095;
+    uint16_t y_min = 0;
+    uint16_t y_max = 4095;
+    uint8_t offset_rotation = 0;
+    bool bus_shared = true;
+  };
+
+  const config_t &config() const { return cfg_; }
+  void config(const config_t &cfg) { cfg_ = cfg; }
+
+private:
+  config_t cfg_;
+};
+
+class Panel_ILI9488 {
+public:
+  struct config_t {
+    int16_t pin_cs = -1;
+    int16_t pin_rst = -1;
+    int16_t pin_busy = -1;
+    uint16_t panel_width = 320;
+    uint16_t panel_height = 480;
+    int16_t offset_x = 0;
+    int16_t offset_y = 0;
+    uint8_t offset_rotation = 0;
+    uint8_t dummy_read_pixel = 8;
+    uint8_t dummy_read_bits = 1;
+    bool readable = true;
+    bool invert = false;
+    bool rgb_order = false;
+    bool dlen_16bit = false;
+    bool bus_shared = true;
+  };
+
+  const config_t &config() const { return cfg_; }
+  void config(const config_t &cfg) { cfg_ = cfg; }
+
+  void setBus(Bus_SPI *bus) { bus_ = bus; }
+  void setLight(Light_PWM *light) { light_ = light; }
+  void setTouch(Touch_XPT2046 *touch) { touch_ = touch; }
+
+private:
+  config_t cfg_;
+  Bus_SPI *bus_ = nullptr;
+  Light_PWM *light_ = nullptr;
+  Touch_XPT2046 *touch_ = nullptr;
+};
+
+class LGFX_Device {
+public:
+  void setPanel(Panel_ILI9488 *panel) { panel_ = panel; }
+
+  // Allocates the framebuffer at the panel's size.
+  bool begin() {
+    width_ = panel_ ? panel_->config().panel_width : 0;
+    height_ = panel_ ? panel_->config().panel_height : 0;
+    framebuffer_.assign(static_cast<size_t>(width_) * height_, rgb565_t{0});
+    return width_ > 0 && height_ > 0;
+  }
+
+  // Only rotation 0 (the firmware's portrait orientation) is modelled.
+  void setRotation(uint8_t rotation) { rotation_ = rotation; }
+  void setBrightness(uint8_t brightness) { brightness_ = brightness; }
+  uint8_t getBrightness() const { return brightness_; }
+  int32_t width() const { return width_; }
+  int32_t height() const { return height_; }
+
+  void fillScreen(uint32_t color) { std::fill(framebuffer_.begin(), framebuffer_.end(), rgb565_t{uint16_t(color)}); }
+
+  uint32_t getStartCount() const { return startCount_; }
+  void startWrite() { ++startCount_; }
+  void endWrite() {
+    if (startCount_ > 0) {
+      --startCount_;
+    }
+  }
+
+  // Copies a w x h block of pixels to (x, y), clipped to the framebuffer. The
+  // copy is synchronous, so waitDMA() has nothing to wait for.
+  void pushImageDMA(int32_t x, int32_t y, int32_t w, int32_t h, const rgb565_t *data) {
+    const int32_t x0 = std::max<int32_t>(x, 0);
+    const int32_t x1 = std::min<int32_t>(x + w, width_);
+    if (x0 >= x1) {
+      return;
+    }
+    for (int32_t row = std::max<int32_t>(y, 0); row < std::min<int32_t>(y + h, height_); ++row) {
+      std::memcpy(&framebuffer_[static_cast<size_t>(row) * width_ + x0], &data[(row - y) * w + (x0 - x)],
+                  static_cast<size_t>(x1 - x0) * sizeof(rgb565_t));
+    }
+  }
+  void waitDMA() {}
+
+  template <typename T> bool getTouch(T *, T *) { return false; }
+  // No touch panel to calibrate: the parameters are left as they are.
+  void calibrateTouch(uint16_t *, uint32_t, uint32_t, uint8_t) {}
+
+  // Host only: the panel contents, row-major, width() x height().
+  const rgb565_t *framebuffer() const { return framebuffer_.data(); }
+
+private:
+  Panel_ILI9488 *panel_ = nullptr;
+  std::vector<rgb565_t> framebuffer_;
+  int32_t width_ = 0;
+  int32_t height_ = 0;
+  uint8_t rotation_ = 0;
+  uint8_t brightness_ = 0;
+  uint32_t startCount_ = 0;
+};
+
+} // namespace lgfx
@@ -0,0 +1,11 @@
+#pragma once
+
+// Host stand-in for driver/gpio.h: pin numbers only; there are no pins.
+#include "esp_attr.h"
+#include "esp_err.h"
+
+typedef enum {
+  GPIO_NUM_NC = -1,
+  GPIO_NUM_0 = 0,
+  GPIO_NUM_MAX = 49,
+} gpio_num_t;
@@ -0,0 +1,6 @@
+#pragma once
+
+// Host stand-in for esp_attr.h: placement attributes mean nothing off-chip.
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define EXT_RAM_BSS_ATTR
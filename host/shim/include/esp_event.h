@@ -0,0 +1,11 @@
+#pragma once
+
+// Host stand-in for esp_event.h: only the types the firmware headers name.
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+typedef const char *esp_event_base_t;
@@ -0,0 +1,17 @@
+#pragma once
+
+// Host stand-in for esp_netif.h: only the types the firmware headers name.
+#include "esp_err.h"
+#include <stdint.h>
+
+typedef struct esp_netif_obj esp_netif_t;
+
+typedef struct {
+  uint32_t addr;
+} esp_ip4_addr_t;
+
+typedef struct {
+  esp_ip4_addr_t ip;
+  esp_ip4_addr_t netmask;
+  esp_ip4_addr_t gw;
+} esp_netif_ip_info_t;
@@ -0,0 +1,14 @@
+#pragma once
+
+// Host stand-in for esp_system.h: a restart ends the process.
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void esp_restart(void) __attribute__((noreturn));
+
+#ifdef __cplusplus
+}
+#endif
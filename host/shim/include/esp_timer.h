@@ -0,0 +1,21 @@
+#pragma once
+
+// Host stand-in for esp_timer.h. Time is the monotonic clock since start-up.
+// No host-built code creates a timer, so stopping and deleting one only
+// checks the handle.
+#include "esp_err.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct esp_timer *esp_timer_handle_t;
+
+int64_t esp_timer_get_time(void);
+esp_err_t esp_timer_stop(esp_timer_handle_t timer);
+esp_err_t esp_timer_delete(esp_timer_handle_t timer);
+
+#ifdef __cplusplus
+}
+#endif
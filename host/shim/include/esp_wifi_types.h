@@ -0,0 +1,39 @@
+#pragma once
+
+// Host stand-in for esp_wifi_types.h: the scan record and configuration
+// fields the firmware reads.
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef enum {
+  WIFI_AUTH_OPEN = 0,
+  WIFI_AUTH_WEP,
+  WIFI_AUTH_WPA_PSK,
+  WIFI_AUTH_WPA2_PSK,
+  WIFI_AUTH_WPA_WPA2_PSK,
+  WIFI_AUTH_ENTERPRISE,
+  WIFI_AUTH_WPA3_PSK,
+  WIFI_AUTH_WPA2_WPA3_PSK,
+} wifi_auth_mode_t;
+
+typedef struct {
+  uint8_t bssid[6];
+  uint8_t ssid[33];
+  uint8_t primary;
+  int8_t rssi;
+  wifi_auth_mode_t authmode;
+} wifi_ap_record_t;
+
+typedef struct {
+  char cc[3];
+  uint8_t schan;
+  uint8_t nchan;
+  int8_t max_tx_power;
+} wifi_country_t;
+
+typedef struct {
+  uint8_t *ssid;
+  uint8_t *bssid;
+  uint8_t channel;
+  bool show_hidden;
+} wifi_scan_config_t;
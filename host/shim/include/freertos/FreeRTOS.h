@@ -0,0 +1,41 @@
+#pragma once
+
+// Host stand-in for FreeRTOS.h. Tasks are std::threads, semaphores and event
+// groups are built on std::mutex and std::condition_variable (see
+// host/shim/freertos.cpp). Priorities and core affinity are accepted and
+// ignored; ISR variants behave like their task versions.
+#include "esp_attr.h"
+#include "sdkconfig.h"
+#include <stddef.h>
+#include <stdint.h>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE ((BaseType_t)0)
+#define pdTRUE ((BaseType_t)1)
+#define pdFAIL pdFALSE
+#define pdPASS pdTRUE
+
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+#define portTICK_PERIOD_MS ((TickType_t)1000 / CONFIG_FREERTOS_HZ)
+#define portNUM_PROCESSORS 2
+#define pdMS_TO_TICKS(xTimeInMs) ((TickType_t)(((uint64_t)(xTimeInMs) * CONFIG_FREERTOS_HZ) / 1000U))
+#define tskIDLE_PRIORITY ((UBaseType_t)0U)
+
+#define portYIELD_FROM_ISR(x) ((void)(x))
+
+#ifdef __cplusplus
+#include <mutex>
+
+// A spinlock on the target; a plain mutex is close enough here.
+struct portMUX_TYPE {
+  std::mutex mutex;
+};
+#define portMUX_INITIALIZER_UNLOCKED {}
+#define portENTER_CRITICAL(mux) (mux)->mutex.lock()
+#define portEXIT_CRITICAL(mux) (mux)->mutex.unlock()
+#define portENTER_CRITICAL_ISR(mux) portENTER_CRITICAL(mux)
+#define portEXIT_CRITICAL_ISR(mux) portEXIT_CRITICAL(mux)
+#endif
@@ -0,0 +1,17 @@
+#pragma once
+
+// Host stand-in for freertos/queue.h: the handle type and the calls the
+// firmware headers make inline. No host-built code sends on a queue.
+#include "FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct QueueDefinition *QueueHandle_t;
+
+BaseType_t xQueueSendToBack(QueueHandle_t xQueue, const void *pvItemToQueue, TickType_t xTicksToWait);
+
+#ifdef __cplusplus
+}
+#endif
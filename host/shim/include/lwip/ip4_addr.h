@@ -0,0 +1,20 @@
+#pragma once
+
+// Host stand-in for lwip/ip4_addr.h: dotted-quad conversion of addresses
+// kept in network byte order.
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct ip4_addr {
+  uint32_t addr;
+} ip4_addr_t;
+
+char *ip4addr_ntoa_r(const ip4_addr_t *addr, char *buf, int buflen);
+int ip4addr_aton(const char *cp, ip4_addr_t *addr);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,26 @@
+#pragma once
+
+// Host stand-in for lwip/pbuf.h: the fields and calls the firmware headers
+// use inline. Nothing on the host receives packets.
+#include "err.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct pbuf {
+  struct pbuf *next;
+  void *payload;
+  uint16_t tot_len;
+  uint16_t len;
+};
+
+uint8_t pbuf_free(struct pbuf *p);
+void pbuf_chain(struct pbuf *head, struct pbuf *tail);
+uint8_t pbuf_remove_header(struct pbuf *p, size_t header_size);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,14 @@
+#pragma once
+
+// Host stand-in for lwip/priv/tcp_priv.h.
+#include "../tcp.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+err_t tcp_keepalive(struct tcp_pcb *pcb);
+
+#ifdef __cplusplus
+}
+#endif
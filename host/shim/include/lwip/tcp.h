@@ -0,0 +1,36 @@
+#pragma once
+
+// Host stand-in for lwip/tcp.h: declarations for the raw-API calls made
+// inline in connection/wifi_connection.h. The host build has no network, so
+// none of them is called and none is defined.
+#include "err.h"
+#include "pbuf.h"
+#include <stdint.h>
+
+#define SOF_KEEPALIVE 0x08U
+#define TCP_WRITE_FLAG_COPY 0x01
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct tcp_pcb {
+  uint8_t so_options;
+  uint32_t keep_idle;
+  uint32_t keep_intvl;
+  uint32_t keep_cnt;
+};
+
+typedef err_t (*tcp_recv_fn)(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err);
+typedef void (*tcp_err_fn)(void *arg, err_t err);
+
+void tcp_arg(struct tcp_pcb *pcb, void *arg);
+void tcp_recv(struct tcp_pcb *pcb, tcp_recv_fn recv);
+void tcp_err(struct tcp_pcb *pcb, tcp_err_fn err);
+err_t tcp_close(struct tcp_pcb *pcb);
+err_t tcp_write(struct tcp_pcb *pcb, const void *dataptr, uint16_t len, uint8_t apiflags);
+err_t tcp_output(struct tcp_pcb *pcb);
+
+#ifdef __cplusplus
+}
+#endif
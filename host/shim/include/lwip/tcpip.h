@@ -0,0 +1,5 @@
+#pragma once
+
+// Host stand-in for lwip/tcpip.h: there is no TCP/IP thread to lock.
+#define LOCK_TCPIP_CORE()
+#define UNLOCK_TCPIP_CORE()
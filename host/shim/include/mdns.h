@@ -0,0 +1,9 @@
+#pragma once
+
+// Host stand-in for the mdns component: the result types stay opaque, since
+// the host has no network to browse.
+#include "esp_err.h"
+#include "esp_netif.h"
+
+typedef struct mdns_result_s mdns_result_t;
+typedef struct mdns_search_once_s mdns_search_once_t;
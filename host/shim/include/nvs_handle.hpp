@@ -0,0 +1,42 @@
+#pragma once
+
+// Host stand-in for the NVS C++ API, over the in-memory store behind nvs.h.
+// Items are kept as raw bytes; get_item() and get_blob() fail with
+// ESP_ERR_NVS_INVALID_LENGTH when the stored size does not fit.
+#include "nvs.h"
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace nvs {
+
+class NVSHandle {
+public:
+  NVSHandle(std::string ns, nvs_open_mode_t mode) : ns_(std::move(ns)), mode_(mode) {}
+
+  template <typename T> esp_err_t set_item(const char *key, T value) { return set_blob(key, &value, sizeof(value)); }
+  template <typename T> esp_err_t get_item(const char *key, T &value) {
+    size_t len = sizeof(value);
+    esp_err_t err = get_bytes(key, &value, &len);
+    return err == ESP_OK && len != sizeof(value) ? ESP_ERR_NVS_INVALID_LENGTH : err;
+  }
+
+  esp_err_t set_string(const char *key, const char *value);
+  esp_err_t get_string(const char *key, char *out, size_t len);
+  esp_err_t set_blob(const char *key, const void *blob, size_t len);
+  esp_err_t get_blob(const char *key, void *blob, size_t len);
+  esp_err_t erase_item(const char *key);
+  esp_err_t erase_all();
+  esp_err_t commit() { return ESP_OK; }
+
+private:
+  esp_err_t get_bytes(const char *key, void *out, size_t *len);
+
+  std::string ns_;
+  nvs_open_mode_t mode_;
+};
+
+std::unique_ptr<NVSHandle> open_nvs_handle(const char *ns_name, nvs_open_mode_t open_mode, esp_err_t *err = nullptr,
+                                           const char *partition_name = "nvs");
+
+} // namespace nvs
@@ -0,0 +1,40 @@
+/**
+ * @file RotaryEncoder.cpp
+ * @brief Host build stand-in for utilities::RotaryEncoder.
+ *
+ * Defines only what the host-built screens call. There is no encoder, so no
+ * events are emitted; callback registration is kept so screens attach and
+ * detach as they do on the device.
+ */
+#include "utilities/RotaryEncoder.h"
+
+namespace utilities {
+
+RotaryEncoder::~RotaryEncoder() = default;
+
+void RotaryEncoder::setCallbacks(RotateCallback rotateCb, ClickCallback clickCb, LongPressCallback longPressCb,
+                                 void *userData, DoubleClickCallback doubleClickCb, bool accelerated) {
+  portENTER_CRITICAL(&callbackMux_);
+  rotateCallback_ = rotateCb;
+  accelerated_ = accelerated;
+  clickCallback_ = clickCb;
+  doubleClickCallback_ = doubleClickCb;
+  longPressCallback_ = longPressCb;
+  callbackUserData_ = userData;
+  portEXIT_CRITICAL(&callbackMux_);
+}
+
+void RotaryEncoder::clearCallbacks(void *userData) {
+  portENTER_CRITICAL(&callbackMux_);
+  if (userData == nullptr || callbackUserData_ == userData) {
+    rotateCallback_ = nullptr;
+    clickCallback_ = nullptr;
+    doubleClickCallback_ = nullptr;
+    longPressCallback_ = nullptr;
+    callbackUserData_ = nullptr;
+    accelerated_ = false;
+  }
+  portEXIT_CRITICAL(&callbackMux_);
+}
+
+} // namespace utilities
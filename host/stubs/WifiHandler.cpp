@@ -0,0 +1,40 @@
+/**
+ * @file WifiHandler.cpp
+ * @brief Host build stand-in for utilities::WifiHandler.
+ *
+ * Defines only what the host-built screens call. There is no Wi-Fi or mDNS on
+ * the host: the handler never connects and discovers no WiThrottle servers.
+ * The device registry is the real one, so screens that list servers see an
+ * empty, consistent snapshot.
+ */
+#include "utilities/WifiHandler.h"
+
+#include <esp_log.h>
+
+namespace utilities {
+
+static const char *TAG = "WIFI_HANDLER";
+
+static DeviceRegistry registry;
+
+EventGroupHandle_t WifiHandler::wifi_event_group;
+
+esp_err_t WifiHandler::saveConfiguration() { return ESP_OK; }
+
+void WifiHandler::create_wifi_connect_task(const char *ssid, const char *, bool) {
+  ESP_LOGI(TAG, "Not joining %s: no Wi-Fi on the host build", ssid);
+}
+
+bool WifiHandler::isConnected() { return connected; }
+
+std::string WifiHandler::getIpAddress() const { return ""; }
+
+DeviceRegistry::Snapshot WifiHandler::getWithrottleDevices() const { return registry.snapshot(); }
+
+uint32_t WifiHandler::withrottleDevicesVersion() const { return registry.version(); }
+
+void WifiHandler::startMdnsSearchLoop() {}
+
+void WifiHandler::stopMdnsSearchLoop() {}
+
+} // namespace utilities
@@ -0,0 +1,40 @@
+/**
+ * @file wifi_control.cpp
+ * @brief Host build stand-in for utilities::WifiControl.
+ *
+ * Defines only what the host-built screens call. Never connects, so
+ * dccProtocol() stays null and every command reports that it was not sent.
+ * Screens fill their lists from the DCCEXProtocol object lists directly, as
+ * the UI benchmark does. No loop task is started.
+ */
+#include "connection/wifi_control.h"
+
+namespace utilities {
+
+WifiControl::WifiControl() {}
+
+bool WifiControl::startConnectToServer(const char *, uint16_t, bool) { return false; }
+
+bool WifiControl::isConnectedTo(const char *, uint16_t) { return false; }
+
+void WifiControl::disconnect() { currentConnectionState = NOT_CONNECTED; }
+
+bool WifiControl::setTurnoutThrown(int, bool) { return false; }
+
+bool WifiControl::startRoute(int) { return false; }
+
+bool WifiControl::setRoutesPaused(bool) { return false; }
+
+bool WifiControl::rotateTurntableToIndex(int, int) { return false; }
+
+bool WifiControl::sendTurntableReverseCommand(int) { return false; }
+
+bool WifiControl::requestLocoSpeed(int, int, bool) { return false; }
+
+bool WifiControl::requestConsistSpeed(const ConsistMember *, size_t, int, bool) { return false; }
+
+bool WifiControl::setLocoFunction(int, int, bool) { return false; }
+
+bool WifiControl::emergencyStop() { return false; }
+
+} // namespace utilities
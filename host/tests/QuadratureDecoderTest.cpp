@@ -0,0 +1,194 @@
+/**
+ * @file QuadratureDecoderTest.cpp
+ * @brief Runtime checks for utilities::quadrature, run by ctest.
+ *
+ * Feeds edge sequences through delta() and edgeDelta() the way the two rotary
+ * encoder backends do, and reads the running count through DetentAccumulator
+ * the way RotaryEncoder's monitor task does: forward and reverse cycles,
+ * missed edges, bounce within a detent, and a pulse counter that wraps at its
+ * limits.
+ */
+#include "utilities/QuadratureDecoder.h"
+
+#include <cstdio>
+#include <vector>
+
+using namespace utilities::quadrature;
+
+namespace {
+
+int failures = 0;
+
+#define CHECK_EQ(actual, expected)                                                                                     \
+  do {                                                                                                                 \
+    const long long actualValue = (actual);                                                                            \
+    const long long expectedValue = (expected);                                                                        \
+    if (actualValue != expectedValue) {                                                                                \
+      printf("%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__, #actual, actualValue, expectedValue);           \
+      ++failures;                                                                                                      \
+    }                                                                                                                  \
+  } while (0)
+
+// States in the order A leading B passes through them, counting up.
+constexpr uint8_t kForward[4] = {0, 2, 3, 1};
+
+// Sums delta() over consecutive states, as the GPIO interrupt backend does.
+int32_t countStates(const std::vector<uint8_t> &states) {
+  int32_t count = 0;
+  for (size_t i = 1; i < states.size(); ++i) {
+    count += delta(states[i - 1], states[i]);
+  }
+  return count;
+}
+
+// The states for `detents` whole cycles from state 0, reversed if negative.
+std::vector<uint8_t> cycles(int detents) {
+  std::vector<uint8_t> states{0};
+  const int steps = (detents < 0 ? -detents : detents) * kSubStepsPerDetent;
+  for (int i = 1; i <= steps; ++i) {
+    states.push_back(kForward[(detents < 0 ? steps - i : i) % 4]);
+  }
+  return states;
+}
+
+// The pulse counter as RotaryEncoder sets it up: counts each edge with
+// edgeDelta(), resets to 0 on reaching +-limit, and (with accum_count) adds
+// what it held to the count the driver reports.
+class PulseCounter {
+public:
+  explicit PulseCounter(int32_t limit) : limit_(limit) {}
+
+  void moveTo(uint8_t state) {
+    const bool aChanged = ((state ^ state_) & 2) != 0;
+    const bool bChanged = ((state ^ state_) & 1) != 0;
+    if (aChanged) {
+      edge(edgeDelta(true, (state & 2) != 0, (state_ & 1) != 0));
+    }
+    if (bChanged) {
+      edge(edgeDelta(false, (state & 1) != 0, (state_ & 2) != 0));
+    }
+    state_ = state;
+  }
+
+  int32_t read() const { return accumulated_ + counter_; }
+  int32_t raw() const { return counter_; }
+
+private:
+  void edge(int8_t step) {
+    counter_ += step;
+    if (counter_ == limit_ || counter_ == -limit_) {
+      accumulated_ += counter_;
+      counter_ = 0;
+    }
+  }
+
+  int32_t limit_;
+  uint8_t state_ = 0;
+  int32_t counter_ = 0;
+  int32_t accumulated_ = 0;
+};
+
+void testForwardAndReverseCycles() {
+  CHECK_EQ(countStates(cycles(1)), kSubStepsPerDetent);
+  CHECK_EQ(countStates(cycles(-1)), -kSubStepsPerDetent);
+  CHECK_EQ(countStates(cycles(25)), 25 * kSubStepsPerDetent);
+  CHECK_EQ(countStates(cycles(-25)), -25 * kSubStepsPerDetent);
+
+  DetentAccumulator acc;
+  CHECK_EQ(acc.update(countStates(cycles(3))), 3);
+  CHECK_EQ(acc.update(0), -3);
+}
+
+void testEdgeDeltaMatchesDelta() {
+  // Every single-channel edge from every state counts as the table does.
+  for (uint8_t from = 0; from < 4; ++from) {
+    const bool aHigh = (from & 2) != 0;
+    const bool bHigh = (from & 1) != 0;
+    CHECK_EQ(edgeDelta(true, !aHigh, bHigh), delta(from, from ^ 2));
+    CHECK_EQ(edgeDelta(false, !bHigh, aHigh), delta(from, from ^ 1));
+  }
+
+  PulseCounter counter(1000);
+  for (const uint8_t state : cycles(5)) {
+    counter.moveTo(state);
+  }
+  CHECK_EQ(counter.read(), 5 * kSubStepsPerDetent);
+}
+
+void testMissedEdges() {
+  // Both channels changing at once (an edge lost between samples) counts 0.
+  for (uint8_t from = 0; from < 4; ++from) {
+    CHECK_EQ(delta(from, from ^ 3), 0);
+    CHECK_EQ(delta(from, from), 0);
+  }
+
+  // Losing state 3 drops the two steps either side of it, so that cycle counts
+  // 2 and the next full one carries on from there.
+  CHECK_EQ(countStates({0, 2, 1, 0}), kSubStepsPerDetent - 2);
+  CHECK_EQ(countStates({0, 2, 1, 0, 2, 3, 1, 0}), 2 * kSubStepsPerDetent - 2);
+
+  DetentAccumulator acc;
+  CHECK_EQ(acc.update(countStates({0, 2, 1, 0})), 0);
+  CHECK_EQ(acc.update(countStates({0, 2, 1, 0, 2, 3, 1, 0})), 1);
+  CHECK_EQ(acc.update(countStates({0, 2, 1, 0, 2, 3, 1, 0, 2, 3})), 1);
+}
+
+void testBounceWithinDetent() {
+  // Contact bounce on A at the first edge: up, down, up, then the rest.
+  const int32_t count = countStates({0, 2, 0, 2, 0, 2, 3, 1, 0});
+  CHECK_EQ(count, kSubStepsPerDetent);
+
+  DetentAccumulator acc;
+  CHECK_EQ(acc.update(1), 0);
+  CHECK_EQ(acc.update(0), 0);
+  CHECK_EQ(acc.update(3), 0);
+  CHECK_EQ(acc.update(2), 0);
+  CHECK_EQ(acc.update(4), 1);
+  // Back and forth inside the next detent emits nothing and loses nothing.
+  CHECK_EQ(acc.update(6), 0);
+  CHECK_EQ(acc.update(3), 0);
+  CHECK_EQ(acc.update(7), 0);
+  CHECK_EQ(acc.update(8), 1);
+  CHECK_EQ(acc.update(4), -1);
+}
+
+void testCounterWrapAtLimits() {
+  // RotaryEncoder.cpp's kPcntLimit.
+  constexpr int32_t kLimit = 1000;
+  constexpr int kDetents = 600;
+
+  for (const int direction : {1, -1}) {
+    PulseCounter counter(kLimit);
+    DetentAccumulator acc;
+    int32_t detents = 0;
+    // Read every third edge, as the monitor task polls between edges.
+    const std::vector<uint8_t> states = cycles(direction * kDetents);
+    for (size_t i = 0; i < states.size(); ++i) {
+      counter.moveTo(states[i]);
+      if (i % 3 == 0) {
+        detents += acc.update(counter.read());
+      }
+    }
+    detents += acc.update(counter.read());
+    // 2400 steps wrapped the counter twice, leaving 400 in it.
+    CHECK_EQ(counter.raw(), direction * (kDetents * kSubStepsPerDetent % kLimit));
+    CHECK_EQ(counter.read(), direction * kDetents * kSubStepsPerDetent);
+    CHECK_EQ(detents, direction * kDetents);
+  }
+}
+
+} // namespace
+
+int main() {
+  testForwardAndReverseCycles();
+  testEdgeDeltaMatchesDelta();
+  testMissedEdges();
+  testBounceWithinDetent();
+  testCounterWrapAtLimits();
+  if (failures != 0) {
+    printf("%d check(s) failed\n", failures);
+    return 1;
+  }
+  printf("All quadrature checks passed\n");
+  return 0;
+}
@@ -81,7 +81,7 @@ public:
       cfg.pin_mosi = 11;
       cfg.pin_miso = 13;
       cfg.pin_cs = 9; // T_CS
-      // cfg.pin_irq     = 6;        // T_IRQ
+      // cfg.pin_irq     = 6;        // T_IRQ (handled by utilities::TouchInput, see CONFIG_TOUCH_GPIO_PENIRQ)
 
       cfg.x_min = 200;
       cfg.x_max = 3900;
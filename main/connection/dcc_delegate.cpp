@@ -4,27 +4,29 @@
  *
  * Implements the DCCEXProtocolDelegate callbacks that DCCEXProtocol invokes
  * when it parses inbound WiThrottle packets. Each callback marshals data into
- * an lv_msg payload and schedules a send on the LVGL task via lv_async_call,
+ * an lv_msg payload and schedules a send on the LVGL task via LvglTask::asyncCall,
  * keeping the UI layer decoupled from the TCP/protocol thread.
  */
 #include "dcc_delegate.h"
 #include <esp_timer.h>
 
 #include "definitions.h"
+#include "display/LvglTask.h"
 #include "ui/lv_msg.h"
 #include <lvgl.h>
 #include <stdio.h>
 
 // lv_msg_send must be called from the LVGL task. These helpers schedule the
-// send via lv_async_call so that delegate callbacks (which fire from wifi_loop_task)
-// are safe to use.
+// send via LvglTask::asyncCall so that delegate callbacks (which fire from
+// wifi_loop_task while it holds the WifiControl state mutex) never block on the
+// LVGL lock while subscribers may be waiting on that mutex.
 namespace {
 
 // Schedules an lv_msg_send for a bare message ID (no payload) on the LVGL
 // thread.
 void async_send(uint32_t msg_id) {
   auto *id = new uint32_t(msg_id);
-  lv_async_call(
+  display::LvglTask::asyncCall(
       [](void *arg) {
         auto *id = static_cast<uint32_t *>(arg);
         lv_msg_send(*id, nullptr);
@@ -41,7 +43,7 @@ void async_send_turnout(uint32_t msg_id, const TurnoutActionData &data) {
     TurnoutActionData data;
   };
   auto *m = new Msg{msg_id, data};
-  lv_async_call(
+  display::LvglTask::asyncCall(
       [](void *arg) {
         auto *m = static_cast<Msg *>(arg);
         lv_msg_send(m->id, &m->data);
@@ -58,7 +60,24 @@ void async_send_turntable(uint32_t msg_id, const TurntableActionData &data) {
     TurntableActionData data;
   };
   auto *m = new Msg{msg_id, data};
-  lv_async_call(
+  display::LvglTask::asyncCall(
+      [](void *arg) {
+        auto *m = static_cast<Msg *>(arg);
+        lv_msg_send(m->id, &m->data);
+        delete m;
+      },
+      m);
+}
+
+// Schedules an lv_msg_send carrying a LocoActionData payload on the LVGL
+// thread.
+void async_send_loco(uint32_t msg_id, const LocoActionData &data) {
+  struct Msg {
+    uint32_t id;
+    LocoActionData data;
+  };
+  auto *m = new Msg{msg_id, data};
+  display::LvglTask::asyncCall(
       [](void *arg) {
         auto *m = static_cast<Msg *>(arg);
         lv_msg_send(m->id, &m->data);
@@ -74,7 +93,7 @@ void async_send_u8(uint32_t msg_id, uint8_t value) {
     uint8_t value;
   };
   auto *m = new Msg{msg_id, value};
-  lv_async_call(
+  display::LvglTask::asyncCall(
       [](void *arg) {
         auto *m = static_cast<Msg *>(arg);
         lv_msg_send(m->id, &m->value);
@@ -123,17 +142,13 @@ void DCCEXProtocolDelegateImpl::receivedLocoUpdate(DCCExController::Loco *loco)
 }
 
 // Called on a broadcast speed/direction update for a loco address;
-// fires MSG_LOCO_BROADCAST_UPDATED.
+// fires MSG_DCC_LOCO_CHANGED.
 void DCCEXProtocolDelegateImpl::receivedLocoBroadcast(int address, int speed, DCCExController::Direction direction,
                                                       int functionMap) {
   printf("Loco Broadcast: Address=%d, Speed=%d, Direction=%d, FunctionMap=%d\n", address, speed, direction,
          functionMap);
-  // DCCExController::Loco *loco = DCCExController::Loco::getByAddress(address);
-  // if (loco) {
-  //   loco->setSpeed(speed);
-  //   loco->setDirection(direction);
-  //   loco->setFunctionStates(functionMap);
-  // }
+  async_send_loco(MSG_DCC_LOCO_CHANGED,
+                  LocoActionData{address, speed, direction == DCCExController::Direction::Forward, functionMap});
 }
 
 // Called when global track power state changes; fires MSG_TRACK_POWER_UPDATED.
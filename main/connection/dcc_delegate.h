@@ -16,6 +16,13 @@ struct TurntableActionData{
   bool moving;
 };
 
+struct LocoActionData{
+  int address;
+  int speed;
+  bool forward;
+  int functionMap;
+};
+
 class DCCEXProtocolDelegateImpl : public DCCExController::DCCEXProtocolDelegate {
 public:
     DCCEXProtocolDelegateImpl() {}
@@ -4,6 +4,7 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/queue.h"
 #include <DCCStream.h>
+#include <atomic>
 #include <cstring>
 #include <esp_timer.h> // For get_absolute_time(), to_ms_since_boot()
 #include <lwip/priv/tcp_priv.h>
@@ -26,6 +27,10 @@ private:
   uint64_t heartbeat_sent_time = 0;
   bool awaiting_heartbeat = false;
 
+  // Protocol byte counters shared by all streams so rates survive reconnects.
+  inline static std::atomic<uint32_t> rx_bytes_total{0};
+  inline static std::atomic<uint32_t> tx_bytes_total{0};
+
   static void enqueue_fail_err(err_t fail_err) {
     // Never block from lwIP callback context.
     if (tcp_fail_queue) {
@@ -69,6 +74,7 @@ private:
       return ERR_OK;
     }
     if (err == ERR_OK) {
+      rx_bytes_total.fetch_add(p->tot_len, std::memory_order_relaxed);
       if (stream->recv_buffer == nullptr) {
         stream->recv_buffer = p;
       } else {
@@ -147,6 +153,7 @@ public:
       }
       tcp_output(pcb);
       UNLOCK_TCPIP_CORE();
+      tx_bytes_total.fetch_add(size, std::memory_order_relaxed);
       return size;
     }
     UNLOCK_TCPIP_CORE();
@@ -222,6 +229,10 @@ public:
 
   bool isFailed() { return failed; }
 
+  // Running totals of protocol bytes received/sent over any stream.
+  static uint32_t totalBytesReceived() { return rx_bytes_total.load(std::memory_order_relaxed); }
+  static uint32_t totalBytesSent() { return tx_bytes_total.load(std::memory_order_relaxed); }
+
   // Destructor to close the socket
   ~TCPSocketStream() {
     LOCK_TCPIP_CORE();
@@ -5,7 +5,15 @@
  * Opens a raw lwIP TCP socket to a DCC-EX WiThrottle server, feeds incoming
  * data to DCCEXProtocol, and publishes lv_msg events for connection state
  * changes. A dedicated FreeRTOS task (`wifi_loop_task`) drives the protocol
- * loop; access to shared state is serialised with a FreeRTOS mutex.
+ * loop; access to shared state is serialised with a FreeRTOS mutex. Speed
+ * requests are coalesced per loco or consist (latest value wins) and sent
+ * from the loop no more often than kThrottleIntervalMs, one write per tick.
+ *
+ * With CONFIG_DCC_WARM_STANDBY the session to the saved server is opened in
+ * the background as soon as Wi-Fi is up. The loop requests the lists right
+ * away, so they are cached in DCCEXProtocol before any screen asks; a screen
+ * connecting to the same server then takes the session over instead of
+ * opening another.
  */
 #include "wifi_control.h"
 
@@ -15,10 +23,14 @@
 
 // #include "../config.h"
 #include "definitions.h"
+#include "display/LvglTask.h"
 #include "freertos/task.h"
+#include "utilities/BootTimeline.h"
 #include "ui/lv_msg.h"
 #include "wifi_connection.h"
 #include <DCCEXProtocol.h>
+#include <algorithm>
+#include <cstdio>
 #include <esp_log.h>
 #include <esp_timer.h>
 #include <lvgl.h>
@@ -135,13 +147,16 @@ void WifiControl::failError(err_t err) {
 
 // Function to initiate a connection to the server
 // Opens a non-blocking lwIP TCP socket and initiates a connection to the given
-// server. Registers the recv, sent and error callbacks on the pcb.
-void WifiControl::connectToServer(const char *server_ip, uint16_t port) {
+// server. Registers the recv, sent and error callbacks on the pcb. Returns true
+// once the session is published as CONNECTED. Gives up without touching the
+// connection state if startConnectToServer supersedes `generation` meanwhile;
+// connect_task then moves on to the newer request.
+bool WifiControl::connectToServer(const char *server_ip, uint16_t port, uint32_t generation) {
   ip_addr_t server_addr;
 
   if (!ipaddr_aton(server_ip, &server_addr)) {
     printf("Invalid IP address\n");
-    return;
+    return false;
   }
 
   LOCK_TCPIP_CORE();
@@ -149,7 +164,7 @@ void WifiControl::connectToServer(const char *server_ip, uint16_t port) {
   UNLOCK_TCPIP_CORE();
   if (pcb == nullptr) {
     printf("Failed to create PCB\n");
-    return;
+    return false;
   }
 
   connectCallbackDone_ = false;
@@ -170,18 +185,19 @@ void WifiControl::connectToServer(const char *server_ip, uint16_t port) {
       tcp_abort(pcb);
     }
     UNLOCK_TCPIP_CORE();
-    return;
+    return false;
   }
 
   // Wait for lwIP connect/error callbacks with a 10 second timeout
   ESP_LOGI(TAG, "Connecting to server...");
-  currentConnectionState = CONNECTING;
   const uint32_t timeout_ms = 10000;
   uint32_t start_time = millis();
   while (!connectCallbackDone_) {
     uint32_t now = millis(); // Convert to milliseconds
-    if (now - start_time > timeout_ms) {
-      ESP_LOGI(TAG, "Connection timed out after 10 seconds");
+    const bool superseded = generation != connectGeneration_;
+    if (superseded || now - start_time > timeout_ms) {
+      ESP_LOGI(TAG, "%s",
+               superseded ? "Connect superseded by a newer request" : "Connection timed out after 10 seconds");
       LOCK_TCPIP_CORE();
       tcp_arg(pcb, nullptr);
       tcp_err(pcb, nullptr);
@@ -190,8 +206,7 @@ void WifiControl::connectToServer(const char *server_ip, uint16_t port) {
         tcp_abort(pcb);
       }
       UNLOCK_TCPIP_CORE();
-      currentConnectionState = DISCONNECTED;
-      return;
+      return false;
     }
 
     // Add a small delay to avoid busy-waiting
@@ -200,8 +215,7 @@ void WifiControl::connectToServer(const char *server_ip, uint16_t port) {
 
   if (!connectCallbackSuccess_) {
     ESP_LOGI(TAG, "Connection failed in callback: %d", connectCallbackErr_);
-    currentConnectionState = DISCONNECTED;
-    return;
+    return false;
   }
 
   LOCK_TCPIP_CORE();
@@ -229,17 +243,32 @@ void WifiControl::connectToServer(const char *server_ip, uint16_t port) {
   }
 
   // Publish atomically under stateMutex_ so loop() never sees a partially
-  // initialised state.
+  // initialised state. A request for another server that arrived while this
+  // one was opening wins: the new session is closed instead.
+  bool published = false;
   if (xSemaphoreTake(stateMutex_, portMAX_DELAY) == pdTRUE) {
-    stream = newStream;
-    logStream = newLogStream;
-    dccExProtocol = newProtocol;
-    lastGetListsMs = millis();
-    currentConnectionState = CONNECTED;
+    if (generation == connectGeneration_) {
+      stream = newStream;
+      logStream = newLogStream;
+      dccExProtocol = newProtocol;
+      // Ask for the lists on the first loop rather than a second from now.
+      lastGetListsMs = millis() - 1000;
+      currentConnectionState = CONNECTED;
+      published = true;
+    }
     xSemaphoreGive(stateMutex_);
   }
+  if (!published) {
+    ESP_LOGI(TAG, "Closing superseded connection to %s:%u", server_ip, port);
+    newProtocol->disconnect();
+    delete newStream;
+    delete newLogStream;
+    return false;
+  }
+  BootTimeline::mark(BootTimeline::Milestone::ServerConnected);
 
   ESP_LOGI(TAG, "Connection process completed with state: %d", currentConnectionState);
+  return true;
 }
 
 // Main protocol loop: takes the state mutex and calls
@@ -249,11 +278,15 @@ void WifiControl::loop() {
   if (stateMutex_ != nullptr && xSemaphoreTake(stateMutex_, pdMS_TO_TICKS(50)) == pdTRUE) {
     if (dccExProtocol) {
       dccExProtocol->check();
+      if (dccExProtocol->receivedLists()) {
+        BootTimeline::mark(BootTimeline::Milestone::ListsReceived);
+      }
       uint64_t now_ms = millis();
       if (now_ms - lastGetListsMs >= 1000) {
         dccExProtocol->getLists(true, true, true, true);
         lastGetListsMs = now_ms;
       }
+      sendPendingThrottles(now_ms);
     }
 
     if (stream) {
@@ -267,8 +300,12 @@ void WifiControl::loop() {
   if (xQueueReceive(tcp_fail_queue, &err, 0) == pdTRUE) {
     failError(err);
     disconnect();
+    if (standby_) {
+      ESP_LOGI(TAG, "Standby connection to server lost");
+      return;
+    }
     ESP_LOGI(TAG, "Disconnected from server due to error");
-    lv_async_call(
+    display::LvglTask::asyncCall(
         [](void *) {
           lv_msg_send(MSG_DCC_DISCONNECTED, nullptr);
         },
@@ -276,15 +313,74 @@ void WifiControl::loop() {
   }
 }
 
-// Thread-safe entry point for screens: copies the address/port and spawns a
-// short-lived FreeRTOS task that calls connectToServer on the lwIP thread.
-void WifiControl::startConnectToServer(const char *server_ip, uint16_t port) {
-  if (currentConnectionState == CONNECTING || currentConnectionState == CONNECTED) {
+// Entry point for screens and the warm standby, called on the LVGL thread:
+// copies the address/port and spawns a short-lived FreeRTOS task that calls
+// connectToServer on the lwIP thread. A session to the same server that is
+// open or opening is kept, and a screen asking for it takes over a standby
+// session. A session to another server is closed first, and a standby connect
+// still opening is superseded: its task abandons it and opens the screen's
+// server instead. Returns false if the request was ignored (another screen
+// connect is in progress, or a standby request found the link busy).
+bool WifiControl::startConnectToServer(const char *server_ip, uint16_t port, bool standby) {
+  if (xSemaphoreTake(stateMutex_, portMAX_DELAY) != pdTRUE) {
+    return false;
+  }
+  const bool sameServer = serverIp_ == server_ip && serverPort_ == port;
+  if ((currentConnectionState == CONNECTING || currentConnectionState == CONNECTED) && sameServer) {
+    if (!standby && standby_) {
+      ESP_LOGI(TAG, "Taking over standby connection to %s:%u", server_ip, port);
+      standby_ = false;
+    } else {
+      ESP_LOGI(TAG, "Ignoring connect request; current state=%d", currentConnectionState);
+    }
+    xSemaphoreGive(stateMutex_);
+    // A screen gets the session it asked for; a standby request adds nothing.
+    return !standby;
+  }
+  if (currentConnectionState == CONNECTING && standby_ && !standby) {
+    ESP_LOGI(TAG, "Superseding standby connect to %s:%u with %s:%u", serverIp_.c_str(), serverPort_, server_ip, port);
+    serverIp_ = server_ip;
+    serverPort_ = port;
+    standby_ = false;
+    ++connectGeneration_;
+    xSemaphoreGive(stateMutex_);
+    return true;
+  }
+  if (currentConnectionState == CONNECTING || (standby && currentConnectionState == CONNECTED)) {
     ESP_LOGI(TAG, "Ignoring connect request; current state=%d", currentConnectionState);
-    return;
+    xSemaphoreGive(stateMutex_);
+    return false;
+  }
+  const bool wasConnected = currentConnectionState == CONNECTED;
+  xSemaphoreGive(stateMutex_);
+  if (wasConnected) {
+    ESP_LOGI(TAG, "Closing connection to %s:%u for %s:%u", serverIp_.c_str(), serverPort_, server_ip, port);
+    disconnect();
+  }
+
+  serverIp_ = server_ip;
+  serverPort_ = port;
+  standby_ = standby;
+  // Set before the task runs so a second request cannot start another one.
+  currentConnectionState = CONNECTING;
+  auto *args = new ConnectTaskArgs{this, server_ip, port, ++connectGeneration_};
+  if (xTaskCreate(&WifiControl::connect_task, "connect_task", 4096, args, tskIDLE_PRIORITY, nullptr) != pdPASS) {
+    delete args;
+    currentConnectionState = DISCONNECTED;
+    return false;
   }
-  auto *args = new ConnectTaskArgs{this, server_ip, port};
-  xTaskCreate(&WifiControl::connect_task, "connect_task", 4096, args, tskIDLE_PRIORITY, nullptr);
+  return true;
+}
+
+// True once the session is open to server_ip:port and owned by a screen, not
+// held as a warm standby.
+bool WifiControl::isConnectedTo(const char *server_ip, uint16_t port) {
+  if (xSemaphoreTake(stateMutex_, portMAX_DELAY) != pdTRUE) {
+    return false;
+  }
+  const bool match = currentConnectionState == CONNECTED && !standby_ && serverIp_ == server_ip && serverPort_ == port;
+  xSemaphoreGive(stateMutex_);
+  return match;
 }
 
 // Closes the TCP socket, destroys the protocol/stream objects and publishes
@@ -313,6 +409,10 @@ void WifiControl::disconnect() {
   }
   currentConnectionState = DISCONNECTED;
 
+  portENTER_CRITICAL(&throttleMux_);
+  throttles_.fill(PendingThrottle{});
+  portEXIT_CRITICAL(&throttleMux_);
+
   xSemaphoreGive(stateMutex_);
   ESP_LOGI(TAG, "Disconnected from server");
 }
@@ -445,15 +545,194 @@ bool WifiControl::sendTurntableReverseCommand(int turntableId) {
   return ok;
 }
 
-// FreeRTOS task spawned by startConnectToServer: resolves the IP and calls
-// connectToServer, then deletes itself.
+// FreeRTOS task spawned by startConnectToServer: calls connectToServer, and
+// again for the newer endpoint whenever startConnectToServer superseded the
+// attempt meanwhile. Leaves the state DISCONNECTED if the last attempt failed,
+// then deletes itself.
 void WifiControl::connect_task(void *arg) {
   auto *args = static_cast<ConnectTaskArgs *>(arg);
   if (args && args->self) {
-    args->self->connectToServer(args->server_ip.c_str(), args->port);
+    WifiControl *self = args->self;
+    std::string serverIp = args->server_ip;
+    uint16_t port = args->port;
+    uint32_t generation = args->generation;
+    while (true) {
+      const bool connected = self->connectToServer(serverIp.c_str(), port, generation);
+      if (xSemaphoreTake(self->stateMutex_, portMAX_DELAY) != pdTRUE) {
+        break;
+      }
+      const bool superseded = generation != self->connectGeneration_;
+      if (superseded) {
+        serverIp = self->serverIp_;
+        port = self->serverPort_;
+        generation = self->connectGeneration_;
+      } else if (!connected) {
+        self->currentConnectionState = DISCONNECTED;
+      }
+      xSemaphoreGive(self->stateMutex_);
+      if (!superseded) {
+        break;
+      }
+    }
   }
   delete args;
   vTaskDelete(nullptr);
 }
 
-}; // namespace utilities
\ No newline at end of file
+// Queues a speed/direction change for a single loco.
+bool WifiControl::requestLocoSpeed(int address, int speed, bool forward) {
+  const ConsistMember member{address, false};
+  return requestConsistSpeed(&member, 1, speed, forward);
+}
+
+// Queues a speed/direction change for a consist; members[0] is the lead and
+// identifies it. Repeated requests before the loop sends them just replace
+// the queued value, so a fast spin of the encoder costs one set of <t>
+// commands per kThrottleIntervalMs. Never blocks on stateMutex_.
+bool WifiControl::requestConsistSpeed(const ConsistMember *members, size_t count, int speed, bool forward) {
+  if (currentConnectionState != CONNECTED) {
+    ESP_LOGW(TAG, "requestConsistSpeed ignored: not connected");
+    return false;
+  }
+  if (members == nullptr || count == 0 || count > kMaxConsistMembers) {
+    ESP_LOGW(TAG, "requestConsistSpeed ignored: %u members", static_cast<unsigned>(count));
+    return false;
+  }
+
+  const int lead = members[0].address;
+  bool queued = false;
+  portENTER_CRITICAL(&throttleMux_);
+  PendingThrottle *slot = nullptr;
+  for (auto &throttle : throttles_) {
+    if (throttle.leadAddress() == lead) {
+      slot = &throttle;
+      break;
+    }
+    if (!throttle.pending && (slot == nullptr || throttle.lastSentMs < slot->lastSentMs)) {
+      slot = &throttle; // idle slot, least recently used
+    }
+  }
+  if (slot != nullptr) {
+    if (slot->leadAddress() != lead) {
+      *slot = PendingThrottle{};
+    }
+    std::copy(members, members + count, slot->members.begin());
+    slot->memberCount = count;
+    slot->speed = speed;
+    slot->forward = forward;
+    slot->pending = true;
+    queued = true;
+  }
+  portEXIT_CRITICAL(&throttleMux_);
+
+  if (!queued) {
+    ESP_LOGW(TAG, "requestConsistSpeed dropped: %u throttles already have changes queued",
+             static_cast<unsigned>(kMaxThrottles));
+  }
+  return queued;
+}
+
+// Sends queued speed changes whose loco or consist has not had a command for
+// kThrottleIntervalMs. Called from loop() with stateMutex_ held. The <t>
+// commands of every due member are written to the stream together, so a
+// consist starts and stops as one TCP segment instead of loco by loco.
+void WifiControl::sendPendingThrottles(uint64_t nowMs) {
+  if (currentConnectionState != CONNECTED || !stream) {
+    return;
+  }
+
+  constexpr size_t kCommandMax = sizeof("<t 10239 126 1>") + 4;
+  char batch[kMaxThrottles * kMaxConsistMembers * kCommandMax];
+  size_t length = 0;
+  for (auto &throttle : throttles_) {
+    PendingThrottle due;
+    portENTER_CRITICAL(&throttleMux_);
+    if (throttle.pending && nowMs - throttle.lastSentMs >= kThrottleIntervalMs) {
+      due = throttle;
+      throttle.pending = false;
+      throttle.lastSentMs = nowMs;
+    }
+    portEXIT_CRITICAL(&throttleMux_);
+    if (!due.pending) {
+      continue;
+    }
+
+    for (size_t i = 0; i < due.memberCount; ++i) {
+      const ConsistMember &member = due.members[i];
+      if (DCCExController::Loco::getByAddress(member.address) == nullptr) {
+        ESP_LOGW(TAG, "No roster loco with address %d, speed command dropped", member.address);
+        continue;
+      }
+      const bool forward = due.forward != member.reversed;
+      const int written =
+          snprintf(batch + length, sizeof(batch) - length, "<t %d %d %d>", member.address, due.speed, forward ? 1 : 0);
+      if (written > 0 && length + written < sizeof(batch)) {
+        length += written;
+      }
+    }
+  }
+
+  if (length > 0) {
+    stream->write(reinterpret_cast<const uint8_t *>(batch), length);
+  }
+}
+
+// Turns a loco function on or off while holding the shared state mutex.
+bool WifiControl::setLocoFunction(int address, int function, bool on) {
+  if (stateMutex_ == nullptr) {
+    return false;
+  }
+
+  if (xSemaphoreTake(stateMutex_, pdMS_TO_TICKS(250)) != pdTRUE) {
+    ESP_LOGW(TAG, "setLocoFunction skipped: state mutex unavailable");
+    return false;
+  }
+
+  bool ok = false;
+  auto *loco = DCCExController::Loco::getByAddress(address);
+  if (currentConnectionState == CONNECTED && dccExProtocol && stream && loco) {
+    if (on) {
+      dccExProtocol->functionOn(loco, function);
+    } else {
+      dccExProtocol->functionOff(loco, function);
+    }
+    ok = true;
+  } else {
+    ESP_LOGW(TAG, "setLocoFunction ignored: not connected or unknown loco %d", address);
+  }
+
+  xSemaphoreGive(stateMutex_);
+  return ok;
+}
+
+// Stops every loco immediately, dropping any queued speed changes first so
+// they cannot restart a loco after the stop.
+bool WifiControl::emergencyStop() {
+  if (stateMutex_ == nullptr) {
+    return false;
+  }
+
+  portENTER_CRITICAL(&throttleMux_);
+  for (auto &throttle : throttles_) {
+    throttle.pending = false;
+  }
+  portEXIT_CRITICAL(&throttleMux_);
+
+  if (xSemaphoreTake(stateMutex_, pdMS_TO_TICKS(250)) != pdTRUE) {
+    ESP_LOGW(TAG, "emergencyStop skipped: state mutex unavailable");
+    return false;
+  }
+
+  bool ok = false;
+  if (currentConnectionState == CONNECTED && dccExProtocol && stream) {
+    dccExProtocol->emergencyStop();
+    ok = true;
+  } else {
+    ESP_LOGW(TAG, "emergencyStop ignored: not connected");
+  }
+
+  xSemaphoreGive(stateMutex_);
+  return ok;
+}
+
+}; // namespace utilities
@@ -8,7 +8,10 @@
 #include <freertos/semphr.h>
 #include <lwip/tcp.h>
 
+#include <array>
+#include <atomic>
 #include <memory>
+#include <string>
 
 #include "ESP_Millis.h"
 #include "dcc_delegate.h"
@@ -16,6 +19,13 @@
 
 namespace utilities {
 
+// One loco of a consist. A reversed member runs facing the other way, so it
+// is sent the opposite direction to the rest of the consist.
+struct ConsistMember {
+  int address = -1;
+  bool reversed = false;
+};
+
 class WifiControl {
 private:
   std::shared_ptr<DCCExController::DCCEXProtocol> dccExProtocol;
@@ -53,15 +63,27 @@ public:
   connection_state connectionState() const { return currentConnectionState; }
 
   void failError(err_t err);
-  void connectToServer(const char *server_ip, uint16_t port);
+  bool connectToServer(const char *server_ip, uint16_t port, uint32_t generation);
   void loop();
-  void startConnectToServer(const char *server_ip, uint16_t port);
+  bool startConnectToServer(const char *server_ip, uint16_t port, bool standby = false);
+  bool isStandby() const { return standby_; }
+  bool isConnectedTo(const char *server_ip, uint16_t port);
   void disconnect();
   bool setTurnoutThrown(int turnoutId, bool thrown);
   bool startRoute(int routeId);
   bool setRoutesPaused(bool paused);
   bool rotateTurntableToIndex(int turntableId, int indexId);
   bool sendTurntableReverseCommand(int turntableId);
+  bool requestLocoSpeed(int address, int speed, bool forward);
+  bool requestConsistSpeed(const ConsistMember *members, size_t count, int speed, bool forward);
+  bool setLocoFunction(int address, int function, bool on);
+  bool emergencyStop();
+
+  // Minimum time between two speed commands for the same loco.
+  static constexpr uint64_t kThrottleIntervalMs = 100;
+  // Locos or consists that can have a speed change queued at once.
+  static constexpr size_t kMaxThrottles = 4;
+  static constexpr size_t kMaxConsistMembers = 4;
 
   std::shared_ptr<DCCExController::DCCEXProtocol> dccProtocol() { return dccExProtocol; };
 
@@ -71,15 +93,43 @@ private:
   connection_state currentConnectionState = NOT_CONNECTED;
   uint64_t lastGetListsMs = 0;
   DCCExController::DCCMillis *dccMillis;
+  // Endpoint of the current or last connection, set by startConnectToServer.
+  std::string serverIp_;
+  uint16_t serverPort_ = 0;
+  // Opened in the background and not yet taken over by a screen; losing it
+  // raises no popup.
+  volatile bool standby_ = false;
+  // Bumped by every accepted startConnectToServer; a connect attempt whose
+  // generation is no longer current has been superseded and is abandoned.
+  std::atomic<uint32_t> connectGeneration_{0};
   volatile bool connectCallbackDone_ = false;
   volatile bool connectCallbackSuccess_ = false;
   volatile err_t connectCallbackErr_ = ERR_OK;
   SemaphoreHandle_t stateMutex_ = nullptr;
 
+  // Latest requested speed per loco or consist (keyed by its first member),
+  // sent by loop() at most every kThrottleIntervalMs. Guarded by throttleMux_,
+  // not stateMutex_, so the UI never waits on the protocol loop to queue a
+  // change.
+  struct PendingThrottle {
+    std::array<ConsistMember, kMaxConsistMembers> members{};
+    size_t memberCount = 0;
+    int speed = 0;
+    bool forward = true;
+    bool pending = false;
+    uint64_t lastSentMs = 0;
+
+    int leadAddress() const { return memberCount > 0 ? members[0].address : -1; }
+  };
+  std::array<PendingThrottle, kMaxThrottles> throttles_{};
+  portMUX_TYPE throttleMux_ = portMUX_INITIALIZER_UNLOCKED;
+  void sendPendingThrottles(uint64_t nowMs);
+
   struct ConnectTaskArgs {
     WifiControl *self;
     std::string server_ip;
     uint16_t port;
+    uint32_t generation;
   };
   static void connect_task(void *arg);
 };
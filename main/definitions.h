@@ -24,6 +24,7 @@
 #define MSG_DCC_TURNOUT_CHANGED 24
 #define MSG_DCC_TRACK_POWER_CHANGED 25
 #define MSG_DCC_TURNTABLE_CHANGED 26
+#define MSG_DCC_LOCO_CHANGED 27
 
 #define NVS_NAMESPACE "touch_cal"
 #define NVS_CALIBRATION_SAVED "cal_saved"
@@ -32,6 +33,8 @@
 #define NVS_NAMESPACE_WIFI "wifi_creds"
 #define NVS_WIFI_SSID "wifi_ssid"
 #define NVS_WIFI_PWD "wifi_pwd"
+#define NVS_WIFI_REJOIN "wifi_rejoin"
+#define NVS_WIFI_NETWORKS "wifi_nets"
 
 #define NVS_NAMESPACE_DCC "dcc_conn"
 #define NVS_DCC_SAVED "saved"
@@ -9,6 +9,7 @@
 #include "ConnectDCC.h"
 #include "DCCMenu.h"
 #include "FirstScreen.h"
+#include "LvglTask.h"
 #include "LvglWrapper.h"
 #include "MessageBox.h"
 #include "Screen.h"
@@ -63,7 +64,7 @@ bool ConnectDCCScreen::selectedItemIsSaved() const {
   for (const auto &item : detectedListItems) {
     if (item && item->getLvObj() == currentButton) {
       const auto &dev = item->device();
-      return dev.ip == savedDevice.ip && dev.port == savedDevice.port;
+      return dev.sameEndpoint(savedDevice);
     }
   }
 
@@ -118,14 +119,14 @@ void ConnectDCCScreen::show(lv_obj_t *parent, std::weak_ptr<Screen> parentScreen
       MSG_MDNS_DEVICE_ADDED,
       [](lv_msg_t *msg) {
         ConnectDCCScreen *self = static_cast<ConnectDCCScreen *>(lv_msg_get_user_data(msg));
-        self->refreshMdnsList();
+        self->refreshMdnsList(false);
       },
       this);
   mdns_changed_sub = lv_msg_subscribe(
       MSG_MDNS_DEVICE_CHANGED,
       [](lv_msg_t *msg) {
         ConnectDCCScreen *self = static_cast<ConnectDCCScreen *>(lv_msg_get_user_data(msg));
-        self->refreshMdnsList();
+        self->refreshMdnsList(false);
       },
       this);
 
@@ -198,7 +199,9 @@ bool ConnectDCCScreen::loadSavedConnection(utilities::WithrottleDevice &outDevic
     hostname[0] = '\0';
   }
 
-  outDevice.ip = ip;
+  if (!outDevice.setIp(ip)) {
+    return false;
+  }
   outDevice.port = port;
   outDevice.instance = instance;
   outDevice.hostname = hostname;
@@ -207,8 +210,9 @@ bool ConnectDCCScreen::loadSavedConnection(utilities::WithrottleDevice &outDevic
 
 // Synchronises the on-screen list with the current set of discovered devices.
 // Always prepends the saved entry (if any) so it is always visible even before
-// mDNS finds it. Existing items are updated in place; new ones are appended.
-void ConnectDCCScreen::refreshMdnsList() {
+// mDNS finds it. Unless `force` is set, nothing is done when the device
+// registry has not changed since the last rebuild.
+void ConnectDCCScreen::refreshMdnsList(bool force) {
   if (isCleanedUp)
     return;
 
@@ -216,57 +220,63 @@ void ConnectDCCScreen::refreshMdnsList() {
   if (!lvObj_ || !lv_obj_is_valid(lvObj_) || !list_auto || !lv_obj_is_valid(list_auto) || lv_screen_active() != lvObj_)
     return;
 
+  // Read the version before the list, so a change in between is picked up by
+  // the next notification.
   auto wifiHandler = utilities::WifiHandler::instance();
-  auto devices = wifiHandler->getWithrottleDevices();
+  const uint32_t version = wifiHandler->withrottleDevicesVersion();
+  if (!force && version == mdnsListVersion) {
+    return;
+  }
+  mdnsListVersion = version;
+  const auto devices = wifiHandler->getWithrottleDevices();
 
   // Always include the saved DCC entry in this list. If mDNS later discovers the
   // same endpoint, DCCConnectListItem::matches() prevents duplicates.
   utilities::WithrottleDevice savedDevice;
   const bool hasSavedDevice = loadSavedConnection(savedDevice);
-  if (hasSavedDevice) {
-    devices.insert(devices.begin(), savedDevice);
-  }
 
   // Preserve the currently selected endpoint (if any) across a list rebuild.
-  std::string selectedIp;
-  uint16_t selectedPort = 0;
+  utilities::WithrottleDevice selected;
   if (currentButton) {
     auto selectedItem = getItem(currentButton);
     if (selectedItem) {
-      selectedIp = selectedItem->device().ip;
-      selectedPort = selectedItem->device().port;
+      selected.ipv4 = selectedItem->device().ipv4;
+      selected.port = selectedItem->device().port;
     }
   }
 
-  // Dedupe by endpoint (ip+port), preserving order so a saved entry inserted at
-  // the front remains first.
-  std::vector<utilities::WithrottleDevice> uniqueDevices;
-  uniqueDevices.reserve(devices.size());
-  for (const auto &device : devices) {
+  // Dedupe by endpoint (ip+port), preserving order so the saved entry stays
+  // first. Points into the snapshot rather than copying it.
+  std::vector<const utilities::WithrottleDevice *> uniqueDevices;
+  uniqueDevices.reserve(devices->size() + 1);
+  if (hasSavedDevice) {
+    uniqueDevices.push_back(&savedDevice);
+  }
+  for (const auto &device : *devices) {
     bool duplicate = false;
-    for (const auto &existing : uniqueDevices) {
-      if (existing.ip == device.ip && existing.port == device.port) {
+    for (const auto *existing : uniqueDevices) {
+      if (existing->sameEndpoint(device)) {
         duplicate = true;
         break;
       }
     }
     if (!duplicate) {
-      uniqueDevices.push_back(device);
+      uniqueDevices.push_back(&device);
     }
   }
 
-  ESP_LOGI(TAG, "Refreshing mDNS list, found %d devices", uniqueDevices.size());
+  ESP_LOGI(TAG, "Refreshing mDNS list, found %u devices", static_cast<unsigned>(uniqueDevices.size()));
 
   detectedListItems.clear();
   lv_obj_clean(list_auto);
   currentButton = nullptr;
 
-  for (const auto &device : uniqueDevices) {
-    const bool isSaved = hasSavedDevice && savedDevice.ip == device.ip && savedDevice.port == device.port;
-    auto listItem = std::make_shared<DCCConnectListItem>(list_auto, detectedListItems.size(), device, isSaved);
+  for (const auto *device : uniqueDevices) {
+    const bool isSaved = hasSavedDevice && savedDevice.sameEndpoint(*device);
+    auto listItem = std::make_shared<DCCConnectListItem>(list_auto, detectedListItems.size(), *device, isSaved);
     detectedListItems.push_back(listItem);
 
-    if (!selectedIp.empty() && device.ip == selectedIp && device.port == selectedPort) {
+    if (selected.ipv4 != 0 && device->sameEndpoint(selected)) {
       currentButton = listItem->getLvObj();
     }
   }
@@ -359,14 +369,16 @@ void ConnectDCCScreen::connectToDCCServer(std::shared_ptr<DCCConnectListItem> dc
 
 // Stops mDNS updates, shows the waiting screen and spawns a FreeRTOS task that
 // waits for the TCP connection to resolve. On success it transitions to DCCMenu;
-// on failure it fires MSG_DCC_CONNECTION_FAILED and dismisses the waiting screen.
+// on failure, or if WifiControl refused the request, it fires
+// MSG_DCC_CONNECTION_FAILED and dismisses the waiting screen.
 void ConnectDCCScreen::connectToDCCDevice(const utilities::WithrottleDevice &dccDevice) {
-  if (dccDevice.ip.empty() || dccDevice.port == 0) {
+  if (!dccDevice.hasAddress()) {
     ESP_LOGW(TAG, "Invalid DCC device details, cannot connect");
     return;
   }
 
-  ESP_LOGI(TAG, "Connecting to DCC server at %s:%d", dccDevice.ip.c_str(), dccDevice.port);
+  const std::string ip = dccDevice.ipString();
+  ESP_LOGI(TAG, "Connecting to DCC server at %s:%d", ip.c_str(), dccDevice.port);
 
   auto wifiHandler = utilities::WifiHandler::instance();
   auto wifiControl = utilities::WifiControl::instance();
@@ -380,11 +392,16 @@ void ConnectDCCScreen::connectToDCCDevice(const utilities::WithrottleDevice &dcc
 
   waitingScreen_ = std::make_shared<WaitingScreen>();
   waitingScreen_->setLabel("Connecting to:");
-  waitingScreen_->setSubLabel(dccDevice.hostname.empty() ? dccDevice.ip : dccDevice.hostname);
+  waitingScreen_->setSubLabel(dccDevice.hostname.empty() ? ip : dccDevice.hostname);
   waitingScreen_->showScreen(shared_from_this());
 
   lv_msg_send(MSG_CONNECTING_TO_DCC_SERVER, NULL);
-  wifiControl->startConnectToServer(dccDevice.ip.c_str(), dccDevice.port);
+  if (!wifiControl->startConnectToServer(ip.c_str(), dccDevice.port)) {
+    ESP_LOGW(TAG, "Connect request to %s:%d was not accepted", ip.c_str(), dccDevice.port);
+    lv_msg_send(MSG_DCC_CONNECTION_FAILED, NULL);
+    waitingScreen_.reset();
+    return;
+  }
 
   // Create a FreeRTOS task to wait for connection on core 0
   struct ConnectTaskArgs {
@@ -395,8 +412,8 @@ void ConnectDCCScreen::connectToDCCDevice(const utilities::WithrottleDevice &dcc
     int port;
     std::string instance;
   };
-  auto *args = new ConnectTaskArgs{shared_from_this(), wifiHandler,    wifiControl,
-                                   dccDevice.ip,       dccDevice.port, dccDevice.instance};
+  auto *args =
+      new ConnectTaskArgs{shared_from_this(), wifiHandler, wifiControl, ip, dccDevice.port, dccDevice.instance};
 
   auto connect_wait_task = [](void *arg) {
     auto *args = static_cast<ConnectTaskArgs *>(arg);
@@ -407,12 +424,14 @@ void ConnectDCCScreen::connectToDCCDevice(const utilities::WithrottleDevice &dcc
       currentConnectionState = args->wifiControl->connectionState();
     } while (currentConnectionState == utilities::WifiControl::CONNECTING);
 
-    if (currentConnectionState == utilities::WifiControl::CONNECTED) {
+    // CONNECTED alone is not enough: the session must be to this server and
+    // owned by this request, not a warm standby to another one.
+    if (args->wifiControl->isConnectedTo(args->ip.c_str(), args->port)) {
       ESP_LOGI(TAG, "Successfully connected to DCC server at %s:%d", args->ip.c_str(), args->port);
 
-      // All LVGL calls must happen on the LVGL task — schedule via lv_async_call.
+      // All LVGL calls must happen on the LVGL task — schedule via LvglTask::asyncCall.
       // Ownership of args transfers to the callback; do NOT delete here.
-      lv_async_call(
+      LvglTask::asyncCall(
           [](void *cbArg) {
             auto *args = static_cast<ConnectTaskArgs *>(cbArg);
             lv_msg_send(MSG_DCC_CONNECTION_SUCCESS, NULL);
@@ -427,7 +446,7 @@ void ConnectDCCScreen::connectToDCCDevice(const utilities::WithrottleDevice &dcc
     } else {
       ESP_LOGI(TAG, "Failed to connect to DCC server at %s:%d", args->ip.c_str(), args->port);
 
-      lv_async_call(
+      LvglTask::asyncCall(
           [](void *cbArg) {
             auto *args = static_cast<ConnectTaskArgs *>(cbArg);
             lv_msg_send(MSG_DCC_CONNECTION_FAILED, NULL);
@@ -507,7 +526,7 @@ bool ConnectDCCScreen::saveSelectedConnection() {
   }
 
   const auto &device = currentItem->device();
-  if (device.ip.empty() || device.port == 0) {
+  if (!device.hasAddress()) {
     ESP_LOGW(TAG, "Selected DCC item missing ip/port");
     return false;
   }
@@ -525,7 +544,7 @@ bool ConnectDCCScreen::saveSelectedConnection() {
   if (err == ESP_OK)
     err = handle->set_string(NVS_DCC_HOSTNAME, device.hostname.c_str());
   if (err == ESP_OK)
-    err = handle->set_string(NVS_DCC_IP, device.ip.c_str());
+    err = handle->set_string(NVS_DCC_IP, device.ipString().c_str());
   if (err == ESP_OK)
     err = handle->set_item(NVS_DCC_PORT, device.port);
   if (err == ESP_OK)
@@ -537,7 +556,7 @@ bool ConnectDCCScreen::saveSelectedConnection() {
   }
 
   savedListItem = currentItem;
-  ESP_LOGI(TAG, "Saved DCC connection %s:%d", device.ip.c_str(), device.port);
+  ESP_LOGI(TAG, "Saved DCC connection %s:%d", device.ipString().c_str(), device.port);
 
   // Rebuild list so saved-icon state updates immediately.
   refreshMdnsList();
@@ -570,15 +589,16 @@ bool ConnectDCCScreen::maybeAutoConnectSaved() {
     return false;
   }
 
+  // A warm standby session to the saved server is taken over below.
   auto wifiControl = utilities::WifiControl::instance();
-  if (wifiControl->connectionState() == utilities::WifiControl::CONNECTING ||
-      wifiControl->connectionState() == utilities::WifiControl::CONNECTED) {
+  if (!wifiControl->isStandby() && (wifiControl->connectionState() == utilities::WifiControl::CONNECTING ||
+                                    wifiControl->connectionState() == utilities::WifiControl::CONNECTED)) {
     ESP_LOGI(TAG, "Skipping DCC auto-connect: DCC already connecting/connected");
     autoConnectAttempted = true;
     return false;
   }
 
-  ESP_LOGI(TAG, "Auto-connecting to saved DCC server %s:%d", savedDevice.ip.c_str(), savedDevice.port);
+  ESP_LOGI(TAG, "Auto-connecting to saved DCC server %s:%d", savedDevice.ipString().c_str(), savedDevice.port);
   autoConnectAttempted = true;
   connectToDCCDevice(savedDevice);
   return true;
@@ -668,26 +688,30 @@ void ConnectDCCScreen::moveFocus(int direction) {
   updateFocusedState();
 }
 
-// Applies focus outlines to the focused item/button; clears all others.
+// Moves the focus highlight to the focused item/button.
 // Does NOT change CHECKED/selection state — that is owned by rotaryActivateFocused
 // and the touch click handler.
-void ConnectDCCScreen::updateFocusedState() {
-  const int listSize = static_cast<int>(detectedListItems.size());
+void ConnectDCCScreen::updateFocusedState() { rotaryShowFocus(focusedIndex); }
 
-  for (int i = 0; i < listSize; ++i) {
-    auto obj = detectedListItems[i]->getLvObj();
-    if (!obj) {
-      continue;
-    }
-    applyFocusOutline(obj, i == focusedIndex);
-    if (i == focusedIndex) {
-      lv_obj_scroll_to_view(obj, LV_ANIM_OFF);
-    }
+// Focus order: detected servers, then Back, Save and Connect.
+lv_obj_t *ConnectDCCScreen::rotaryFocusObject(int index) const {
+  const int listSize = static_cast<int>(detectedListItems.size());
+  if (index < 0) {
+    return nullptr;
+  }
+  if (index < listSize) {
+    return detectedListItems[index]->getLvObj();
+  }
+  switch (index - listSize) {
+  case 0:
+    return btn_back;
+  case 1:
+    return btn_save;
+  case 2:
+    return btn_connect;
+  default:
+    return nullptr;
   }
-
-  applyFocusOutline(btn_back, focusedIndex == listSize);
-  applyFocusOutline(btn_save, focusedIndex == listSize + 1);
-  applyFocusOutline(btn_connect, focusedIndex == listSize + 2);
 }
 
 void ConnectDCCScreen::rotaryMoveFocus(int direction) { moveFocus(direction); }
@@ -766,13 +790,14 @@ void ConnectDCCScreen::rotaryHandleDoubleClick() {
   }
 
   const auto &dev = target->device();
-  if (dev.ip != savedDevice.ip || dev.port != savedDevice.port) {
+  if (!dev.sameEndpoint(savedDevice)) {
     return;
   }
 
   display::showMessageBox(
       "Remove Saved",
-      ("Remove saved DCC connection?\n" + dev.instance + " (" + dev.ip + ":" + std::to_string(dev.port) + ")").c_str(),
+      ("Remove saved DCC connection?\n" + dev.instance + " (" + dev.ipString() + ":" + std::to_string(dev.port) + ")")
+          .c_str(),
       display::MessageBoxState::Warning,
       [](void *ctx) {
         auto *self = static_cast<ConnectDCCScreen *>(ctx);
@@ -808,13 +833,14 @@ void ConnectDCCScreen::removeSavedConnection() {
 }
 
 // Returns the DCCConnectListItem whose LVGL button matches bn, or nullptr.
+// Buttons carry their position in detectedListItems as user data.
 std::shared_ptr<DCCConnectListItem> ConnectDCCScreen::getItem(lv_obj_t *bn) {
-  for (const auto &item : detectedListItems) {
-    if (item->getLvObj() == bn) {
-      return item;
-    }
+  const int index = getItemIndex(bn);
+  if (index < 0 || static_cast<size_t>(index) >= detectedListItems.size()) {
+    return nullptr;
   }
-  return nullptr;
+  const auto &item = detectedListItems[index];
+  return item->getLvObj() == bn ? item : nullptr;
 }
 
 } // namespace display
\ No newline at end of file
@@ -29,7 +29,7 @@ public:
 
   void connectToDCCServer(std::shared_ptr<DCCConnectListItem> dccItem);
 
-  void refreshMdnsList();
+  void refreshMdnsList(bool force = true);
   void resetMsgHandlers();
   std::shared_ptr<DCCConnectListItem> getItem(lv_obj_t *bn);
 
@@ -39,6 +39,8 @@ public:
   void button_listitem_click_event_callback(lv_event_t *e);
 
 private:
+  friend class UiBenchmark;
+
   bool saveSelectedConnection();
   bool selectedItemIsSaved() const;
   void updateSaveButtonLabel();
@@ -57,6 +59,7 @@ private:
   bool rotaryInputEnabled() const override { return !isCleanedUp; }
   void rotaryMoveFocus(int direction) override;
   void rotaryActivateFocused() override;
+  lv_obj_t *rotaryFocusObject(int index) const override;
   void rotaryHandleDoubleClick() override;
 
   void moveFocus(int direction);
@@ -64,6 +67,7 @@ private:
   void removeSavedConnection();
 
   int focusedIndex = -1;
+  uint32_t mdnsListVersion = 0; // device registry version the list was last built from
   bool isCleanedUp = false;
   bool autoConnectAttempted = false;
   lv_obj_t *lbl_title = nullptr;
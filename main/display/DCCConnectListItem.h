@@ -15,13 +15,14 @@ class DCCConnectListItem {
 public:
   static std::shared_ptr<DCCConnectListItem> currentListItem;
 
-  DCCConnectListItem(lv_obj_t *parent, size_t index, utilities::WithrottleDevice device, bool isSaved = false)
+  DCCConnectListItem(lv_obj_t *parent, size_t index, const utilities::WithrottleDevice &device, bool isSaved = false)
       : device_(device) {
     const char *icon = isSaved ? LV_SYMBOL_SAVE : LV_SYMBOL_WIFI;
-    lvObj = lv_list_add_btn_mode(parent, icon,
-                                 (device.instance + " (" + device.ip + ":" + std::to_string(device.port) + ")").c_str(),
-                                 LV_LABEL_LONG_MODE_DOTS);
+    lvObj = lv_list_add_btn_mode(
+        parent, icon, (device.instance + " (" + device.ipString() + ":" + std::to_string(device.port) + ")").c_str(),
+        LV_LABEL_LONG_MODE_DOTS);
     lv_obj_add_flag(lvObj, LV_OBJ_FLAG_EVENT_BUBBLE);
+    setItemIndex(lvObj, index);
     setStylePart(lvObj, "wifi.item", LV_PART_MAIN);
     setStylePart(lvObj, "wifi.item.selected", LV_STATE_CHECKED);
   }
@@ -31,18 +32,17 @@ public:
   bool matches(const utilities::WithrottleDevice &other) const {
     // Endpoint identity is IP+port; instance/hostname can legitimately differ
     // between saved and mDNS-discovered records.
-    return device_.ip == other.ip && device_.port == other.port;
+    return device_.sameEndpoint(other);
   }
 
   bool isSame(const utilities::WithrottleDevice &other) const {
-    return device_.instance == other.instance && device_.hostname == other.hostname && device_.ip == other.ip &&
-           device_.port == other.port;
+    return device_.instance == other.instance && device_.hostname == other.hostname && device_.sameEndpoint(other);
   }
 
   void update(const utilities::WithrottleDevice &other) {
     device_.instance = other.instance;
     device_.hostname = other.hostname;
-    device_.ip = other.ip;
+    device_.ipv4 = other.ipv4;
     device_.port = other.port;
     device_.txt = other.txt;
 
@@ -52,10 +52,11 @@ public:
   }
 
   std::string getText() const {
+    const std::string ip = device_.ipString();
     const std::string &name = !device_.instance.empty()   ? device_.instance
                               : !device_.hostname.empty() ? device_.hostname
-                                                          : device_.ip;
-    return name + " (" + device_.ip + ":" + std::to_string(device_.port) + ")";
+                                                          : ip;
+    return name + " (" + ip + ":" + std::to_string(device_.port) + ")";
   }
 
   const utilities::WithrottleDevice &device() const { return device_; }
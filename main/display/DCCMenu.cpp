@@ -367,27 +367,45 @@ void DCCMenu::moveFocus(int direction) {
     idx = 0;
   }
 
-  for (int attempts = 0; attempts < total; ++attempts) {
-    idx = (idx + direction) % total;
-    if (idx < 0) {
-      idx += total;
-    }
-    if (isIndexEnabled(idx)) {
-      focusedIndex = idx;
-      updateFocusedState();
-      return;
+  // One enabled button per detent; batched detents redraw the focus once.
+  const int step = direction > 0 ? 1 : -1;
+  bool moved = false;
+  for (int remaining = direction * step; remaining > 0; --remaining) {
+    for (int attempts = 0; attempts < total; ++attempts) {
+      idx = (idx + step + total) % total;
+      if (isIndexEnabled(idx)) {
+        moved = true;
+        break;
+      }
     }
   }
+  if (moved) {
+    focusedIndex = idx;
+    updateFocusedState();
+  }
 }
 
-void DCCMenu::updateFocusedState() {
-  applyFocusOutline(btn_roster, focusedIndex == 0);
-  applyFocusOutline(btn_turnouts, focusedIndex == 1);
-  applyFocusOutline(btn_routes, focusedIndex == 2);
-  applyFocusOutline(btn_turntables, focusedIndex == 3);
-  applyFocusOutline(btn_refresh, focusedIndex == 4);
-  applyFocusOutline(btn_track_power, focusedIndex == 5);
-  applyFocusOutline(btn_close, focusedIndex == 6);
+void DCCMenu::updateFocusedState() { rotaryShowFocus(focusedIndex); }
+
+lv_obj_t *DCCMenu::rotaryFocusObject(int index) const {
+  switch (index) {
+  case 0:
+    return btn_roster;
+  case 1:
+    return btn_turnouts;
+  case 2:
+    return btn_routes;
+  case 3:
+    return btn_turntables;
+  case 4:
+    return btn_refresh;
+  case 5:
+    return btn_track_power;
+  case 6:
+    return btn_close;
+  default:
+    return nullptr;
+  }
 }
 
 void DCCMenu::rotaryMoveFocus(int direction) { moveFocus(direction); }
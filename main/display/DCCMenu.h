@@ -87,9 +87,12 @@ protected:
   void ensureStatusHideTimer();
 
 private:
+  friend class UiBenchmark;
+
   bool rotaryInputEnabled() const override { return !isCleanedUp; }
   void rotaryMoveFocus(int direction) override;
   void rotaryActivateFocused() override;
+  lv_obj_t *rotaryFocusObject(int index) const override;
 
   void moveFocus(int direction);
   void updateFocusedState();
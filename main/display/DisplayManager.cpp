@@ -3,23 +3,71 @@
  * @brief LVGL display driver bridge for the LovyanGFX-backed ILI9488 panel.
  *
  * Owns the global LGFX instance and provides the flush callback that LVGL
- * calls after rendering each dirty rectangle.
+ * calls after rendering each dirty rectangle. The touch controller shares the
+ * SPI bus, so flushes and touch reads are serialised with a bus mutex. A flush
+ * returns with its DMA still running and the panel's write transaction open;
+ * whoever takes the bus for anything else waits for both (lockBusIdle).
  */
 #include "DisplayManager.h"
+#include "utilities/BootTimeline.h"
 #include <esp_log.h>
+#include <esp_timer.h>
 
 LGFX DisplayManager::gfx;
+DisplayManager::FlushStats DisplayManager::flushStats_;
 static const char *TAG = "DISPLAY_MANAGER";
 
-// LVGL flush callback: pushes a rendered rectangle to the display via
-// LovyanGFX DMA. Begins a write transaction on the first call of a frame and
-// signals LVGL that the flush is complete so it can continue rendering.
+// Returns (and lazily creates) the mutex guarding the shared SPI bus.
+SemaphoreHandle_t DisplayManager::busMutex() {
+  static SemaphoreHandle_t m = xSemaphoreCreateMutex();
+  return m;
+}
+
+// Acquires the shared SPI bus; blocks indefinitely.
+void DisplayManager::lockBus() { xSemaphoreTake(busMutex(), portMAX_DELAY); }
+
+// Releases the shared SPI bus.
+void DisplayManager::unlockBus() { xSemaphoreGive(busMutex()); }
+
+// Acquires the shared SPI bus for a device other than the panel: waits for the
+// last flush's DMA to finish and closes the write transaction it left open.
+void DisplayManager::lockBusIdle() {
+  lockBus();
+  gfx.waitDMA();
+  while (gfx.getStartCount() > 0) {
+    gfx.endWrite();
+  }
+}
+
+// Returns flush counters accumulated since the previous call and resets them.
+DisplayManager::FlushStats DisplayManager::takeFlushStats() {
+  FlushStats sample = flushStats_;
+  flushStats_ = FlushStats{};
+  return sample;
+}
+
+// LVGL flush callback: starts a DMA transfer of a rendered rectangle to the
+// display and signals LVGL straight away so it renders the next area into the
+// other buffer while the transfer runs. pushImageDMA waits for the previous
+// transfer first, so a buffer is never reused while it is being sent. The
+// write transaction is opened on demand and left open between flushes;
+// lockBusIdle() closes it before the touch controller uses the bus.
 void DisplayManager::disp_flush(lv_display_t *disp, const lv_area_t *area, uint8_t *color_p) {
-  // LovyanGFX async DMA flush pattern (matches LovyanGFX LVGL example).
+  const int64_t startUs = esp_timer_get_time();
+  const bool last = lv_display_flush_is_last(disp);
+  lockBus();
   if (gfx.getStartCount() == 0) {
     gfx.startWrite();
   }
   gfx.pushImageDMA(area->x1, area->y1, area->x2 - area->x1 + 1, area->y2 - area->y1 + 1, (lgfx::rgb565_t *)color_p);
+  unlockBus();
 
+  ++flushStats_.flushes;
+  flushStats_.flushUs += static_cast<uint64_t>(esp_timer_get_time() - startUs);
+  flushStats_.bytes += static_cast<uint64_t>(lv_area_get_size(area)) * sizeof(lgfx::rgb565_t);
+
+  if (last) {
+    utilities::BootTimeline::mark(utilities::BootTimeline::Milestone::FirstFrame);
+  }
   lv_display_flush_ready(disp);
 }
@@ -3,12 +3,36 @@
 #include "../main/LGFX_ILI9488_S3.hpp"
 #include <LovyanGFX.hpp>
 #include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
 #include <lvgl.h>
 
 class DisplayManager {
 public:
+  // Flush activity since the previous takeFlushStats() call.
+  struct FlushStats {
+    uint32_t flushes = 0;
+    uint64_t flushUs = 0; // time spent inside disp_flush
+    uint64_t bytes = 0;   // pixel data handed to the panel
+  };
+
   static uint16_t bufferSize() { return gfx.screenWidth * gfx.screenHeight / 10; };
 
   static LGFX gfx;
   static void disp_flush(lv_display_t *disp, const lv_area_t *area, uint8_t *color_p);
+
+  // Serialise SPI2 between the LVGL flush and the touch sampling task, which
+  // share the bus.
+  static void lockBus();
+  static void unlockBus();
+  // lockBus(), then wait for the flush DMA and end the panel's write
+  // transaction. Use before touching the bus other than through disp_flush.
+  static void lockBusIdle();
+
+  // Must be called from the LVGL render task (the only caller of disp_flush).
+  static FlushStats takeFlushStats();
+
+private:
+  static SemaphoreHandle_t busMutex();
+  static FlushStats flushStats_;
 };
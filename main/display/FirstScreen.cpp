@@ -11,6 +11,7 @@
 #include "ConnectDCC.h"
 #include "LvglWrapper.h"
 #include "ManualCalibration.h"
+#include "PerfOverlay.h"
 #include "WaitingScreen.h"
 #include "WifiListScreen.h"
 #include "connection/wifi_control.h"
@@ -114,9 +115,9 @@ void FirstScreen::disableButtons() {
   lv_obj_add_state(btn_wifi_scan, LV_STATE_DISABLED);
 }
 
-// Builds the home screen UI: title, Connect/Scan WiFi/Calibrate buttons and
-// status labels. Subscribes to WiFi messages and immediately reflects current
-// connection state.
+// Builds the home screen UI: title, Connect/Scan WiFi/Calibrate buttons, the
+// performance overlay toggle and status labels. Subscribes to WiFi messages
+// and immediately reflects current connection state.
 void FirstScreen::show(lv_obj_t *parent, std::weak_ptr<Screen> parentScreen) {
   isCleanedUp = false;
   lv_obj_clean(lvObj_);
@@ -136,6 +137,11 @@ void FirstScreen::show(lv_obj_t *parent, std::weak_ptr<Screen> parentScreen) {
   btn_cal = makeButton(lvObj_, "Calibrate", 200, 48, LV_ALIGN_CENTER, 0, 60, "button.secondary");
   lv_obj_add_event_cb(btn_cal, &FirstScreen::event_calibrate_trampoline, LV_EVENT_CLICKED, this);
 
+  // Performance overlay toggle
+  btn_perf = makeButtonSymbol(lvObj_, LV_SYMBOL_SETTINGS, 40, 40, false);
+  lv_obj_align(btn_perf, LV_ALIGN_TOP_RIGHT, -8, 8);
+  lv_obj_add_event_cb(btn_perf, &FirstScreen::event_perf_trampoline, LV_EVENT_CLICKED, this);
+
   disableButtons();
 
   // Status labels under the last button
@@ -181,6 +187,7 @@ void FirstScreen::cleanUp() {
   btn_connect = nullptr;
   btn_wifi_scan = nullptr;
   btn_cal = nullptr;
+  btn_perf = nullptr;
   lbl_status = nullptr;
   lbl_ip = nullptr;
   focusedIndex = -1;
@@ -193,7 +200,7 @@ void FirstScreen::moveFocus(int direction) {
     return;
   }
 
-  constexpr int total = 3;
+  constexpr int total = 4;
   int idx = focusedIndex;
   if (idx < 0 || idx >= total) {
     idx = 0;
@@ -207,10 +214,21 @@ void FirstScreen::moveFocus(int direction) {
   updateFocusedState();
 }
 
-void FirstScreen::updateFocusedState() {
-  applyFocusOutline(btn_connect, focusedIndex == 0);
-  applyFocusOutline(btn_wifi_scan, focusedIndex == 1);
-  applyFocusOutline(btn_cal, focusedIndex == 2);
+void FirstScreen::updateFocusedState() { rotaryShowFocus(focusedIndex); }
+
+lv_obj_t *FirstScreen::rotaryFocusObject(int index) const {
+  switch (index) {
+  case 0:
+    return btn_connect;
+  case 1:
+    return btn_wifi_scan;
+  case 2:
+    return btn_cal;
+  case 3:
+    return btn_perf;
+  default:
+    return nullptr;
+  }
 }
 
 void FirstScreen::rotaryMoveFocus(int direction) { moveFocus(direction); }
@@ -226,6 +244,8 @@ void FirstScreen::rotaryActivateFocused() {
     lv_obj_send_event(btn_wifi_scan, LV_EVENT_CLICKED, nullptr);
   } else if (focusedIndex == 2 && btn_cal && !lv_obj_has_state(btn_cal, LV_STATE_DISABLED)) {
     lv_obj_send_event(btn_cal, LV_EVENT_CLICKED, nullptr);
+  } else if (focusedIndex == 3 && btn_perf) {
+    lv_obj_send_event(btn_perf, LV_EVENT_CLICKED, nullptr);
   }
 }
 
@@ -267,4 +287,15 @@ void FirstScreen::button_calibrate_callback(lv_event_t *e) {
   calScreen->showScreen(FirstScreen::instance());
 }
 
+// Shows or hides the performance overlay; the overlay lives on the top layer
+// so it stays up while navigating to other screens.
+void FirstScreen::button_perf_callback(lv_event_t *e) {
+  if (isCleanedUp)
+    return;
+
+  if (lv_event_get_code(e) != LV_EVENT_CLICKED)
+    return;
+  PerfOverlay::instance()->toggle();
+}
+
 } // namespace display
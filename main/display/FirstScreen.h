@@ -28,6 +28,7 @@ public:
   void button_connect_callback(lv_event_t *e);
   void button_wifi_list_callback(lv_event_t *e);
   void button_calibrate_callback(lv_event_t *e);
+  void button_perf_callback(lv_event_t *e);
 
   void wifi_connected_callback(lv_msg_t *msg);
   void wifi_not_saved_callback(lv_msg_t *msg);
@@ -54,6 +55,12 @@ protected:
       self->button_calibrate_callback(e);
   }
 
+  static void event_perf_trampoline(lv_event_t *e) {
+    auto *self = static_cast<FirstScreen *>(lv_event_get_user_data(e));
+    if (self)
+      self->button_perf_callback(e);
+  }
+
   static void wifi_connected_trampoline(lv_msg_t *msg) {
     auto *self = static_cast<FirstScreen *>(lv_msg_get_user_data(msg));
     if (self)
@@ -70,6 +77,7 @@ private:
   bool rotaryInputEnabled() const override { return !isCleanedUp; }
   void rotaryMoveFocus(int direction) override;
   void rotaryActivateFocused() override;
+  lv_obj_t *rotaryFocusObject(int index) const override;
 
   void moveFocus(int direction);
   void updateFocusedState();
@@ -83,6 +91,7 @@ private:
   lv_obj_t *btn_connect = nullptr;
   lv_obj_t *btn_wifi_scan = nullptr;
   lv_obj_t *btn_cal = nullptr;
+  lv_obj_t *btn_perf = nullptr;
   lv_obj_t *lbl_status = nullptr;
   lv_obj_t *lbl_ip = nullptr;
 };
@@ -0,0 +1,192 @@
+/**
+ * @file FunctionPanel.cpp
+ * @brief Function keys F0-F28 for the throttle screen.
+ *
+ * Loco broadcasts carry the whole function bitmap, often several in a row
+ * while another throttle is busy. The panel keeps the bitmap it last drew and
+ * the latest one received; a timer running once per display refresh period
+ * XORs the two and touches only the keys that differ, so a burst of
+ * broadcasts costs one small redraw. Labels are the roster's function names
+ * ("F3" when a function has none), kept for the last kLabelCacheSize locos
+ * shown and rebuilt when a new roster arrives.
+ */
+#include "FunctionPanel.h"
+#include "definitions.h"
+
+#include <DCCEXProtocol.h>
+#include <bit>
+#include <cstdio>
+
+namespace display {
+
+std::list<FunctionPanel::Labels> FunctionPanel::labelCache_;
+uint32_t FunctionPanel::rosterGeneration_ = 0;
+
+// Creates the scrolling container and the key matrix. Keys are blank until
+// showLoco().
+lv_obj_t *FunctionPanel::create(lv_obj_t *parent, int32_t x, int32_t y, int32_t width, int32_t height,
+                                ToggleCallback toggled, void *userData) {
+  reset();
+  toggled_ = toggled;
+  userData_ = userData;
+
+  container_ = lv_obj_create(parent);
+  lv_obj_remove_style_all(container_);
+  lv_obj_set_pos(container_, x, y);
+  lv_obj_set_size(container_, width, height);
+  lv_obj_set_scroll_dir(container_, LV_DIR_VER);
+  lv_obj_set_scrollbar_mode(container_, LV_SCROLLBAR_MODE_AUTO);
+
+  constexpr int32_t rows = (kFunctionCount + kKeysPerRow - 1) / kKeysPerRow;
+  buttons_ = lv_buttonmatrix_create(container_);
+  lv_obj_set_size(buttons_, width, rows * kRowHeight);
+  lv_obj_add_event_cb(buttons_, &FunctionPanel::value_changed_trampoline, LV_EVENT_VALUE_CHANGED, this);
+
+  flushTimer_ = lv_timer_create(&FunctionPanel::flush_timer_trampoline, LV_DEF_REFR_PERIOD, this);
+  lv_timer_pause(flushTimer_);
+  return container_;
+}
+
+// Forgets the widgets and stops the flush timer. The widgets themselves are
+// deleted with the screen.
+void FunctionPanel::reset() {
+  if (flushTimer_) {
+    lv_timer_delete(flushTimer_);
+    flushTimer_ = nullptr;
+  }
+  container_ = nullptr;
+  buttons_ = nullptr;
+  toggled_ = nullptr;
+  userData_ = nullptr;
+  renderedMap_ = 0;
+  targetMap_ = 0;
+  flushPending_ = false;
+}
+
+// Labels the keys for `address` and draws every key from `functionMap`.
+void FunctionPanel::showLoco(int address, int functionMap) {
+  if (!buttons_) {
+    return;
+  }
+  lv_buttonmatrix_set_map(buttons_, labelsFor(address).map.data());
+  lv_buttonmatrix_set_button_ctrl_all(buttons_, LV_BUTTONMATRIX_CTRL_CHECKABLE);
+  targetMap_ = static_cast<uint32_t>(functionMap);
+  renderAll();
+}
+
+// Records the latest function bitmap; the keys are updated on the next flush.
+void FunctionPanel::setFunctionMap(int functionMap) {
+  targetMap_ = static_cast<uint32_t>(functionMap);
+  if (!flushTimer_ || flushPending_ || targetMap_ == renderedMap_) {
+    return;
+  }
+  flushPending_ = true;
+  lv_timer_resume(flushTimer_);
+}
+
+// Timer callback: updates only the keys whose bits changed since the last
+// draw, then sleeps until the next change.
+void FunctionPanel::flush() {
+  flushPending_ = false;
+  lv_timer_pause(flushTimer_);
+  const uint32_t mask = (1u << kFunctionCount) - 1;
+  for (uint32_t changed = (targetMap_ ^ renderedMap_) & mask; changed != 0; changed &= changed - 1) {
+    const int function = std::countr_zero(changed);
+    setKeyChecked(function, targetMap_ & (1u << function));
+  }
+  renderedMap_ = targetMap_ & mask;
+}
+
+void FunctionPanel::renderAll() {
+  for (int function = 0; function < kFunctionCount; ++function) {
+    setKeyChecked(function, targetMap_ & (1u << function));
+  }
+  renderedMap_ = targetMap_ & ((1u << kFunctionCount) - 1);
+}
+
+void FunctionPanel::setKeyChecked(int function, bool checked) {
+  if (checked) {
+    lv_buttonmatrix_set_button_ctrl(buttons_, function, LV_BUTTONMATRIX_CTRL_CHECKED);
+  } else {
+    lv_buttonmatrix_clear_button_ctrl(buttons_, function, LV_BUTTONMATRIX_CTRL_CHECKED);
+  }
+}
+
+// A key was toggled by touch: reports it, and puts it back if it was not sent.
+void FunctionPanel::onValueChanged() {
+  const uint32_t id = lv_buttonmatrix_get_selected_button(buttons_);
+  if (id == LV_BUTTONMATRIX_BUTTON_NONE || id >= static_cast<uint32_t>(kFunctionCount)) {
+    return;
+  }
+  const bool on = lv_buttonmatrix_has_button_ctrl(buttons_, id, LV_BUTTONMATRIX_CTRL_CHECKED);
+  if (toggled_ && toggled_(static_cast<int>(id), on, userData_)) {
+    renderedMap_ = on ? (renderedMap_ | (1u << id)) : (renderedMap_ & ~(1u << id));
+    targetMap_ = renderedMap_;
+  } else {
+    setKeyChecked(static_cast<int>(id), !on);
+  }
+}
+
+// Labels for `address`, from the cache when they were built for the current
+// roster. The entry is moved to the front; the oldest one beyond
+// kLabelCacheSize is dropped. Never drops the front entry, which is the one
+// on screen.
+const FunctionPanel::Labels &FunctionPanel::labelsFor(int address) {
+  static lv_msg_sub_dsc_t *rosterSub = nullptr;
+  if (!rosterSub) {
+    rosterSub = lv_msg_subscribe(MSG_DCC_ROSTER_LIST_RECEIVED, [](lv_msg_t *) { ++rosterGeneration_; }, nullptr);
+  }
+
+  auto it = labelCache_.begin();
+  while (it != labelCache_.end() && it->address != address) {
+    ++it;
+  }
+  if (it == labelCache_.end()) {
+    labelCache_.emplace_front();
+    if (labelCache_.size() > kLabelCacheSize) {
+      labelCache_.pop_back();
+    }
+    buildLabels(labelCache_.front(), address);
+  } else {
+    labelCache_.splice(labelCache_.begin(), labelCache_, it);
+    if (labelCache_.front().rosterGeneration != rosterGeneration_) {
+      buildLabels(labelCache_.front(), address);
+    }
+  }
+  return labelCache_.front();
+}
+
+// Packs the function names of the roster loco into one buffer and builds the
+// matrix map over it, kKeysPerRow keys to a row.
+void FunctionPanel::buildLabels(Labels &labels, int address) {
+  labels.address = address;
+  labels.rosterGeneration = rosterGeneration_;
+  labels.text.clear();
+
+  auto *loco = DCCExController::Loco::getByAddress(address);
+  std::array<size_t, kFunctionCount> offsets{};
+  for (int function = 0; function < kFunctionCount; ++function) {
+    offsets[function] = labels.text.size();
+    const char *name = loco ? loco->getFunctionName(function) : nullptr;
+    if (name != nullptr && name[0] != '\0') {
+      labels.text.append(name);
+    } else {
+      char fallback[8];
+      snprintf(fallback, sizeof(fallback), "F%d", function);
+      labels.text.append(fallback);
+    }
+    labels.text.push_back('\0');
+  }
+
+  // Pointers are taken only once the buffer has stopped growing.
+  size_t slot = 0;
+  for (int function = 0; function < kFunctionCount; ++function) {
+    if (function > 0 && function % kKeysPerRow == 0) {
+      labels.map[slot++] = "\n";
+    }
+    labels.map[slot++] = labels.text.data() + offsets[function];
+  }
+  labels.map[slot] = "";
+}
+
+} // namespace display
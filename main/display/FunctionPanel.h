@@ -0,0 +1,86 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <string>
+
+#include <lvgl.h>
+
+namespace display {
+
+// Function keys F0-F28 for a throttle: a checkable button matrix in a
+// scrolling container. Function state arrives as whole bitmaps (from loco
+// broadcasts); setFunctionMap() only records the latest one, and once per
+// LVGL timer pass the panel updates just the keys whose bits differ from what
+// it last drew. Key labels come from the roster's function names and are
+// cached per loco, so switching back to a loco does not rebuild them. All
+// methods must run on the LVGL task.
+class FunctionPanel {
+public:
+  // Called when a key is toggled. Returns false if the change was not sent;
+  // the key is then put back.
+  using ToggleCallback = bool (*)(int function, bool on, void *userData);
+
+  static constexpr int kFunctionCount = 29; // F0-F28
+
+  FunctionPanel() = default;
+  FunctionPanel(const FunctionPanel &) = delete;
+  FunctionPanel &operator=(const FunctionPanel &) = delete;
+
+  lv_obj_t *create(lv_obj_t *parent, int32_t x, int32_t y, int32_t width, int32_t height, ToggleCallback toggled,
+                   void *userData);
+  void reset();
+
+  void showLoco(int address, int functionMap);
+  void setFunctionMap(int functionMap);
+
+private:
+  static constexpr int kKeysPerRow = 5;
+  static constexpr int32_t kRowHeight = 44;
+  static constexpr size_t kLabelCacheSize = 8;
+
+  // Labels for one loco: the names packed into one buffer, and the button
+  // matrix map pointing into it.
+  struct Labels {
+    int address = -1;
+    uint32_t rosterGeneration = 0;
+    std::string text;
+    std::array<const char *, kFunctionCount + (kFunctionCount - 1) / kKeysPerRow + 1> map{};
+  };
+
+  static const Labels &labelsFor(int address);
+  static void buildLabels(Labels &labels, int address);
+
+  void flush();
+  void renderAll();
+  void setKeyChecked(int function, bool checked);
+  void onValueChanged();
+
+  static std::list<Labels> labelCache_; // most recently used first
+  static uint32_t rosterGeneration_;     // bumped per roster received; older labels are rebuilt
+
+  lv_obj_t *container_ = nullptr;
+  lv_obj_t *buttons_ = nullptr;
+  lv_timer_t *flushTimer_ = nullptr;
+  ToggleCallback toggled_ = nullptr;
+  void *userData_ = nullptr;
+  uint32_t renderedMap_ = 0; // checked keys as drawn
+  uint32_t targetMap_ = 0;   // latest state, drawn on the next flush
+  bool flushPending_ = false;
+
+  static void flush_timer_trampoline(lv_timer_t *timer) {
+    auto *self = static_cast<FunctionPanel *>(lv_timer_get_user_data(timer));
+    if (self)
+      self->flush();
+  }
+
+  static void value_changed_trampoline(lv_event_t *e) {
+    auto *self = static_cast<FunctionPanel *>(lv_event_get_user_data(e));
+    if (self)
+      self->onValueChanged();
+  }
+};
+
+} // namespace display
@@ -0,0 +1,206 @@
+/**
+ * @file ListFilter.cpp
+ * @brief Type-to-filter bar and name index for long list screens.
+ *
+ * Names are lower-cased into one buffer and indexed by every character and
+ * character pair they contain. A query is answered by verifying only the
+ * entries in the shortest posting list among its characters/pairs; when the
+ * query just grew by typing, the previous matches are verified instead if
+ * that is fewer. Matches are kept in list order so rows do not jump while
+ * typing.
+ */
+#include "ListFilter.h"
+#include "LvglWrapper.h"
+
+#include <algorithm>
+#include <cctype>
+#include <esp_log.h>
+#include <string_view>
+
+namespace display {
+
+static const char *TAG = "LIST_FILTER";
+
+namespace {
+std::string toLower(const char *text) {
+  std::string lower(text ? text : "");
+  std::transform(lower.begin(), lower.end(), lower.begin(),
+                 [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+  return lower;
+}
+} // namespace
+
+// Creates the filter text area at (x, y) and the keyboard it opens. The
+// keyboard covers the bottom third of the screen while typing.
+lv_obj_t *ListFilter::create(lv_obj_t *parent, int32_t x, int32_t y, int32_t width, ChangedCallback changed,
+                             void *userData) {
+  reset();
+  changed_ = changed;
+  userData_ = userData;
+
+  textarea_ = makeTextArea(parent, LV_SYMBOL_EDIT " Filter", false, true);
+  lv_obj_set_flex_grow(textarea_, 0);
+  lv_obj_set_pos(textarea_, x, y);
+  lv_obj_set_size(textarea_, width, kHeight);
+  lv_obj_add_event_cb(textarea_, &ListFilter::textarea_event_trampoline, LV_EVENT_ALL, this);
+
+  keyboard_ = makeKeyboard(parent);
+  lv_obj_add_event_cb(keyboard_, &ListFilter::keyboard_event_trampoline, LV_EVENT_ALL, this);
+  return textarea_;
+}
+
+// Forgets widgets, index and query. The widgets themselves are deleted with
+// the screen (its lv_obj_clean() or the screen cache deleting it).
+void ListFilter::reset() {
+  textarea_ = nullptr;
+  keyboard_ = nullptr;
+  changed_ = nullptr;
+  userData_ = nullptr;
+  clearIndex();
+  entryCount_ = 0;
+  query_.clear();
+  matches_.clear();
+}
+
+// List row showing `entry` under the current query, or -1 if it is filtered
+// out.
+int ListFilter::rowForEntry(size_t entry) const {
+  if (!active()) {
+    return entry < entryCount_ ? static_cast<int>(entry) : -1;
+  }
+  auto it = std::lower_bound(matches_.begin(), matches_.end(), static_cast<uint32_t>(entry));
+  if (it == matches_.end() || *it != entry) {
+    return -1;
+  }
+  return static_cast<int>(it - matches_.begin());
+}
+
+// Text area events: a tap opens the keyboard; every edit re-runs the query.
+void ListFilter::textareaEvent(lv_event_t *e) {
+  switch (lv_event_get_code(e)) {
+  case LV_EVENT_CLICKED:
+  case LV_EVENT_FOCUSED:
+    lv_keyboard_set_textarea(keyboard_, textarea_);
+    lv_obj_remove_flag(keyboard_, LV_OBJ_FLAG_HIDDEN);
+    break;
+  case LV_EVENT_VALUE_CHANGED: {
+    const std::string query = toLower(lv_textarea_get_text(textarea_));
+    if (query == query_) {
+      break;
+    }
+    const bool narrowed = active() && query.size() > query_.size() && query.compare(0, query_.size(), query_) == 0;
+    search(query, narrowed);
+    if (changed_) {
+      changed_(userData_);
+    }
+    break;
+  }
+  default:
+    break;
+  }
+}
+
+// Keyboard events: OK or close hides the keyboard; the query stays applied.
+void ListFilter::keyboardEvent(lv_event_t *e) {
+  const lv_event_code_t code = lv_event_get_code(e);
+  if (code == LV_EVENT_READY || code == LV_EVENT_CANCEL) {
+    lv_obj_add_flag(keyboard_, LV_OBJ_FLAG_HIDDEN);
+    lv_obj_remove_state(textarea_, LV_STATE_FOCUSED);
+  }
+}
+
+void ListFilter::clearIndex() {
+  text_.clear();
+  offsets_.assign(1, 0);
+  postings_.clear();
+}
+
+// Appends one name to the buffer and records its characters and pairs.
+void ListFilter::addName(const std::string &name) {
+  const size_t entry = offsets_.size() - 1;
+  const size_t start = text_.size();
+  text_ += toLower(name.c_str());
+  offsets_.push_back(static_cast<uint32_t>(text_.size()));
+  if (entry >= kMaxEntries) {
+    return;
+  }
+
+  auto post = [&](uint32_t key) {
+    auto &list = postings_[key];
+    if (list.empty() || list.back() != entry) {
+      list.push_back(static_cast<uint16_t>(entry));
+    }
+  };
+  for (size_t i = start; i < text_.size(); ++i) {
+    const auto c = static_cast<unsigned char>(text_[i]);
+    post(charKey(c));
+    if (i + 1 < text_.size()) {
+      post(gramKey(c, static_cast<unsigned char>(text_[i + 1])));
+    }
+  }
+}
+
+// Sets query_ and recomputes matches_. With narrowPrevious the query extends
+// the previous one, so the previous matches are a valid candidate set.
+void ListFilter::search(const std::string &query, bool narrowPrevious) {
+  query_ = query;
+  if (query_.empty()) {
+    matches_.clear();
+    return;
+  }
+
+  // Shortest posting list among the query's characters (single-character
+  // query) or character pairs.
+  static const std::vector<uint16_t> kNone;
+  const std::vector<uint16_t> *best = nullptr;
+  auto consider = [&](uint32_t key) {
+    auto it = postings_.find(key);
+    const std::vector<uint16_t> *list = it != postings_.end() ? &it->second : &kNone;
+    if (!best || list->size() < best->size()) {
+      best = list;
+    }
+  };
+  if (query_.size() == 1) {
+    consider(charKey(static_cast<unsigned char>(query_[0])));
+  } else {
+    for (size_t i = 0; i + 1 < query_.size(); ++i) {
+      consider(gramKey(static_cast<unsigned char>(query_[i]), static_cast<unsigned char>(query_[i + 1])));
+    }
+  }
+
+  std::vector<uint32_t> found;
+  if (narrowPrevious && matches_.size() <= best->size()) {
+    for (uint32_t entry : matches_) {
+      if (nameContains(entry, query_)) {
+        found.push_back(entry);
+      }
+    }
+  } else {
+    for (uint16_t entry : *best) {
+      if (nameContains(entry, query_)) {
+        found.push_back(entry);
+      }
+    }
+    // Entries past the index limit are checked directly.
+    for (size_t entry = kMaxEntries; entry < entryCount_; ++entry) {
+      if (nameContains(entry, query_)) {
+        found.push_back(static_cast<uint32_t>(entry));
+      }
+    }
+  }
+  matches_ = std::move(found);
+  ESP_LOGD(TAG, "Filter \"%s\": %u of %u", query_.c_str(), static_cast<unsigned>(matches_.size()),
+           static_cast<unsigned>(entryCount_));
+}
+
+// True if the lower-cased name of `entry` contains `query`.
+bool ListFilter::nameContains(size_t entry, const std::string &query) const {
+  const size_t start = offsets_[entry];
+  const size_t length = offsets_[entry + 1] - start;
+  if (query.size() > length) {
+    return false;
+  }
+  return std::string_view(text_).substr(start, length).find(query) != std::string_view::npos;
+}
+
+} // namespace display
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <lvgl.h>
+
+namespace display {
+
+// Filter bar for a long list screen: a one-line text area with an on-screen
+// keyboard, backed by a substring index over the entry names. The screen
+// keeps its full entry vector; while a query is active the filter maps list
+// rows to entry positions (matches stay in list order). build() indexes the
+// names once per list received, and each keystroke only consults the index
+// (or narrows the previous matches when the query was extended). All methods
+// must run on the LVGL task.
+class ListFilter {
+public:
+  // Called after the matches change; the screen resizes its list.
+  using ChangedCallback = void (*)(void *userData);
+
+  ListFilter() = default;
+  ListFilter(const ListFilter &) = delete;
+  ListFilter &operator=(const ListFilter &) = delete;
+
+  lv_obj_t *create(lv_obj_t *parent, int32_t x, int32_t y, int32_t width, ChangedCallback changed, void *userData);
+  void reset();
+
+  // Rebuilds the index from `entries`, using `name(entry)` as the searchable
+  // text, and re-runs the current query against it.
+  template <typename Entry, typename NameFn>
+  void build(const std::vector<Entry> &entries, NameFn name) {
+    clearIndex();
+    for (const auto &entry : entries) {
+      addName(name(entry));
+    }
+    entryCount_ = offsets_.size() - 1;
+    search(query_, false);
+  }
+
+  bool active() const { return !query_.empty(); }
+  size_t rowCount() const { return active() ? matches_.size() : entryCount_; }
+  size_t entryForRow(size_t row) const { return active() ? matches_[row] : row; }
+  int rowForEntry(size_t entry) const;
+
+  static constexpr int32_t kHeight = 40;
+  static constexpr size_t kMaxEntries = UINT16_MAX; // postings hold 16-bit entry positions
+
+private:
+  static void textarea_event_trampoline(lv_event_t *e) {
+    auto *self = static_cast<ListFilter *>(lv_event_get_user_data(e));
+    if (self)
+      self->textareaEvent(e);
+  }
+
+  static void keyboard_event_trampoline(lv_event_t *e) {
+    auto *self = static_cast<ListFilter *>(lv_event_get_user_data(e));
+    if (self)
+      self->keyboardEvent(e);
+  }
+
+  void textareaEvent(lv_event_t *e);
+  void keyboardEvent(lv_event_t *e);
+  void clearIndex();
+  void addName(const std::string &name);
+  void search(const std::string &query, bool narrowPrevious);
+  bool nameContains(size_t entry, const std::string &query) const;
+
+  static uint32_t gramKey(unsigned char a, unsigned char b) { return (static_cast<uint32_t>(a) << 8) | b; }
+  static uint32_t charKey(unsigned char c) { return 0x10000u | c; }
+
+  lv_obj_t *textarea_ = nullptr;
+  lv_obj_t *keyboard_ = nullptr;
+  ChangedCallback changed_ = nullptr;
+  void *userData_ = nullptr;
+
+  // Index: lower-cased names packed into one buffer, and for every character
+  // and character pair the ascending list of entries containing it.
+  std::string text_;
+  std::vector<uint32_t> offsets_; // start of each name in text_, plus one past the end
+  std::unordered_map<uint32_t, std::vector<uint16_t>> postings_;
+  size_t entryCount_ = 0;
+
+  std::string query_;             // lower-cased
+  std::vector<uint32_t> matches_; // entry positions matching query_, ascending
+};
+
+} // namespace display
@@ -0,0 +1,138 @@
+/**
+ * @file LvglTask.cpp
+ * @brief Dedicated FreeRTOS task that runs the LVGL timer handler.
+ *
+ * The task is pinned to its own core and blocks on a binary semaphore for the
+ * number of milliseconds lv_timer_handler() returns, so it neither wakes on a
+ * fixed tick nor renders late. Input drivers and other tasks give the
+ * semaphore via wake() (directly or through LvglLock / asyncCall) to have
+ * pending work processed straight away.
+ */
+#include "LvglTask.h"
+
+#include <algorithm>
+#include <esp_log.h>
+#include <esp_timer.h>
+
+namespace display {
+
+static const char *TAG = "LVGL_TASK";
+
+// Upper bound on how long the task sleeps when no LVGL timer is due, so the
+// loop callback (inactivity tracking) still runs periodically.
+constexpr uint32_t kMaxIdleSleepMs = 500;
+
+// Creates the wake semaphore and the render task using the Kconfig core,
+// priority and stack size. Safe to call more than once.
+bool LvglTask::start() {
+  if (task_ != nullptr) {
+    return true;
+  }
+
+  if (wakeSemaphore_ == nullptr) {
+    wakeSemaphore_ = xSemaphoreCreateBinary();
+    if (wakeSemaphore_ == nullptr) {
+      ESP_LOGE(TAG, "Failed to create wake semaphore");
+      return false;
+    }
+  }
+
+  statsStartUs_ = esp_timer_get_time();
+  if (xTaskCreatePinnedToCore(render_task_trampoline, "lvgl_render", CONFIG_LVGL_TASK_STACK_SIZE, this,
+                              CONFIG_LVGL_TASK_PRIORITY, &task_, CONFIG_LVGL_TASK_CORE) != pdPASS) {
+    ESP_LOGE(TAG, "Failed to create LVGL render task");
+    task_ = nullptr;
+    return false;
+  }
+
+  ESP_LOGI(TAG, "LVGL render task started on core %d (priority %d)", CONFIG_LVGL_TASK_CORE,
+           CONFIG_LVGL_TASK_PRIORITY);
+  return true;
+}
+
+// Wakes the render task so lv_timer_handler() runs without waiting for the
+// current sleep interval to expire. A no-op on the render task itself.
+void LvglTask::wake() {
+  if (wakeSemaphore_ == nullptr || isRenderTask()) {
+    return;
+  }
+  xSemaphoreGive(wakeSemaphore_);
+}
+
+// ISR-safe variant of wake() for interrupt-driven input drivers.
+void LvglTask::wakeFromISR(BaseType_t *higherPriorityTaskWoken) {
+  if (wakeSemaphore_ == nullptr) {
+    return;
+  }
+  xSemaphoreGiveFromISR(wakeSemaphore_, higherPriorityTaskWoken);
+}
+
+// Registers a callback invoked under the LVGL lock after every timer pass.
+// Must be set before start().
+void LvglTask::setLoopCallback(LoopCallback cb, void *userData) {
+  loopCallback_ = cb;
+  loopUserData_ = userData;
+}
+
+// Returns the render-loop wakeups and busy time accumulated since the previous
+// call and starts a new sample. Used to measure idle CPU load.
+LvglTask::Stats LvglTask::takeStats() {
+  const int64_t now = esp_timer_get_time();
+  portENTER_CRITICAL(&statsMux_);
+  Stats sample = stats_;
+  sample.elapsedUs = static_cast<uint64_t>(now - statsStartUs_);
+  stats_ = Stats{};
+  statsStartUs_ = now;
+  portEXIT_CRITICAL(&statsMux_);
+  return sample;
+}
+
+// Returns true when called from the render task.
+bool LvglTask::isRenderTask() const { return task_ != nullptr && xTaskGetCurrentTaskHandle() == task_; }
+
+// Queues cb via lv_async_call while holding the LVGL lock, then wakes the
+// render task. Returns false if LVGL could not allocate the async timer.
+bool LvglTask::asyncCall(lv_async_cb_t cb, void *userData) {
+  lv_result_t res;
+  {
+    LvglLock lock;
+    res = lv_async_call(cb, userData);
+  }
+  if (res != LV_RESULT_OK) {
+    ESP_LOGE(TAG, "lv_async_call failed");
+    return false;
+  }
+  return true;
+}
+
+// FreeRTOS entry point: forwards to run() and never returns.
+void LvglTask::render_task_trampoline(void *arg) { static_cast<LvglTask *>(arg)->run(); }
+
+// Render loop: runs due LVGL timers (which take the LVGL lock internally),
+// invokes the loop callback, then sleeps until the next timer is due or
+// wake() is called. The sleep is rounded up to whole ticks and is at least one
+// tick so lower-priority tasks on this core are never starved.
+void LvglTask::run() {
+  while (true) {
+    const int64_t passStartUs = esp_timer_get_time();
+    uint32_t nextMs = lv_timer_handler();
+
+    if (loopCallback_ != nullptr) {
+      lv_lock();
+      loopCallback_(loopUserData_);
+      lv_unlock();
+    }
+
+    const int64_t passUs = esp_timer_get_time() - passStartUs;
+    portENTER_CRITICAL(&statsMux_);
+    ++stats_.wakeups;
+    stats_.busyUs += static_cast<uint64_t>(passUs);
+    portEXIT_CRITICAL(&statsMux_);
+
+    nextMs = std::min<uint32_t>(nextMs, kMaxIdleSleepMs);
+    TickType_t ticks = std::max<TickType_t>(1, (nextMs + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS);
+    xSemaphoreTake(wakeSemaphore_, ticks);
+  }
+}
+
+} // namespace display
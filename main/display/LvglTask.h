@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include <lvgl.h>
+
+namespace display {
+
+// Owns the FreeRTOS task that drives lv_timer_handler(). The task sleeps for
+// exactly the interval LVGL reports until its next timer is due and is woken
+// early by wake() whenever input arrives or work is queued from another task.
+class LvglTask {
+public:
+  using LoopCallback = void (*)(void *userData);
+
+  // Render-loop load since the previous takeStats() call.
+  struct Stats {
+    uint32_t wakeups = 0;   // loop iterations (lv_timer_handler passes)
+    uint64_t busyUs = 0;    // time spent in lv_timer_handler and the loop callback
+    uint64_t elapsedUs = 0; // wall-clock time covered by this sample
+  };
+
+  static std::shared_ptr<LvglTask> instance() {
+    static std::shared_ptr<LvglTask> s;
+    if (!s)
+      s.reset(new LvglTask());
+    return s;
+  }
+
+  LvglTask(const LvglTask &) = delete;
+  LvglTask &operator=(const LvglTask &) = delete;
+
+  bool start();
+  void wake();
+  void wakeFromISR(BaseType_t *higherPriorityTaskWoken);
+  void setLoopCallback(LoopCallback cb, void *userData);
+  bool isRenderTask() const;
+  bool isRunning() const { return task_ != nullptr; }
+  Stats takeStats();
+
+  // Thread-safe replacement for lv_async_call: queues cb on the render task
+  // under the LVGL lock and wakes the task so it runs without waiting for the
+  // next timer period.
+  static bool asyncCall(lv_async_cb_t cb, void *userData);
+
+private:
+  LvglTask() = default;
+
+  static void render_task_trampoline(void *arg);
+  void run();
+
+  TaskHandle_t task_ = nullptr;
+  SemaphoreHandle_t wakeSemaphore_ = nullptr;
+  LoopCallback loopCallback_ = nullptr;
+  void *loopUserData_ = nullptr;
+
+  portMUX_TYPE statsMux_ = portMUX_INITIALIZER_UNLOCKED;
+  Stats stats_;
+  int64_t statsStartUs_ = 0;
+};
+
+// RAII guard around lv_lock()/lv_unlock(). Tasks other than the render task
+// must hold one while touching LVGL objects; releasing it wakes the render
+// task so the change is drawn immediately.
+class LvglLock {
+public:
+  LvglLock() { lv_lock(); }
+  ~LvglLock() {
+    lv_unlock();
+    LvglTask::instance()->wake();
+  }
+
+  LvglLock(const LvglLock &) = delete;
+  LvglLock &operator=(const LvglLock &) = delete;
+};
+
+} // namespace display
@@ -42,6 +42,24 @@ void setStylePart(lv_obj_t *widget, const std::string &styleName, lv_style_selec
   }
 }
 
+// Binds the theme's rotary focus style to LV_STATE_FOCUSED so focus can be
+// moved by toggling that state instead of writing local style properties.
+void setFocusStyle(lv_obj_t *widget) { setStylePart(widget, "focus.outline", LV_PART_MAIN | LV_STATE_FOCUSED); }
+
+// Stores a list position in the widget's user data so event handlers can map
+// the target back to their item vector without scanning it.
+void setItemIndex(lv_obj_t *widget, size_t index) {
+  lv_obj_set_user_data(widget, reinterpret_cast<void *>(static_cast<uintptr_t>(index) + 1));
+}
+
+// List position stored by setItemIndex(), or -1 if none was set.
+int getItemIndex(const lv_obj_t *widget) {
+  if (!widget) {
+    return -1;
+  }
+  return static_cast<int>(reinterpret_cast<uintptr_t>(lv_obj_get_user_data(const_cast<lv_obj_t *>(widget)))) - 1;
+}
+
 // Returns the currently displayed LVGL screen.
 lv_obj_t *getActiveScreen() { return lv_screen_active(); }
 
@@ -67,6 +85,7 @@ lv_obj_t *makeButton(lv_obj_t *parent, const char *text, int32_t width, int32_t
   lv_obj_set_size(btn, width, height);
   lv_obj_align(btn, align, x_ofs, y_ofs);
   setStyle(btn, styleName);
+  setFocusStyle(btn);
 
   lv_obj_t *label = lv_label_create(btn);
   lv_label_set_text(label, text);
@@ -123,6 +142,7 @@ lv_obj_t *lv_list_add_btn_mode(lv_obj_t *list, const void *icon, const char *txt
   lv_obj_class_init_obj(obj);
   lv_obj_set_size(obj, LV_PCT(100), LV_SIZE_CONTENT);
   lv_obj_set_flex_flow(obj, LV_FLEX_FLOW_ROW);
+  setFocusStyle(obj);
 
 #if LV_USE_IMAGE == 1
   if (icon) {
@@ -230,6 +250,7 @@ lv_obj_t *makeButtonSymbol(lv_obj_t *parent, const std::string &symbol, const in
                            bool checkable) {
   lv_obj_t *btn = lv_btn_create(parent);
   lv_obj_set_size(btn, 40, 40);
+  setFocusStyle(btn);
 
   lv_obj_t *eye_lbl = lv_label_create(btn);
   lv_label_set_text(eye_lbl, symbol.c_str());
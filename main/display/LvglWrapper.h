@@ -8,6 +8,9 @@ namespace display {
 
 void setStyle(lv_obj_t *widget, const std::string &styleName);
 void setStylePart(lv_obj_t *widget, const std::string &styleName, lv_style_selector_t selector);
+void setFocusStyle(lv_obj_t *widget);
+void setItemIndex(lv_obj_t *widget, size_t index);
+int getItemIndex(const lv_obj_t *widget);
 
 lv_obj_t *getActiveScreen();
 lv_obj_t *makeLabel(lv_obj_t *parent, const char *text, lv_align_t align, int32_t x_ofs, int32_t y_ofs,
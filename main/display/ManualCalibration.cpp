@@ -153,7 +153,9 @@ calibrateState ManualCalibration::load_from_nvs() {
 // Processes the latest touch sample into the active calibration step and
 // advances to the next corner or finalises calibration when all corners are done.
 void ManualCalibration::calibrate() {
+  DisplayManager::lockBusIdle();
   DisplayManager::gfx.calibrateTouch(parameters, TFT_WHITE, TFT_BLACK, 15);
+  DisplayManager::unlockBus();
   save_to_nvs(calibrated);
   esp_restart();
 }
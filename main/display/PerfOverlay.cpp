@@ -0,0 +1,234 @@
+/**
+ * @file PerfOverlay.cpp
+ * @brief On-device performance overlay.
+ *
+ * Hooks the LVGL display's invalidate/refresh events to measure frame rate,
+ * refresh time and dirty area, pulls flush timing from DisplayManager, and
+ * once per second formats those together with LVGL pool, heap, FreeRTOS task
+ * and DCC traffic statistics into a label on the top layer.
+ */
+#include "PerfOverlay.h"
+#include "DisplayManager.h"
+#include "LvglWrapper.h"
+#include "connection/wifi_connection.h"
+#include "utilities/BootTimeline.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdarg>
+#include <cstdio>
+#include <esp_heap_caps.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <vector>
+
+namespace display {
+
+static const char *TAG = "PERF_OVERLAY";
+
+namespace {
+constexpr uint32_t kUpdatePeriodMs = 1000;
+constexpr size_t kMaxTaskRows = 8;
+constexpr size_t kTextBufferSize = 1024;
+
+// snprintf that appends to buf at len and advances len, never overrunning.
+void appendf(char *buf, size_t size, size_t &len, const char *fmt, ...) {
+  if (len >= size)
+    return;
+  va_list args;
+  va_start(args, fmt);
+  int written = vsnprintf(buf + len, size - len, fmt, args);
+  va_end(args);
+  if (written > 0)
+    len = std::min(size - 1, len + static_cast<size_t>(written));
+}
+} // namespace
+
+// Creates the overlay label on the top layer, attaches the display event hook
+// and starts the 1 s update timer.
+void PerfOverlay::show() {
+  if (isVisible())
+    return;
+
+  display_ = lv_display_get_default();
+  lbl_stats = lv_label_create(lv_layer_top());
+  setStyle(lbl_stats, "label.overlay");
+  lv_obj_align(lbl_stats, LV_ALIGN_TOP_LEFT, 4, 4);
+  lv_label_set_text(lbl_stats, "Collecting...");
+
+  frames_ = 0;
+  refreshUs_ = 0;
+  dirtyPixels_ = 0;
+  pendingDirtyPixels_ = 0;
+  frameInProgress_ = false;
+  lastUpdateUs_ = esp_timer_get_time();
+  lastRxBytes_ = utilities::TCPSocketStream::totalBytesReceived();
+  lastTxBytes_ = utilities::TCPSocketStream::totalBytesSent();
+  lastTaskRuntime_.clear();
+  lastTotalRuntime_ = 0;
+  DisplayManager::takeFlushStats();
+
+  lv_display_add_event_cb(display_, &PerfOverlay::display_event_trampoline, LV_EVENT_ALL, this);
+  updateTimer_ = lv_timer_create(&PerfOverlay::update_timer_trampoline, kUpdatePeriodMs, this);
+  ESP_LOGI(TAG, "Performance overlay shown");
+}
+
+// Removes the label, event hook and timer.
+void PerfOverlay::hide() {
+  if (!isVisible())
+    return;
+
+  if (updateTimer_) {
+    lv_timer_delete(updateTimer_);
+    updateTimer_ = nullptr;
+  }
+  if (display_) {
+    lv_display_remove_event_cb_with_user_data(display_, &PerfOverlay::display_event_trampoline, this);
+    display_ = nullptr;
+  }
+  lv_obj_delete(lbl_stats);
+  lbl_stats = nullptr;
+  ESP_LOGI(TAG, "Performance overlay hidden");
+}
+
+// Shows the overlay if hidden, hides it otherwise.
+void PerfOverlay::toggle() {
+  if (isVisible()) {
+    hide();
+  } else {
+    show();
+  }
+}
+
+// Display event hook. Invalidated areas are summed until the next refresh
+// starts; a refresh that has dirty pixels counts as one frame and its
+// duration (render + flush) is accumulated.
+void PerfOverlay::display_event_callback(lv_event_t *e) {
+  switch (lv_event_get_code(e)) {
+  case LV_EVENT_INVALIDATE_AREA: {
+    auto *area = static_cast<const lv_area_t *>(lv_event_get_param(e));
+    if (area)
+      pendingDirtyPixels_ += lv_area_get_size(area);
+    break;
+  }
+  case LV_EVENT_REFR_START:
+    if (pendingDirtyPixels_ > 0) {
+      dirtyPixels_ += pendingDirtyPixels_;
+      pendingDirtyPixels_ = 0;
+      frameInProgress_ = true;
+      frameStartUs_ = esp_timer_get_time();
+    }
+    break;
+  case LV_EVENT_REFR_READY:
+    if (frameInProgress_) {
+      frameInProgress_ = false;
+      ++frames_;
+      refreshUs_ += static_cast<uint64_t>(esp_timer_get_time() - frameStartUs_);
+    }
+    break;
+  default:
+    break;
+  }
+}
+
+// Appends the busiest tasks since the previous update with their CPU share
+// and minimum free stack. Requires FreeRTOS trace facility and run-time stats.
+void PerfOverlay::appendTaskStats(char *buf, size_t size, size_t &len) {
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY && CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+  std::vector<TaskStatus_t> tasks(uxTaskGetNumberOfTasks() + 4);
+  configRUN_TIME_COUNTER_TYPE totalRuntime = 0;
+  const UBaseType_t count = uxTaskGetSystemState(tasks.data(), tasks.size(), &totalRuntime);
+  tasks.resize(count);
+
+  // Run time is counted per core, so the wall-clock total is scaled by the
+  // number of cores to get a share of the whole chip.
+  const uint64_t totalDelta = static_cast<uint64_t>(static_cast<uint32_t>(totalRuntime) - lastTotalRuntime_) *
+                              static_cast<uint64_t>(portNUM_PROCESSORS);
+  lastTotalRuntime_ = static_cast<uint32_t>(totalRuntime);
+
+  struct Row {
+    const char *name;
+    uint32_t delta;
+    uint32_t stackFree;
+  };
+  std::vector<Row> rows;
+  rows.reserve(count);
+  std::unordered_map<TaskHandle_t, uint32_t> runtimes;
+  for (const auto &task : tasks) {
+    const auto runtime = static_cast<uint32_t>(task.ulRunTimeCounter);
+    auto it = lastTaskRuntime_.find(task.xHandle);
+    const uint32_t previous = it != lastTaskRuntime_.end() ? it->second : runtime;
+    rows.push_back(Row{task.pcTaskName, runtime - previous, static_cast<uint32_t>(task.usStackHighWaterMark)});
+    runtimes.emplace(task.xHandle, runtime);
+  }
+  lastTaskRuntime_ = std::move(runtimes);
+
+  std::sort(rows.begin(), rows.end(), [](const Row &a, const Row &b) { return a.delta > b.delta; });
+  appendf(buf, size, len, "\nTask            CPU   Stack");
+  for (size_t i = 0; i < rows.size() && i < kMaxTaskRows; ++i) {
+    const uint32_t pct = totalDelta > 0 ? static_cast<uint32_t>(rows[i].delta * 100ULL / totalDelta) : 0;
+    appendf(buf, size, len, "\n%-14.14s %3lu%% %6lu", rows[i].name, static_cast<unsigned long>(pct),
+            static_cast<unsigned long>(rows[i].stackFree));
+  }
+#else
+  appendf(buf, size, len, "\nTask stats need CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS");
+#endif
+}
+
+// Timer callback: converts the counters gathered since the last update into
+// rates and averages and rewrites the overlay label.
+void PerfOverlay::update() {
+  if (!isVisible())
+    return;
+
+  const int64_t now = esp_timer_get_time();
+  const uint64_t elapsedUs = static_cast<uint64_t>(std::max<int64_t>(1, now - lastUpdateUs_));
+  lastUpdateUs_ = now;
+
+  const auto flush = DisplayManager::takeFlushStats();
+  const uint64_t frames = frames_;
+  const uint64_t fpsX10 = frames * 10000000ULL / elapsedUs;
+  const uint64_t renderUs = refreshUs_ > flush.flushUs ? refreshUs_ - flush.flushUs : 0;
+  const uint64_t renderUsPerFrame = frames > 0 ? renderUs / frames : 0;
+  const uint64_t flushUsPerFrame = frames > 0 ? flush.flushUs / frames : 0;
+  const uint64_t dirtyPerFrame = frames > 0 ? dirtyPixels_ / frames : 0;
+  frames_ = 0;
+  refreshUs_ = 0;
+  dirtyPixels_ = 0;
+
+  lv_mem_monitor_t mem;
+  lv_mem_monitor(&mem);
+
+  const uint32_t rxBytes = utilities::TCPSocketStream::totalBytesReceived();
+  const uint32_t txBytes = utilities::TCPSocketStream::totalBytesSent();
+  const uint64_t rxRate = static_cast<uint64_t>(rxBytes - lastRxBytes_) * 1000000ULL / elapsedUs;
+  const uint64_t txRate = static_cast<uint64_t>(txBytes - lastTxBytes_) * 1000000ULL / elapsedUs;
+  lastRxBytes_ = rxBytes;
+  lastTxBytes_ = txBytes;
+
+  char text[kTextBufferSize];
+  size_t len = 0;
+  appendf(text, sizeof(text), len,
+          "FPS %" PRIu64 ".%" PRIu64 "  render %" PRIu64 ".%" PRIu64 " ms  flush %" PRIu64 ".%" PRIu64 " ms",
+          fpsX10 / 10, fpsX10 % 10, renderUsPerFrame / 1000, (renderUsPerFrame / 100) % 10, flushUsPerFrame / 1000,
+          (flushUsPerFrame / 100) % 10);
+  appendf(text, sizeof(text), len, "\nDirty %" PRIu64 " px/frame  flushed %" PRIu64 " KB/s", dirtyPerFrame,
+          static_cast<uint64_t>(flush.bytes * 1000000ULL / elapsedUs / 1024));
+  appendf(text, sizeof(text), len, "\nLVGL %lu/%lu KB used (%u%%) frag %u%%",
+          static_cast<unsigned long>((mem.total_size - mem.free_size) / 1024),
+          static_cast<unsigned long>(mem.total_size / 1024), mem.used_pct, mem.frag_pct);
+  appendf(text, sizeof(text), len, "\nInternal %u KB free, %u KB max block",
+          static_cast<unsigned>(heap_caps_get_free_size(MALLOC_CAP_INTERNAL) / 1024),
+          static_cast<unsigned>(heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL) / 1024));
+  appendf(text, sizeof(text), len, "\nPSRAM %u KB free, %u KB max block",
+          static_cast<unsigned>(heap_caps_get_free_size(MALLOC_CAP_SPIRAM) / 1024),
+          static_cast<unsigned>(heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM) / 1024));
+  appendf(text, sizeof(text), len, "\nDCC rx %" PRIu64 " B/s  tx %" PRIu64 " B/s", rxRate, txRate);
+  appendf(text, sizeof(text), len, "\nBoot ");
+  len += utilities::BootTimeline::format(text + len, sizeof(text) - len);
+  appendTaskStats(text, sizeof(text), len);
+
+  lv_label_set_text(lbl_stats, text);
+}
+
+} // namespace display
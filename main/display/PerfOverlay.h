@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <lvgl.h>
+
+namespace display {
+
+// Toggleable on-screen performance monitor drawn on lv_layer_top() so it stays
+// visible across screen changes. Shows frame rate, render/flush time, dirty
+// area, LVGL pool and heap usage, per-task CPU and stack headroom, and DCC
+// protocol traffic. All methods must run on the LVGL task.
+class PerfOverlay {
+public:
+  static std::shared_ptr<PerfOverlay> instance() {
+    static std::shared_ptr<PerfOverlay> s;
+    if (!s)
+      s.reset(new PerfOverlay());
+    return s;
+  }
+
+  PerfOverlay(const PerfOverlay &) = delete;
+  PerfOverlay &operator=(const PerfOverlay &) = delete;
+
+  void show();
+  void hide();
+  void toggle();
+  bool isVisible() const { return lbl_stats != nullptr; }
+
+private:
+  PerfOverlay() = default;
+
+  static void display_event_trampoline(lv_event_t *e) {
+    auto *self = static_cast<PerfOverlay *>(lv_event_get_user_data(e));
+    if (self)
+      self->display_event_callback(e);
+  }
+
+  static void update_timer_trampoline(lv_timer_t *timer) {
+    auto *self = static_cast<PerfOverlay *>(lv_timer_get_user_data(timer));
+    if (self)
+      self->update();
+  }
+
+  void display_event_callback(lv_event_t *e);
+  void update();
+  void appendTaskStats(char *buf, size_t size, size_t &len);
+
+  lv_obj_t *lbl_stats = nullptr;
+  lv_timer_t *updateTimer_ = nullptr;
+  lv_display_t *display_ = nullptr;
+
+  // Frame accounting between updates.
+  uint32_t frames_ = 0;
+  uint64_t refreshUs_ = 0;
+  uint64_t dirtyPixels_ = 0;
+  uint64_t pendingDirtyPixels_ = 0;
+  bool frameInProgress_ = false;
+  int64_t frameStartUs_ = 0;
+  int64_t lastUpdateUs_ = 0;
+
+  // Counters from the previous update, for rate calculations.
+  uint32_t lastRxBytes_ = 0;
+  uint32_t lastTxBytes_ = 0;
+  uint32_t lastTotalRuntime_ = 0;
+  std::unordered_map<TaskHandle_t, uint32_t> lastTaskRuntime_;
+};
+
+} // namespace display
@@ -2,18 +2,27 @@
  * @file RosterList.cpp
  * @brief Screen displaying the locomotive roster received from the DCC-EX server.
  *
- * Subscribes to MSG_ROSTER_UPDATED to keep the list in sync. Tapping a
- * locomotive opens DCCMenu for that engine. Supports rotary-encoder navigation
- * via the shared focus and selection helpers.
+ * Subscribes to MSG_DCC_ROSTER_LIST_RECEIVED to keep the list in sync; a new
+ * roster is reconciled by loco address, so unchanged rows, focus, selection
+ * and the scroll position are kept. A filter bar above the list narrows it to
+ * locos whose name contains the typed text. Tapping a locomotive (or clicking
+ * the encoder on it) takes a throttle slot for it and opens the ThrottleScreen;
+ * a long press adds it to the consist being driven, reverses it, or removes it
+ * again. Supports rotary-encoder navigation via the shared focus and selection
+ * helpers. Rows are drawn by a VirtualList, so only the visible window of the
+ * roster has widgets.
  */
 #include "RosterList.h"
 #include "DCCMenu.h"
 #include "FirstScreen.h"
 #include "LvglWrapper.h"
+#include "MessageBox.h"
 #include "Screen.h"
+#include "Throttle.h"
 #include "WaitingScreen.h"
 #include "connection/wifi_control.h"
 #include "definitions.h"
+#include "utilities/ThrottleSlots.h"
 #include "utilities/WifiHandler.h"
 #include <memory>
 #include <vector>
@@ -22,19 +31,23 @@ namespace display {
 
 static const char *TAG = "ROSTER_LIST_SCREEN";
 
-// Builds the roster list UI and subscribes to the roster-updated message.
+// Builds the roster list UI on the screen's cached LVGL screen and subscribes
+// to the roster list message.
 void RosterListScreen::show(lv_obj_t *parent, std::weak_ptr<Screen> parentScreen) {
   isCleanedUp = false;
 
-  listItems.clear();
-  currentButton = nullptr;
+  roster.clear();
+  rosterIndexByAddress.clear();
+  focusedAddress = -1;
+  selectedAddress = -1;
 
   // Title
   lbl_title = makeLabel(lvObj_, "Roster", LV_ALIGN_TOP_MID, 0, 8, "label.title", &lv_font_montserrat_30);
 
-  // List for Auto Detect
-  list_roster = makeListView(lvObj_, 0, 40, 320, 380);
-  lv_obj_add_event_cb(list_roster, event_listitem_click_trampoline, LV_EVENT_CLICKED, this);
+  // Roster rows, below the filter bar
+  list_roster = rosterRows.create(lvObj_, 0, 88, 320, 332, &RosterListScreen::bind_row_trampoline, this);
+  lv_obj_add_event_cb(list_roster, event_listitem_click_trampoline, LV_EVENT_SHORT_CLICKED, this);
+  lv_obj_add_event_cb(list_roster, event_listitem_click_trampoline, LV_EVENT_LONG_PRESSED, this);
 
   // Bottom Buttons
   btn_back = makeButton(lvObj_, "Back", 100, 40, LV_ALIGN_BOTTOM_LEFT, 8, -12, "button.secondary");
@@ -44,10 +57,45 @@ void RosterListScreen::show(lv_obj_t *parent, std::weak_ptr<Screen> parentScreen
   // btn_connect = makeButton(lvObj_, "Connect", 100, 40, LV_ALIGN_BOTTOM_RIGHT, -8, -12, "button.primary");
   // lv_obj_add_event_cb(btn_connect, &RosterListScreen::event_connect_trampoline, LV_EVENT_CLICKED, this);
 
+  // Filter bar; created last so its keyboard draws over the list
+  ta_filter = rosterFilter.create(lvObj_, 8, 44, 304, &RosterListScreen::filter_changed_trampoline, this);
+
+  subscribeAll();
+  refreshList();
+  rotaryAttach();
+}
+
+// Reattaches the cached screen and reconciles the kept rows with whatever
+// changed while it was hidden (nothing is rebuilt if the roster is the same).
+// The checked row follows the slot the throttle was last driving, and visible
+// rows are rebound for consist changes.
+void RosterListScreen::resume() {
+  isCleanedUp = false;
+  subscribeAll();
   refreshList();
+  auto slots = utilities::ThrottleSlots::instance();
+  const auto *slot = slots->slot(slots->active());
+  selectedAddress = slot ? slot->leadAddress() : -1;
+  rosterRows.setCheckedIndex(rowOfAddress(selectedAddress));
+  rosterRows.refresh();
+  rotaryAttach();
+}
+
+// Subscribes to the roster list message.
+void RosterListScreen::subscribeAll() {
+  unsubscribeAll();
+  roster_list_sub = lv_msg_subscribe(
+      MSG_DCC_ROSTER_LIST_RECEIVED,
+      [](lv_msg_t *msg) {
+        RosterListScreen *self = static_cast<RosterListScreen *>(lv_msg_get_user_data(msg));
+        if (!self || self->isCleanedUp)
+          return;
+        self->refreshList();
+      },
+      this);
 }
 
-// Clears and repopulates the list widget from the latest roster data.
+// Reconciles the list widget with the latest roster data.
 void RosterListScreen::refreshList() {
   auto wifiControl = utilities::WifiControl::instance();
   auto dccProtocol = wifiControl->dccProtocol();
@@ -62,41 +110,141 @@ void RosterListScreen::refreshList() {
     return;
   }
 
-  listItems.clear();
-  lv_obj_clean(list_roster);
+  populateList();
+}
+
+// Reads the named roster entries from DCCEXProtocol and reconciles `roster`
+// with them by address; only added, removed, moved or renamed rows are
+// rebound. While a filter is applied the rows are a filtered view, so the list
+// is re-filtered instead. The address map and filter index are rebuilt only
+// when the roster differs from the one they were built for.
+void RosterListScreen::populateList() {
+  std::vector<RosterEntry> latest;
+  latest.reserve(roster.size());
   auto loco = DCCExController::Loco::getFirst();
   while (loco != nullptr) {
     if (loco->getSource() == DCCExController::LocoSource::LocoSourceRoster) {
       const char *name = loco->getName();
       if (name != nullptr && strlen(name) > 0) {
-        ESP_LOGI(TAG, "Roster ID=%d, Name=%s", loco->getAddress(), name);
+        ESP_LOGD(TAG, "Roster ID=%d, Name=%s", loco->getAddress(), name);
 
-        auto listItem = std::make_shared<RosterListItem>(list_roster, listItems.size(), loco->getAddress(), name);
-        listItems.push_back(listItem);
+        latest.push_back(RosterEntry{loco->getAddress(), name});
       } else {
-        ESP_LOGI(TAG, "Roster ID=%d has no name, skipping", loco->getAddress());
+        ESP_LOGD(TAG, "Roster ID=%d has no name, skipping", loco->getAddress());
       }
     } else {
-      ESP_LOGI(TAG, "Skipping non-roster loco with ID=%d", loco->getAddress());
+      ESP_LOGD(TAG, "Skipping non-roster loco with ID=%d", loco->getAddress());
     }
     loco = loco->getNext();
   }
+  if (latest == roster) {
+    return;
+  }
+
+  const bool filtered = rosterFilter.active();
+  if (filtered) {
+    roster = std::move(latest);
+  } else {
+    rosterRows.reconcile(roster, std::move(latest), [](const RosterEntry &entry) { return entry.address; });
+  }
+  rosterIndexByAddress.clear();
+  rosterIndexByAddress.reserve(roster.size());
+  for (size_t i = 0; i < roster.size(); ++i) {
+    rosterIndexByAddress.emplace(roster[i].address, i);
+  }
+  rosterFilter.build(roster, [](const RosterEntry &entry) { return entry.name; });
+
+  if (filtered) {
+    showFilteredRows();
+    return;
+  }
+  const int checked = rosterRows.checkedIndex();
+  selectedAddress = checked >= 0 ? roster[checked].address : -1;
+  focusedIndex = rosterRows.focusedIndex();
+  if (focusedIndex < 0 && !roster.empty()) {
+    focusedIndex = 0;
+    rosterRows.setFocusedIndex(focusedIndex);
+  }
+  rememberFocusedLoco();
 }
 
-// No message subscriptions to remove for RosterList.
-void RosterListScreen::unsubscribeAll() {}
+// Resizes the list to the filter's matches, keeping the selected loco checked
+// and the focus on the same loco if they still match.
+void RosterListScreen::showFilteredRows() {
+  rosterRows.setCount(rosterFilter.rowCount());
+  rosterRows.setCheckedIndex(rowOfAddress(selectedAddress));
+  focusedIndex = rowOfAddress(focusedAddress);
+  if (focusedIndex < 0 && rosterRows.count() > 0) {
+    focusedIndex = 0;
+  }
+  rosterRows.setFocusedIndex(focusedIndex);
+  rememberFocusedLoco();
+}
 
-// Releases widget pointers and message subscriptions.
+// Records which loco the focused row shows.
+void RosterListScreen::rememberFocusedLoco() {
+  if (focusedIndex < 0 || static_cast<size_t>(focusedIndex) >= rosterRows.count()) {
+    focusedAddress = -1;
+    return;
+  }
+  focusedAddress = roster[rosterFilter.entryForRow(static_cast<size_t>(focusedIndex))].address;
+}
+
+// List row showing the loco with `address`, or -1 if it is absent or filtered
+// out.
+int RosterListScreen::rowOfAddress(int address) const {
+  auto it = rosterIndexByAddress.find(address);
+  return it != rosterIndexByAddress.end() ? rosterFilter.rowForEntry(it->second) : -1;
+}
+
+// VirtualList bind callback: shows the loco name for a row, with an arrow for
+// the way it faces if it is in the consist being driven.
+void RosterListScreen::bindRow(lv_obj_t *row, size_t index) {
+  const size_t entry = rosterFilter.entryForRow(index);
+  if (entry >= roster.size()) {
+    return;
+  }
+  auto slots = utilities::ThrottleSlots::instance();
+  const auto *slot = slots->slot(slots->active());
+  const auto *member = slots->findMember(slots->active(), roster[entry].address);
+  const char *icon = LV_SYMBOL_FILE;
+  if (member && slot->isConsist()) {
+    icon = member->reversed ? LV_SYMBOL_LEFT : LV_SYMBOL_RIGHT;
+  }
+  VirtualList::setRowContent(row, icon, roster[entry].name.c_str());
+}
+
+// Removes roster-related lv_msg subscriptions.
+void RosterListScreen::unsubscribeAll() {
+  if (roster_list_sub) {
+    lv_msg_unsubscribe(roster_list_sub);
+    roster_list_sub = nullptr;
+  }
+}
+
+// Detaches the screen when navigating away. The widgets stay built in the
+// ScreenCache until evicted().
 void RosterListScreen::cleanUp() {
   ESP_LOGI(TAG, "Cleaning up RosterListScreen");
   isCleanedUp = true;
   unsubscribeAll();
-  listItems.clear();
+  rotaryDetach();
+}
+
+// The cache is deleting this screen's widgets: releases the pointers to them
+// and clears the roster.
+void RosterListScreen::evicted() {
+  roster.clear();
+  rosterIndexByAddress.clear();
+  rosterRows.reset();
+  rosterFilter.reset();
   lbl_title = nullptr;
+  ta_filter = nullptr;
   list_roster = nullptr;
   btn_back = nullptr;
-  currentButton = nullptr;
-  lv_obj_clean(lvObj_);
+  focusedIndex = -1;
+  focusedAddress = -1;
+  selectedAddress = -1;
 }
 
 // Returns to the previous screen (typically FirstScreen).
@@ -111,12 +259,13 @@ void RosterListScreen::button_back_callback(lv_event_t *e) {
   }
 }
 
-// Handles taps on individual roster entries: opens DCCMenu for the selected
-// locomotive.
+// Handles taps on individual roster entries: opens the throttle for the
+// tapped locomotive, or on a long press changes its place in the consist.
 void RosterListScreen::button_listitem_click_event_callback(lv_event_t *e) {
   if (isCleanedUp)
     return;
-  if (lv_event_get_code(e) == LV_EVENT_CLICKED) {
+  const lv_event_code_t code = lv_event_get_code(e);
+  if (code == LV_EVENT_SHORT_CLICKED || code == LV_EVENT_LONG_PRESSED) {
     ESP_LOGI(TAG, "List item clicked");
 
     // You can handle the list item click event here if needed
@@ -130,38 +279,80 @@ void RosterListScreen::button_listitem_click_event_callback(lv_event_t *e) {
       return;
     }
 
-    // void * event_data = lv_event_get_user_data(e);
-    ESP_LOGI(TAG, "Clicked: %s", lv_list_get_btn_text(list_roster, target));
-
-    if (currentButton == target) {
-      currentButton = NULL;
-    } else {
-      currentButton = target;
+    const int index = rosterRows.indexForRow(target);
+    if (index < 0) {
+      return;
     }
-    lv_obj_t *parent = lv_obj_get_parent(target);
-    uint32_t i;
-    for (i = 0; i < lv_obj_get_child_cnt(parent); i++) {
-      lv_obj_t *child = lv_obj_get_child(parent, i);
-      if (child == currentButton) {
-        ESP_LOGI(TAG, "Setting CHECKED state on %s", lv_list_get_btn_text(list_roster, child));
-        lv_obj_add_state(child, LV_STATE_CHECKED);
-        // lv_obj_clear_state(btn_connect, LV_STATE_DISABLED);
-      } else {
-        ESP_LOGI(TAG, "Clearing CHECKED state on %s", lv_list_get_btn_text(list_roster, child));
-        lv_obj_clear_state(child, LV_STATE_CHECKED);
-      }
+    ESP_LOGI(TAG, "Clicked: %s", roster[rosterFilter.entryForRow(static_cast<size_t>(index))].name.c_str());
+    focusedIndex = index;
+    rosterRows.setFocusedIndex(focusedIndex);
+    rememberFocusedLoco();
+    if (code == LV_EVENT_LONG_PRESSED) {
+      toggleConsistIndex(index);
+    } else {
+      driveIndex(index);
     }
   }
 }
 
-// Returns the RosterListItem whose LVGL button matches bn, or nullptr.
-std::shared_ptr<RosterListItem> RosterListScreen::getItem(lv_obj_t *bn) {
-  for (const auto &item : listItems) {
-    if (item->getLvObj() == bn) {
-      return item;
-    }
+// Takes a throttle slot for the roster entry in row `index` (or switches to the
+// slot already driving it), marks it as the selected loco and opens the
+// throttle. Back on the throttle returns here with it still checked.
+void RosterListScreen::driveIndex(int index) {
+  const RosterEntry &entry = roster[rosterFilter.entryForRow(static_cast<size_t>(index))];
+  if (utilities::ThrottleSlots::instance()->acquire(entry.address, entry.name) < 0) {
+    showMessageBox("Throttles Busy", "Every throttle slot has a moving loco. Stop and release one first.",
+                   MessageBoxState::Warning);
+    return;
+  }
+  selectedAddress = entry.address;
+  rosterRows.setCheckedIndex(index);
+
+  auto throttle = ThrottleScreen::instance();
+  cleanUp();
+  throttle->showScreen(shared_from_this());
+}
+
+// Long press: cycles the loco in row `index` through the consist of the slot
+// being driven (added, reversed, removed) and redraws its row.
+void RosterListScreen::toggleConsistIndex(int index) {
+  const RosterEntry &entry = roster[rosterFilter.entryForRow(static_cast<size_t>(index))];
+  auto slots = utilities::ThrottleSlots::instance();
+  using Change = utilities::ThrottleSlots::ConsistChange;
+  const Change change = slots->toggleConsistMember(slots->active(), entry.address);
+  if (change == Change::Refused) {
+    showMessageBox("Consist",
+                   "Drive a loco first, then long press up to three others to consist them. "
+                   "A loco already in another slot cannot join.",
+                   MessageBoxState::Info);
+    return;
+  }
+  ESP_LOGI(TAG, "Consist: %s %s", entry.name.c_str(),
+           change == Change::Added ? "added" : (change == Change::Reversed ? "reversed" : "removed"));
+  rosterRows.refreshIndex(static_cast<size_t>(index));
+}
+
+// Row currently showing the roster entry at `index`, if it is materialised.
+lv_obj_t *RosterListScreen::rotaryFocusObject(int index) const { return rosterRows.rowForIndex(index); }
+
+// Moves the rotary focus by `direction` rows (positive down, negative up).
+void RosterListScreen::moveFocus(int direction) {
+  const int count = static_cast<int>(rosterRows.count());
+  if (isCleanedUp || count == 0 || direction == 0) {
+    return;
+  }
+
+  focusedIndex = rotaryStepIndex(focusedIndex, direction, count);
+  rosterRows.setFocusedIndex(focusedIndex);
+  rememberFocusedLoco();
+}
+
+// Single click: drives the focused loco, mirroring a touch tap.
+void RosterListScreen::rotaryActivateFocused() {
+  if (isCleanedUp || focusedIndex < 0 || focusedIndex >= static_cast<int>(rosterRows.count())) {
+    return;
   }
-  return nullptr;
+  driveIndex(focusedIndex);
 }
 
 } // namespace display
\ No newline at end of file
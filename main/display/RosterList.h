@@ -1,11 +1,14 @@
 #pragma once
-#include "Screen.h"
+#include "ListFilter.h"
+#include "RotaryListScreenBase.h"
+#include "VirtualList.h"
 #include <memory>
-
-#include "RosterListItem.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace display {
-class RosterListScreen : public Screen, public std::enable_shared_from_this<RosterListScreen> {
+class RosterListScreen : public RotaryListScreenBase, public std::enable_shared_from_this<RosterListScreen> {
 public:
   static std::shared_ptr<RosterListScreen> instance() {
     static std::shared_ptr<RosterListScreen> s;
@@ -22,19 +25,55 @@ public:
 
   void refreshList();
   void unsubscribeAll();
-  std::shared_ptr<RosterListItem> getItem(lv_obj_t *bn);
 
   void button_back_callback(lv_event_t *e);
   void button_listitem_click_event_callback(lv_event_t *e);
 
 private:
-  std::vector<std::shared_ptr<RosterListItem>> listItems;
+  friend class UiBenchmark;
+
+  struct RosterEntry {
+    int address;
+    std::string name;
+
+    bool operator==(const RosterEntry &) const = default;
+  };
+
+  void populateList();
+  void showFilteredRows();
+  void rememberFocusedLoco();
+  int rowOfAddress(int address) const;
+  void bindRow(lv_obj_t *row, size_t index);
+  void driveIndex(int index);
+  void toggleConsistIndex(int index);
+
+  bool cacheable() const override { return true; }
+  void resume() override;
+  void evicted() override;
+  void subscribeAll();
+
+  bool rotaryInputEnabled() const override { return !isCleanedUp; }
+  bool rotaryAccelerated() const override { return true; }
+  void rotaryMoveFocus(int direction) override { moveFocus(direction); }
+  void rotaryActivateFocused() override;
+  lv_obj_t *rotaryFocusObject(int index) const override;
+  void moveFocus(int direction);
+
+  std::vector<RosterEntry> roster;
+  std::unordered_map<int, size_t> rosterIndexByAddress; // DCC address -> position in `roster`
+  VirtualList rosterRows;
+  ListFilter rosterFilter;
+  int focusedIndex = -1;    // focused list row
+  int focusedAddress = -1;  // loco shown in that row, kept across filter changes
+  int selectedAddress = -1; // checked loco, or -1
+
+  lv_msg_sub_dsc_t *roster_list_sub = nullptr;
 
   bool isCleanedUp = false;
   lv_obj_t *lbl_title = nullptr;
+  lv_obj_t *ta_filter = nullptr;
   lv_obj_t *list_roster = nullptr;
   lv_obj_t *btn_back = nullptr;
-  lv_obj_t *currentButton = nullptr;
 
 protected:
   RosterListScreen() = default;
@@ -50,5 +89,17 @@ protected:
     if (self)
       self->button_listitem_click_event_callback(e);
   }
+
+  static void bind_row_trampoline(lv_obj_t *row, size_t index, void *userData) {
+    auto *self = static_cast<RosterListScreen *>(userData);
+    if (self)
+      self->bindRow(row, index);
+  }
+
+  static void filter_changed_trampoline(void *userData) {
+    auto *self = static_cast<RosterListScreen *>(userData);
+    if (self && !self->isCleanedUp)
+      self->showFilteredRows();
+  }
 };
 } // namespace display
@@ -1,24 +1,36 @@
 #include "RotaryListScreenBase.h"
+#include "LvglTask.h"
+#include "PerfOverlay.h"
 #include "utilities/RotaryEncoder.h"
 #include <lvgl.h>
 
 namespace display {
 
-void RotaryListScreenBase::applyFocusOutline(lv_obj_t *obj, bool focused) {
-  if (!obj) {
-    return;
+// Moves LV_STATE_FOCUSED from the previously shown index to `index` and
+// scrolls it into view. Only those two objects are touched; the outline itself
+// comes from the theme's "focus.outline" style bound to the focused state.
+// Clearing the old index after a list changed only touches whatever row now
+// shows it, which is harmless.
+void RotaryListScreenBase::rotaryShowFocus(int index) {
+  if (shownFocusIndex_ != index) {
+    if (lv_obj_t *previous = rotaryFocusObject(shownFocusIndex_)) {
+      lv_obj_remove_state(previous, LV_STATE_FOCUSED);
+    }
+  }
+  shownFocusIndex_ = index;
+
+  if (lv_obj_t *obj = rotaryFocusObject(index)) {
+    lv_obj_add_state(obj, LV_STATE_FOCUSED);
+    lv_obj_scroll_to_view(obj, LV_ANIM_OFF);
   }
-  lv_obj_set_style_border_width(obj, focused ? 2 : 0, LV_PART_MAIN);
-  lv_obj_set_style_border_opa(obj, focused ? LV_OPA_100 : LV_OPA_TRANSP, LV_PART_MAIN);
-  lv_obj_set_style_border_color(obj, lv_color_hex(0xFF6B00), LV_PART_MAIN);
-  lv_obj_set_style_border_side(obj, focused ? LV_BORDER_SIDE_FULL : LV_BORDER_SIDE_NONE, LV_PART_MAIN);
 }
 
 void RotaryListScreenBase::rotaryAttach() {
   pendingRotateSteps_.store(0, std::memory_order_relaxed);
   utilities::RotaryEncoder::instance()->setCallbacks(
       &RotaryListScreenBase::rotary_rotate_trampoline, &RotaryListScreenBase::rotary_click_trampoline,
-      &RotaryListScreenBase::rotary_long_press_trampoline, this, &RotaryListScreenBase::rotary_double_click_trampoline);
+      &RotaryListScreenBase::rotary_long_press_trampoline, this, &RotaryListScreenBase::rotary_double_click_trampoline,
+      rotaryAccelerated());
 }
 
 void RotaryListScreenBase::rotaryDetach() {
@@ -38,21 +50,42 @@ void RotaryListScreenBase::rotaryNavigateBack() {
 
 void RotaryListScreenBase::rotaryHandleLongPress() { rotaryNavigateBack(); }
 
+// Default double-click toggles the performance overlay from any screen that
+// does not claim the gesture for itself.
+void RotaryListScreenBase::rotaryHandleDoubleClick() { PerfOverlay::instance()->toggle(); }
+
 void RotaryListScreenBase::processPendingRotate() {
   if (!rotaryInputEnabled()) {
     pendingRotateSteps_.store(0, std::memory_order_relaxed);
     return;
   }
 
-  int32_t steps = pendingRotateSteps_.exchange(0, std::memory_order_relaxed);
-  while (steps > 0) {
-    rotaryMoveFocus(1);
-    --steps;
+  // Everything queued since the last drain is applied as one focus move, so
+  // the focused row is redrawn and scrolled to once per frame.
+  const int32_t steps = pendingRotateSteps_.exchange(0, std::memory_order_relaxed);
+  if (steps != 0) {
+    rotaryMoveFocus(static_cast<int>(steps));
+  }
+}
+
+// Focus index `direction` rows on from `index` in a list of `count` rows. A
+// single step wraps around the ends; a larger jump stops at the first or last
+// row, so a fast spin does not fly past the end and reappear at the top.
+int RotaryListScreenBase::rotaryStepIndex(int index, int direction, int count) {
+  if (count <= 0) {
+    return -1;
+  }
+  if (index < 0 || index >= count) {
+    index = 0;
   }
-  while (steps < 0) {
-    rotaryMoveFocus(-1);
-    ++steps;
+  if (direction == 1 || direction == -1) {
+    return (index + direction + count) % count;
   }
+  const int64_t target = static_cast<int64_t>(index) + direction;
+  if (target < 0) {
+    return 0;
+  }
+  return target >= count ? count - 1 : static_cast<int>(target);
 }
 
 void RotaryListScreenBase::rotary_rotate_trampoline(int32_t delta, void *userData) {
@@ -61,8 +94,12 @@ void RotaryListScreenBase::rotary_rotate_trampoline(int32_t delta, void *userDat
     return;
   }
 
-  self->pendingRotateSteps_.fetch_add(delta, std::memory_order_relaxed);
-  lv_async_call(&RotaryListScreenBase::rotary_process_trampoline, self);
+  // Only the first detent of a burst queues a callback; later detents are
+  // folded into the pending count until the render task drains it.
+  if (self->pendingRotateSteps_.fetch_add(delta, std::memory_order_relaxed) == 0 &&
+      !LvglTask::asyncCall(&RotaryListScreenBase::rotary_process_trampoline, self)) {
+    self->pendingRotateSteps_.store(0, std::memory_order_relaxed);
+  }
 }
 
 void RotaryListScreenBase::rotary_click_trampoline(void *userData) {
@@ -71,7 +108,7 @@ void RotaryListScreenBase::rotary_click_trampoline(void *userData) {
     return;
   }
 
-  lv_async_call(
+  LvglTask::asyncCall(
       [](void *ctx) {
         auto *screen = static_cast<RotaryListScreenBase *>(ctx);
         if (screen && screen->rotaryInputEnabled()) {
@@ -87,7 +124,7 @@ void RotaryListScreenBase::rotary_double_click_trampoline(void *userData) {
     return;
   }
 
-  lv_async_call(
+  LvglTask::asyncCall(
       [](void *ctx) {
         auto *screen = static_cast<RotaryListScreenBase *>(ctx);
         if (screen && screen->rotaryInputEnabled()) {
@@ -103,7 +140,7 @@ void RotaryListScreenBase::rotary_long_press_trampoline(void *userData) {
     return;
   }
 
-  lv_async_call(
+  LvglTask::asyncCall(
       [](void *ctx) {
         auto *screen = static_cast<RotaryListScreenBase *>(ctx);
         if (screen && screen->rotaryInputEnabled()) {
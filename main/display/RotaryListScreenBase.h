@@ -13,12 +13,22 @@ protected:
   void rotaryNavigateBack();
 
   virtual bool rotaryInputEnabled() const = 0;
+  // Moves the focus by `direction` rows. Detents that arrive while the LVGL
+  // task is busy are summed, so |direction| can be more than 1.
   virtual void rotaryMoveFocus(int direction) = 0;
   virtual void rotaryActivateFocused() = 0;
   virtual void rotaryHandleLongPress();
-  virtual void rotaryHandleDoubleClick() {}
+  virtual void rotaryHandleDoubleClick();
 
-  static void applyFocusOutline(lv_obj_t *obj, bool focused);
+  // Object drawn as focused for a focus index, or nullptr when the index has
+  // no object (out of range, or the widget has not been built).
+  virtual lv_obj_t *rotaryFocusObject(int index) const = 0;
+  void rotaryShowFocus(int index);
+
+  // Long lists return true to have fast spins scaled by the encoder's
+  // acceleration. Read when the screen attaches.
+  virtual bool rotaryAccelerated() const { return false; }
+  static int rotaryStepIndex(int index, int direction, int count);
 
 private:
   void processPendingRotate();
@@ -30,6 +40,7 @@ private:
   static void rotary_process_trampoline(void *userData);
 
   std::atomic<int32_t> pendingRotateSteps_{0};
+  int shownFocusIndex_ = -1;
 };
 
 } // namespace display
\ No newline at end of file
@@ -4,11 +4,14 @@
  *
  * Allows the user to start, pause and resume routes. Supports rotary-encoder
  * focus navigation and a dedicated pause/resume button that reflects the state
- * of the currently selected route.
+ * of the currently selected route. Rows are drawn by a VirtualList, so only
+ * the visible window of routes has widgets, and a new route list from the
+ * server is reconciled by ID rather than rebuilt.
  */
 #include "RouteList.h"
 #include "LvglWrapper.h"
 #include "connection/wifi_control.h"
+#include "definitions.h"
 #include <cstdio>
 #include <esp_log.h>
 
@@ -16,18 +19,19 @@ namespace display {
 
 static const char *TAG = "ROUTE_LIST_SCREEN";
 
-// Builds the route list UI, sets up rotary callbacks and subscribes to route
-// updated / status messages.
+// Builds the route list UI on the screen's cached LVGL screen, sets up rotary
+// callbacks and subscribes to the route list message.
 void RouteListScreen::show(lv_obj_t *parent, std::weak_ptr<Screen> parentScreen) {
   (void)parent;
   isCleanedUp = false;
   routesPaused = false;
   selectedRouteId = -1;
-  listItems.clear();
+  routes.clear();
+  routeIndexById.clear();
 
   lbl_title = makeLabel(lvObj_, "Routes", LV_ALIGN_TOP_MID, 0, 8, "label.title", &lv_font_montserrat_30);
 
-  list_routes = makeListView(lvObj_, 0, 40, 320, 340);
+  list_routes = routeRows.create(lvObj_, 0, 40, 320, 340, &RouteListScreen::bind_row_trampoline, this);
   lv_obj_add_event_cb(list_routes, event_listitem_click_trampoline, LV_EVENT_CLICKED, this);
 
   lbl_status = makeLabel(lvObj_, "Select a route", LV_ALIGN_BOTTOM_MID, 0, -58, "label.main");
@@ -38,13 +42,39 @@ void RouteListScreen::show(lv_obj_t *parent, std::weak_ptr<Screen> parentScreen)
   btn_pause_resume = makeButton(lvObj_, "Pause", 120, 40, LV_ALIGN_BOTTOM_RIGHT, -8, -12, "button.secondary");
   lv_obj_add_event_cb(btn_pause_resume, &RouteListScreen::event_pause_resume_trampoline, LV_EVENT_CLICKED, this);
 
+  subscribeAll();
   refreshList();
   updatePauseResumeButton();
 
   rotaryAttach();
 }
 
-// Clears and repopulates the list widget from the latest route data.
+// Reattaches the cached screen and reconciles the kept rows with whatever
+// changed while it was hidden.
+void RouteListScreen::resume() {
+  isCleanedUp = false;
+  subscribeAll();
+  refreshList();
+  updatePauseResumeButton();
+  rotaryAttach();
+}
+
+// Subscribes to the route list message.
+void RouteListScreen::subscribeAll() {
+  unsubscribeAll();
+  route_list_sub = lv_msg_subscribe(
+      MSG_DCC_ROUTE_LIST_RECEIVED,
+      [](lv_msg_t *msg) {
+        RouteListScreen *self = static_cast<RouteListScreen *>(lv_msg_get_user_data(msg));
+        if (!self || self->isCleanedUp)
+          return;
+        self->refreshList();
+      },
+      this);
+}
+
+// Reconciles the list widget with the latest route data by route ID; only
+// added, removed, moved or changed rows are rebound.
 void RouteListScreen::refreshList() {
   auto wifiControl = utilities::WifiControl::instance();
   auto dccProtocol = wifiControl->dccProtocol();
@@ -59,30 +89,71 @@ void RouteListScreen::refreshList() {
     return;
   }
 
-  listItems.clear();
-  lv_obj_clean(list_routes);
-
+  std::vector<RouteEntry> latest;
+  latest.reserve(routes.size());
   for (auto route = DCCExController::Route::getFirst(); route; route = route->getNext()) {
     const char *routeName = route->getName();
-    auto listItem = std::make_shared<RouteListItem>(list_routes, listItems.size(), route->getId(),
-                                                    routeName ? routeName : "", static_cast<char>(route->getType()));
-    listItems.push_back(listItem);
+    latest.push_back(RouteEntry{route->getId(), routeName ? routeName : "", static_cast<char>(route->getType())});
   }
 
-  focusedIndex = listItems.empty() ? -1 : 0;
-  updateFocusedState();
+  routeRows.reconcile(routes, std::move(latest), [](const RouteEntry &entry) { return entry.id; });
+  routeIndexById.clear();
+  routeIndexById.reserve(routes.size());
+  for (size_t i = 0; i < routes.size(); ++i) {
+    routeIndexById.emplace(routes[i].id, i);
+  }
+  focusedIndex = routeRows.focusedIndex();
+  if (focusedIndex < 0 && !routes.empty()) {
+    focusedIndex = 0;
+    updateFocusedState();
+  }
   updateSelectedState();
 }
 
-// No message subscriptions to remove for RouteList.
-void RouteListScreen::unsubscribeAll() {}
+// VirtualList bind callback: shows the route/automation icon and name.
+void RouteListScreen::bindRow(lv_obj_t *row, size_t index) {
+  if (index >= routes.size()) {
+    return;
+  }
+  VirtualList::setRowContent(row, routeIcon(routes[index]), routeDisplayName(routes[index]).c_str());
+}
+
+// Name shown for a route; unnamed routes fall back to their ID.
+std::string RouteListScreen::routeDisplayName(const RouteEntry &route) {
+  if (route.name.empty()) {
+    return std::string("Route ") + std::to_string(route.id);
+  }
+  return route.name;
+}
+
+// Automations ('A') loop; plain routes play once.
+const char *RouteListScreen::routeIcon(const RouteEntry &route) {
+  return (route.type == 'A') ? LV_SYMBOL_LOOP : LV_SYMBOL_PLAY;
+}
+
+// Removes route-related lv_msg subscriptions.
+void RouteListScreen::unsubscribeAll() {
+  if (route_list_sub) {
+    lv_msg_unsubscribe(route_list_sub);
+    route_list_sub = nullptr;
+  }
+}
 
-// Releases widget pointers, unregisters rotary callbacks and clears item list.
+// Detaches the screen when navigating away. The widgets stay built in the
+// ScreenCache until evicted().
 void RouteListScreen::cleanUp() {
   ESP_LOGI(TAG, "Cleaning up RouteListScreen");
   isCleanedUp = true;
   unsubscribeAll();
-  listItems.clear();
+  rotaryDetach();
+}
+
+// The cache is deleting this screen's widgets: releases the pointers to them
+// and clears the item list.
+void RouteListScreen::evicted() {
+  routes.clear();
+  routeIndexById.clear();
+  routeRows.reset();
   lbl_title = nullptr;
   lbl_status = nullptr;
   list_routes = nullptr;
@@ -91,8 +162,6 @@ void RouteListScreen::cleanUp() {
   focusedIndex = -1;
   selectedRouteId = -1;
   routesPaused = false;
-  rotaryDetach();
-  lv_obj_clean(lvObj_);
 }
 
 // Returns to the previous screen.
@@ -136,77 +205,46 @@ void RouteListScreen::button_listitem_click_event_callback(lv_event_t *e) {
       return;
     }
 
-    auto item = getItem(target);
-    if (item) {
-      focusedIndex = static_cast<int>(item->index);
+    const int index = routeRows.indexForRow(target);
+    if (index >= 0) {
+      focusedIndex = index;
       updateFocusedState();
-      startRoute(item);
+      startRoute(static_cast<size_t>(index));
     }
   }
 }
 
-// Refreshes the visual focus indicator across all items.
-void RouteListScreen::updateFocusedState() {
-  for (size_t i = 0; i < listItems.size(); ++i) {
-    auto obj = listItems[i]->getLvObj();
-    if (!obj) {
-      continue;
-    }
-    if (static_cast<int>(i) == focusedIndex) {
-      lv_obj_add_state(obj, LV_STATE_FOCUSED);
-      applyFocusOutline(obj, true);
-      lv_obj_scroll_to_view(obj, LV_ANIM_OFF);
-    } else {
-      lv_obj_clear_state(obj, LV_STATE_FOCUSED);
-      applyFocusOutline(obj, false);
-    }
-  }
-}
+// Moves the focus highlight to the focused route, scrolling it into view.
+void RouteListScreen::updateFocusedState() { routeRows.setFocusedIndex(focusedIndex); }
 
-// Refreshes the visual selection state across all items.
-void RouteListScreen::updateSelectedState() {
-  for (const auto &item : listItems) {
-    auto obj = item->getLvObj();
-    if (!obj) {
-      continue;
-    }
+// Row currently showing the route at `index`, if it is materialised.
+lv_obj_t *RouteListScreen::rotaryFocusObject(int index) const { return routeRows.rowForIndex(index); }
 
-    if (item->getRouteId() == selectedRouteId) {
-      lv_obj_add_state(obj, LV_STATE_CHECKED);
-    } else {
-      lv_obj_clear_state(obj, LV_STATE_CHECKED);
-    }
-  }
+// Marks the row of the last started route as checked.
+void RouteListScreen::updateSelectedState() {
+  auto it = routeIndexById.find(selectedRouteId);
+  routeRows.setCheckedIndex(it != routeIndexById.end() ? static_cast<int>(it->second) : -1);
 }
 
-// Moves the rotary focus by `direction` steps (+1 down, -1 up).
+// Moves the rotary focus by `direction` rows (positive down, negative up).
 void RouteListScreen::moveFocus(int direction) {
-  if (isCleanedUp || listItems.empty() || direction == 0) {
+  if (isCleanedUp || routes.empty() || direction == 0) {
     return;
   }
 
-  int index = focusedIndex;
-  if (index < 0 || index >= static_cast<int>(listItems.size())) {
-    index = 0;
-  }
-
-  index = (index + direction) % static_cast<int>(listItems.size());
-  if (index < 0) {
-    index += static_cast<int>(listItems.size());
-  }
-
-  focusedIndex = index;
+  focusedIndex = rotaryStepIndex(focusedIndex, direction, static_cast<int>(routes.size()));
   updateFocusedState();
 }
 
-// Sends the start-route command for the given item to the DCC server.
-void RouteListScreen::startRoute(std::shared_ptr<RouteListItem> item) {
-  if (!item) {
+// Sends the start-route command for the route at `index` to the DCC server.
+void RouteListScreen::startRoute(size_t index) {
+  if (index >= routes.size()) {
     return;
   }
+  const RouteEntry &route = routes[index];
 
   auto wifiControl = utilities::WifiControl::instance();
-  if (!wifiControl->startRoute(item->getRouteId())) {
+  if (!wifiControl->startRoute(route.id)) {
     ESP_LOGW(TAG, "Cannot start route while disconnected");
     setStatusText("DCC not connected");
     return;
@@ -214,24 +252,21 @@ void RouteListScreen::startRoute(std::shared_ptr<RouteListItem> item) {
 
   routesPaused = false;
   updatePauseResumeButton();
-  selectedRouteId = item->getRouteId();
+  selectedRouteId = route.id;
   updateSelectedState();
 
   char status[64];
-  std::snprintf(status, sizeof(status), "Started: %s", item->getDisplayName().c_str());
+  std::snprintf(status, sizeof(status), "Started: %s", routeDisplayName(route).c_str());
   setStatusText(status);
 }
 
 // Triggers the action for the currently focused list item.
 void RouteListScreen::activateFocused() {
-  if (isCleanedUp || focusedIndex < 0 || focusedIndex >= static_cast<int>(listItems.size())) {
+  if (isCleanedUp || focusedIndex < 0 || focusedIndex >= static_cast<int>(routes.size())) {
     return;
   }
 
-  auto item = listItems[focusedIndex];
-  if (item) {
-    startRoute(item);
-  }
+  startRoute(static_cast<size_t>(focusedIndex));
 }
 
 // Syncs the pause/resume button label and enabled state with the selected route.
@@ -249,13 +284,4 @@ void RouteListScreen::setStatusText(const char *text) {
   }
 }
 
-std::shared_ptr<RouteListItem> RouteListScreen::getItem(lv_obj_t *bn) {
-  for (const auto &item : listItems) {
-    if (item->getLvObj() == bn) {
-      return item;
-    }
-  }
-  return nullptr;
-}
-
 } // namespace display
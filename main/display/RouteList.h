@@ -1,8 +1,10 @@
 #pragma once
 #include "RotaryListScreenBase.h"
+#include "VirtualList.h"
 #include <memory>
-
-#include "RouteListItem.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace display {
 class RouteListScreen : public RotaryListScreenBase, public std::enable_shared_from_this<RouteListScreen> {
@@ -22,29 +24,50 @@ public:
 
   void refreshList();
   void unsubscribeAll();
-  std::shared_ptr<RouteListItem> getItem(lv_obj_t *bn);
 
   void button_back_callback(lv_event_t *e);
   void button_pause_resume_callback(lv_event_t *e);
   void button_listitem_click_event_callback(lv_event_t *e);
 
 private:
-  std::vector<std::shared_ptr<RouteListItem>> listItems;
+  struct RouteEntry {
+    int id;
+    std::string name;
+    char type;
+
+    bool operator==(const RouteEntry &) const = default;
+  };
+
+  std::vector<RouteEntry> routes;
+  std::unordered_map<int, size_t> routeIndexById; // DCC ID -> position in `routes`
+  VirtualList routeRows;
   int focusedIndex = -1;
   int selectedRouteId = -1;
 
+  bool cacheable() const override { return true; }
+  void resume() override;
+  void evicted() override;
+  void subscribeAll();
+
   bool rotaryInputEnabled() const override { return !isCleanedUp; }
+  bool rotaryAccelerated() const override { return true; }
   void rotaryMoveFocus(int direction) override { moveFocus(direction); }
   void rotaryActivateFocused() override { activateFocused(); }
+  lv_obj_t *rotaryFocusObject(int index) const override;
 
   void updateFocusedState();
   void moveFocus(int direction);
   void activateFocused();
-  void startRoute(std::shared_ptr<RouteListItem> item);
+  void bindRow(lv_obj_t *row, size_t index);
+  static std::string routeDisplayName(const RouteEntry &route);
+  static const char *routeIcon(const RouteEntry &route);
+  void startRoute(size_t index);
   void updateSelectedState();
   void updatePauseResumeButton();
   void setStatusText(const char *text);
 
+  lv_msg_sub_dsc_t *route_list_sub = nullptr;
+
   bool isCleanedUp = false;
   bool routesPaused = false;
   lv_obj_t *lbl_title = nullptr;
@@ -73,5 +96,11 @@ protected:
     if (self)
       self->button_listitem_click_event_callback(e);
   }
+
+  static void bind_row_trampoline(lv_obj_t *row, size_t index, void *userData) {
+    auto *self = static_cast<RouteListScreen *>(userData);
+    if (self)
+      self->bindRow(row, index);
+  }
 };
 } // namespace display
@@ -2,10 +2,34 @@
  * @file Screen.cpp
  * @brief Base Screen class implementation.
  *
- * Screen is an abstract interface; all behaviour lives in the derived screen
- * classes. This translation unit exists to provide a single linkage point for
- * the vtable.
+ * Screen is an abstract interface; the derived screen classes build their own
+ * widgets. The base class only decides which LVGL screen they are drawn on:
+ * a per-screen cached one (see ScreenCache) or the shared one.
  */
 #include "Screen.h"
+#include "ScreenCache.h"
 
-namespace display {}
\ No newline at end of file
+namespace display {
+
+void Screen::showScreen(std::weak_ptr<Screen> parentScreen) {
+  if (!parentScreen.expired()) {
+    parentScreen_ = parentScreen;
+  }
+
+  auto cache = ScreenCache::instance();
+  if (cacheable()) {
+    bool reused = false;
+    lvObj_ = cache->load(this, reused);
+    if (reused) {
+      resume();
+    } else {
+      show(lvObj_, parentScreen);
+    }
+  } else {
+    lvObj_ = cache->loadShared();
+    show(lvObj_, parentScreen);
+  }
+  cache->trim();
+}
+
+} // namespace display
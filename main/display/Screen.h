@@ -14,28 +14,32 @@ class Screen {
 public:
   virtual ~Screen() = default;
 
-  virtual void showScreen(std::weak_ptr<Screen> parentScreen = std::weak_ptr<Screen>{}) {
-
-    lvObj_ = lv_screen_active();
-    // lv_obj_clean(lvObj_);
-
-    if (!parentScreen.expired()) {
-      parentScreen_ = parentScreen;
-    }
-
-    show(lvObj_, parentScreen);
-  }
+  // Shows this screen on the display. Cacheable screens are loaded from the
+  // ScreenCache and resumed when their widgets are still built; all other
+  // screens are built afresh on the shared screen.
+  virtual void showScreen(std::weak_ptr<Screen> parentScreen = std::weak_ptr<Screen>{});
 
 protected:
   virtual void show(lv_obj_t *parent = nullptr, std::weak_ptr<Screen> parentScreen = std::weak_ptr<Screen>{}) = 0;
 
   virtual void cleanUp() {}
 
+  // Screen cache hooks. A cacheable screen's cleanUp() only detaches it
+  // (subscriptions, input) and leaves its widgets built; resume() reattaches
+  // it when it is shown again, and evicted() forgets the widget pointers just
+  // before the cache deletes them.
+  virtual bool cacheable() const { return false; }
+  virtual void resume() {}
+  virtual void evicted() {}
+
   virtual void showError(esp_err_t err) { ESP_LOGE("ERROR", "ESP Error: %s", esp_err_to_name(err)); }
 
   std::weak_ptr<Screen> parentScreen_;
 
   lv_obj_t *lvObj_ = nullptr;
+
+private:
+  friend class ScreenCache;
 };
 
 } // namespace display
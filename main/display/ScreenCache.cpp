@@ -0,0 +1,106 @@
+/**
+ * @file ScreenCache.cpp
+ * @brief LRU cache of built screens, one LVGL screen object per entry.
+ *
+ * A cacheable screen gets its own lv_obj_create(NULL) screen the first time
+ * it is shown and builds its widgets there; later shows load that screen and
+ * call Screen::resume(). trim() runs after every show and deletes the least
+ * recently used inactive entries while over the count or pool budget.
+ */
+#include "ScreenCache.h"
+#include "Screen.h"
+
+#include "sdkconfig.h"
+#include <esp_log.h>
+
+namespace display {
+
+static const char *TAG = "SCREEN_CACHE";
+
+// Loads the shared screen used by uncached screens and returns it.
+lv_obj_t *ScreenCache::loadShared() {
+  ensureShared();
+  if (lv_screen_active() != shared_) {
+    lv_screen_load(shared_);
+  }
+  return shared_;
+}
+
+// Loads the cached LVGL screen of `screen`, creating an empty one on first
+// use. `reused` is set when the screen's widgets were already built.
+lv_obj_t *ScreenCache::load(Screen *screen, bool &reused) {
+  ensureShared();
+  for (auto &entry : entries_) {
+    if (entry.screen == screen) {
+      entry.lastUsed = ++useCounter_;
+      lv_screen_load(entry.obj);
+      reused = true;
+      return entry.obj;
+    }
+  }
+
+  lv_obj_t *obj = lv_obj_create(nullptr);
+  entries_.push_back(Entry{screen, obj, ++useCounter_});
+  lv_screen_load(obj);
+  reused = false;
+  return obj;
+}
+
+// Evicts least recently used entries, except the active screen, while over
+// CONFIG_SCREEN_CACHE_MAX_SCREENS entries or under
+// CONFIG_SCREEN_CACHE_MIN_FREE_KB of free LVGL pool.
+void ScreenCache::trim() {
+  const lv_obj_t *active = lv_screen_active();
+  while (!entries_.empty()) {
+    lv_mem_monitor_t mem;
+    lv_mem_monitor(&mem);
+    const bool overCount = entries_.size() > static_cast<size_t>(CONFIG_SCREEN_CACHE_MAX_SCREENS);
+    const bool overMemory = mem.free_size < static_cast<size_t>(CONFIG_SCREEN_CACHE_MIN_FREE_KB) * 1024;
+    if (!overCount && !overMemory) {
+      return;
+    }
+
+    size_t oldest = entries_.size();
+    for (size_t i = 0; i < entries_.size(); ++i) {
+      if (entries_[i].obj == active) {
+        continue;
+      }
+      if (oldest == entries_.size() || entries_[i].lastUsed < entries_[oldest].lastUsed) {
+        oldest = i;
+      }
+    }
+    if (oldest == entries_.size()) {
+      return; // only the active screen is left
+    }
+    ESP_LOGI(TAG, "Evicting cached screen (%u cached, %lu B LVGL free)", static_cast<unsigned>(entries_.size()),
+             static_cast<unsigned long>(mem.free_size));
+    evict(oldest);
+  }
+}
+
+// Deletes every cached screen and switches to the shared one.
+void ScreenCache::evictAll() {
+  loadShared();
+  while (!entries_.empty()) {
+    evict(entries_.size() - 1);
+  }
+}
+
+// Remembers the display's original screen the first time the cache is used,
+// before any cached screen is loaded over it.
+void ScreenCache::ensureShared() {
+  if (shared_ == nullptr) {
+    shared_ = lv_screen_active();
+  }
+}
+
+// Lets the screen drop its widget pointers, then deletes its LVGL screen.
+void ScreenCache::evict(size_t position) {
+  const Entry entry = entries_[position];
+  entries_.erase(entries_.begin() + static_cast<std::ptrdiff_t>(position));
+  entry.screen->evicted();
+  entry.screen->lvObj_ = nullptr;
+  lv_obj_delete(entry.obj);
+}
+
+} // namespace display
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <lvgl.h>
+
+namespace display {
+
+class Screen;
+
+// Keeps the widget trees of recently used screens alive, each on its own
+// LVGL screen, so going back to one is an lv_screen_load() instead of a
+// rebuild. Screens opt in with Screen::cacheable(); all other screens share
+// the display's original screen and are rebuilt on every show as before.
+// Cached screens are evicted least recently used first while there are more
+// than CONFIG_SCREEN_CACHE_MAX_SCREENS of them or the LVGL pool has less than
+// CONFIG_SCREEN_CACHE_MIN_FREE_KB free; the active screen is never evicted.
+// All methods must run on the LVGL task.
+class ScreenCache {
+public:
+  static std::shared_ptr<ScreenCache> instance() {
+    static std::shared_ptr<ScreenCache> s;
+    if (!s)
+      s.reset(new ScreenCache());
+    return s;
+  }
+
+  ScreenCache(const ScreenCache &) = delete;
+  ScreenCache &operator=(const ScreenCache &) = delete;
+
+  lv_obj_t *loadShared();
+  lv_obj_t *load(Screen *screen, bool &reused);
+  void trim();
+  void evictAll();
+
+private:
+  ScreenCache() = default;
+
+  struct Entry {
+    Screen *screen;
+    lv_obj_t *obj;
+    uint32_t lastUsed;
+  };
+
+  void ensureShared();
+  void evict(size_t position);
+
+  std::vector<Entry> entries_;
+  lv_obj_t *shared_ = nullptr; // the display's original screen, used by uncached screens
+  uint32_t useCounter_ = 0;
+};
+
+} // namespace display
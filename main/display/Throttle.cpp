@@ -0,0 +1,385 @@
+/**
+ * @file Throttle.cpp
+ * @brief Throttle screen for the locos and consists held in ThrottleSlots.
+ *
+ * A row of slot tabs, a speed arc, forward/stop/reverse buttons, a scrolling
+ * FunctionPanel with F0-F28, an emergency stop, Release and Back. The rotary encoder changes speed
+ * (accelerated on a fast spin); a click stops the loco, or flips direction
+ * when it is already stopped; a double click switches to the next slot. Speed
+ * changes go through ThrottleSlots to WifiControl, which keeps only the latest
+ * value per loco or consist and sends it at a bounded rate, so the UI can
+ * update on every detent without flooding the command station.
+ */
+#include "Throttle.h"
+#include "LvglWrapper.h"
+#include "connection/wifi_control.h"
+#include "definitions.h"
+#include <algorithm>
+#include <cstdio>
+#include <esp_log.h>
+
+namespace display {
+
+static const char *TAG = "THROTTLE_SCREEN";
+
+// Builds the throttle UI for the active slot; RosterList acquires it before
+// showing this screen.
+void ThrottleScreen::show(lv_obj_t *parent, std::weak_ptr<Screen> parentScreen) {
+  isCleanedUp = false;
+
+  lbl_title = makeLabel(lvObj_, "", LV_ALIGN_TOP_MID, 0, 8, "label.title", &lv_font_montserrat_30);
+  lv_label_set_long_mode(lbl_title, LV_LABEL_LONG_MODE_DOTS);
+  lv_obj_set_width(lbl_title, 300);
+  lv_obj_set_style_text_align(lbl_title, LV_TEXT_ALIGN_CENTER, LV_PART_MAIN);
+
+  // One tab per slot; the checked one is being driven
+  for (size_t i = 0; i < slotTabText.size(); ++i) {
+    slotTabMap[i] = slotTabText[i].data();
+  }
+  slotTabMap.back() = "";
+  btnm_slots = lv_buttonmatrix_create(lvObj_);
+  lv_buttonmatrix_set_map(btnm_slots, slotTabMap.data());
+  lv_buttonmatrix_set_button_ctrl_all(btnm_slots, LV_BUTTONMATRIX_CTRL_CHECKABLE);
+  lv_buttonmatrix_set_one_checked(btnm_slots, true);
+  lv_obj_set_size(btnm_slots, 304, 36);
+  lv_obj_align(btnm_slots, LV_ALIGN_TOP_MID, 0, 44);
+  lv_obj_add_event_cb(btnm_slots, &ThrottleScreen::event_slots_trampoline, LV_EVENT_VALUE_CHANGED, this);
+
+  // Speed arc with the value and the addresses driven in its centre
+  arc_speed = lv_arc_create(lvObj_);
+  lv_obj_set_size(arc_speed, 190, 190);
+  lv_obj_align(arc_speed, LV_ALIGN_TOP_MID, 0, 86);
+  lv_arc_set_range(arc_speed, 0, kMaxSpeed);
+  lv_arc_set_bg_angles(arc_speed, 135, 45);
+  lv_obj_add_event_cb(arc_speed, &ThrottleScreen::event_arc_speed_trampoline, LV_EVENT_VALUE_CHANGED, this);
+
+  lbl_speed = lv_label_create(arc_speed);
+  lv_obj_set_style_text_font(lbl_speed, &lv_font_montserrat_30, LV_PART_MAIN);
+  lv_obj_align(lbl_speed, LV_ALIGN_CENTER, 0, -8);
+
+  lbl_address = makeLabel(arc_speed, "", LV_ALIGN_CENTER, 0, 26, "label.muted");
+
+  // Direction and stop
+  btn_reverse = makeButton(lvObj_, LV_SYMBOL_LEFT " Rev", 96, 44, LV_ALIGN_TOP_LEFT, 8, 284, "button.secondary");
+  lv_obj_add_event_cb(btn_reverse, &ThrottleScreen::event_direction_trampoline, LV_EVENT_CLICKED, this);
+  btn_stop = makeButton(lvObj_, LV_SYMBOL_STOP, 96, 44, LV_ALIGN_TOP_MID, 0, 284, "button.secondary");
+  lv_obj_add_event_cb(btn_stop, &ThrottleScreen::event_stop_trampoline, LV_EVENT_CLICKED, this);
+  btn_forward = makeButton(lvObj_, "Fwd " LV_SYMBOL_RIGHT, 96, 44, LV_ALIGN_TOP_RIGHT, -8, 284, "button.secondary");
+  lv_obj_add_event_cb(btn_forward, &ThrottleScreen::event_direction_trampoline, LV_EVENT_CLICKED, this);
+  setStylePart(btn_reverse, "button.primary", LV_STATE_CHECKED);
+  setStylePart(btn_forward, "button.primary", LV_STATE_CHECKED);
+
+  // Function keys, two rows visible; scroll for the rest
+  functionPanel.create(lvObj_, 8, 336, 304, 88, &ThrottleScreen::function_toggled_trampoline, this);
+
+  btn_back = makeButton(lvObj_, "Back", 100, 40, LV_ALIGN_BOTTOM_LEFT, 8, -12, "button.secondary");
+  lv_obj_add_event_cb(btn_back, &ThrottleScreen::event_back_trampoline, LV_EVENT_CLICKED, this);
+  btn_release = makeButton(lvObj_, "Release", 96, 40, LV_ALIGN_BOTTOM_MID, 0, -12, "button.secondary");
+  lv_obj_add_event_cb(btn_release, &ThrottleScreen::event_release_trampoline, LV_EVENT_CLICKED, this);
+  btn_estop = makeButton(lvObj_, "E-Stop", 100, 40, LV_ALIGN_BOTTOM_RIGHT, -8, -12, "button.primary");
+  lv_obj_set_style_bg_color(btn_estop, lv_palette_main(LV_PALETTE_RED), LV_PART_MAIN);
+  lv_obj_add_event_cb(btn_estop, &ThrottleScreen::event_estop_trampoline, LV_EVENT_CLICKED, this);
+
+  auto slots = utilities::ThrottleSlots::instance();
+  slots->syncFromLoco(slots->active());
+  showSlot();
+
+  loco_changed_sub = lv_msg_subscribe(
+      MSG_DCC_LOCO_CHANGED,
+      [](lv_msg_t *msg) {
+        ThrottleScreen *self = static_cast<ThrottleScreen *>(lv_msg_get_user_data(msg));
+        if (!self || self->isCleanedUp)
+          return;
+        const auto *data = static_cast<const LocoActionData *>(lv_msg_get_payload(msg));
+        const auto *slot = self->activeSlot();
+        if (data && slot && data->address == slot->leadAddress()) {
+          auto slots = utilities::ThrottleSlots::instance();
+          if (slots->applyServerState(slots->active(), data->speed, data->forward, data->functionMap)) {
+            self->showSpeed();
+            self->showDirection();
+            self->functionPanel.setFunctionMap(slot->functionMap);
+          }
+        }
+      },
+      this);
+
+  rotaryAttach();
+}
+
+// Removes throttle-related lv_msg subscriptions.
+void ThrottleScreen::unsubscribeAll() {
+  if (loco_changed_sub) {
+    lv_msg_unsubscribe(loco_changed_sub);
+    loco_changed_sub = nullptr;
+  }
+}
+
+// Releases widget pointers and subscriptions. The locos keep running at their
+// current speed, as with a handheld throttle.
+void ThrottleScreen::cleanUp() {
+  ESP_LOGI(TAG, "Cleaning up ThrottleScreen");
+  isCleanedUp = true;
+  unsubscribeAll();
+  rotaryDetach();
+  lbl_title = nullptr;
+  btnm_slots = nullptr;
+  lbl_address = nullptr;
+  arc_speed = nullptr;
+  lbl_speed = nullptr;
+  btn_reverse = nullptr;
+  btn_stop = nullptr;
+  btn_forward = nullptr;
+  functionPanel.reset();
+  btn_back = nullptr;
+  btn_release = nullptr;
+  btn_estop = nullptr;
+  lv_obj_clean(lvObj_);
+}
+
+const utilities::ThrottleSlots::Slot *ThrottleScreen::activeSlot() const {
+  auto slots = utilities::ThrottleSlots::instance();
+  const auto *slot = slots->slot(slots->active());
+  return slot && slot->inUse() ? slot : nullptr;
+}
+
+// Single click: stops a moving loco; a stopped one changes direction.
+void ThrottleScreen::rotaryActivateFocused() {
+  const auto *slot = activeSlot();
+  if (isCleanedUp || !slot) {
+    return;
+  }
+  if (slot->speed > 0) {
+    setSpeed(0);
+  } else {
+    setDirection(!slot->forward);
+  }
+}
+
+// Double click: drives the next slot, so several locos can be run from the
+// encoder alone. With a single slot it keeps the default action.
+void ThrottleScreen::rotaryHandleDoubleClick() {
+  auto slots = utilities::ThrottleSlots::instance();
+  if (isCleanedUp || slots->inUseCount() < 2) {
+    RotaryListScreenBase::rotaryHandleDoubleClick();
+    return;
+  }
+  switchToSlot(-1);
+}
+
+// Makes slot `index` (or the next used slot, for -1) the one being driven.
+void ThrottleScreen::switchToSlot(int index) {
+  auto slots = utilities::ThrottleSlots::instance();
+  if (index < 0) {
+    index = slots->selectNext();
+  } else {
+    slots->select(index);
+  }
+  slots->syncFromLoco(slots->active());
+  showSlot();
+}
+
+// Rotary steps: one speed step per (accelerated) detent.
+void ThrottleScreen::changeSpeed(int delta) {
+  const auto *slot = activeSlot();
+  if (isCleanedUp || !slot || delta == 0) {
+    return;
+  }
+  setSpeed(std::clamp(slot->speed + delta, 0, kMaxSpeed));
+}
+
+// Shows `newSpeed` and queues it for every loco in the slot.
+void ThrottleScreen::setSpeed(int newSpeed) {
+  const auto *slot = activeSlot();
+  if (!slot || newSpeed == slot->speed) {
+    return;
+  }
+  auto slots = utilities::ThrottleSlots::instance();
+  slots->setSpeed(slots->active(), newSpeed, slot->forward);
+  showSpeed();
+}
+
+// Changes direction. DCC decoders are normally reversed at a standstill, but
+// a moving loco is allowed to reverse too, as on most handheld throttles.
+void ThrottleScreen::setDirection(bool newForward) {
+  const auto *slot = activeSlot();
+  if (!slot || newForward == slot->forward) {
+    return;
+  }
+  auto slots = utilities::ThrottleSlots::instance();
+  slots->setSpeed(slots->active(), slot->speed, newForward);
+  showDirection();
+}
+
+// Shows everything about the active slot: name, addresses, speed, direction,
+// functions and the slot tabs.
+void ThrottleScreen::showSlot() {
+  const auto *slot = activeSlot();
+  if (!lbl_title) {
+    return;
+  }
+  lv_label_set_text(lbl_title, slot ? slot->name.c_str() : "");
+
+  // "DCC 3" for a single loco, "3+12r+7" for a consist, r marking reversed members
+  char text[48] = "";
+  if (slot && !slot->isConsist()) {
+    snprintf(text, sizeof(text), "DCC %d", slot->leadAddress());
+  } else if (slot) {
+    size_t length = 0;
+    for (size_t i = 0; i < slot->memberCount && length < sizeof(text); ++i) {
+      length += snprintf(text + length, sizeof(text) - length, "%s%d%s", i > 0 ? "+" : "", slot->members[i].address,
+                         slot->members[i].reversed ? "r" : "");
+    }
+  }
+  lv_label_set_text(lbl_address, text);
+
+  showSlotTabs();
+  showSpeed();
+  showDirection();
+  showFunctions();
+}
+
+// Labels each tab with its lead address ("+n" for a consist's other members)
+// and checks the active one. Empty slots are disabled.
+void ThrottleScreen::showSlotTabs() {
+  if (!btnm_slots) {
+    return;
+  }
+  auto slots = utilities::ThrottleSlots::instance();
+  for (size_t i = 0; i < slotTabText.size(); ++i) {
+    const auto *slot = slots->slot(static_cast<int>(i));
+    auto &text = slotTabText[i];
+    if (!slot || !slot->inUse()) {
+      snprintf(text.data(), text.size(), "-");
+    } else if (slot->isConsist()) {
+      snprintf(text.data(), text.size(), "%d+%u", slot->leadAddress(), static_cast<unsigned>(slot->memberCount - 1));
+    } else {
+      snprintf(text.data(), text.size(), "%d", slot->leadAddress());
+    }
+  }
+  lv_buttonmatrix_set_map(btnm_slots, slotTabMap.data());
+  lv_buttonmatrix_set_button_ctrl_all(btnm_slots, LV_BUTTONMATRIX_CTRL_CHECKABLE);
+  for (size_t i = 0; i < slotTabText.size(); ++i) {
+    const auto *slot = slots->slot(static_cast<int>(i));
+    if (!slot || !slot->inUse()) {
+      lv_buttonmatrix_set_button_ctrl(btnm_slots, i, LV_BUTTONMATRIX_CTRL_DISABLED);
+    }
+  }
+  if (slots->active() >= 0) {
+    lv_buttonmatrix_set_button_ctrl(btnm_slots, slots->active(), LV_BUTTONMATRIX_CTRL_CHECKED);
+  }
+}
+
+void ThrottleScreen::showSpeed() {
+  const auto *slot = activeSlot();
+  if (!arc_speed) {
+    return;
+  }
+  const int speed = slot ? slot->speed : 0;
+  lv_arc_set_value(arc_speed, speed);
+  lv_label_set_text_fmt(lbl_speed, "%d", speed);
+}
+
+// Checks the button for the current direction.
+void ThrottleScreen::showDirection() {
+  const auto *slot = activeSlot();
+  if (!btn_forward) {
+    return;
+  }
+  const bool forward = !slot || slot->forward;
+  lv_obj_set_state(btn_forward, LV_STATE_CHECKED, forward);
+  lv_obj_set_state(btn_reverse, LV_STATE_CHECKED, !forward);
+}
+
+// Labels the function keys for the slot's lead loco and checks the ones that
+// are on.
+void ThrottleScreen::showFunctions() {
+  const auto *slot = activeSlot();
+  functionPanel.showLoco(slot ? slot->leadAddress() : -1, slot ? slot->functionMap : 0);
+}
+
+// Returns to the previous screen (the roster).
+void ThrottleScreen::button_back_callback(lv_event_t *e) {
+  if (isCleanedUp)
+    return;
+  if (lv_event_get_code(e) == LV_EVENT_CLICKED) {
+    if (auto screen = parentScreen_.lock()) {
+      cleanUp();
+      screen->showScreen();
+    }
+  }
+}
+
+void ThrottleScreen::button_direction_callback(lv_event_t *e) {
+  if (isCleanedUp)
+    return;
+  setDirection(lv_event_get_target(e) == btn_forward);
+}
+
+void ThrottleScreen::button_stop_callback(lv_event_t *e) {
+  if (isCleanedUp)
+    return;
+  setSpeed(0);
+}
+
+// Stops every loco on the layout and shows every slot stopped.
+void ThrottleScreen::button_estop_callback(lv_event_t *e) {
+  if (isCleanedUp)
+    return;
+  utilities::WifiControl::instance()->emergencyStop();
+  auto slots = utilities::ThrottleSlots::instance();
+  for (size_t i = 0; i < utilities::ThrottleSlots::kMaxSlots; ++i) {
+    const auto *slot = slots->slot(static_cast<int>(i));
+    if (slot && slot->inUse() && slot->speed > 0) {
+      slots->setSpeed(static_cast<int>(i), 0, slot->forward);
+    }
+  }
+  showSpeed();
+}
+
+// Stops and frees the active slot, then drives the next one, or goes back to
+// the roster when none is left.
+void ThrottleScreen::button_release_callback(lv_event_t *e) {
+  if (isCleanedUp)
+    return;
+  auto slots = utilities::ThrottleSlots::instance();
+  const int released = slots->active();
+  setSpeed(0);
+  slots->release(released);
+  if (slots->active() >= 0) {
+    switchToSlot(slots->active());
+    return;
+  }
+  if (auto screen = parentScreen_.lock()) {
+    cleanUp();
+    screen->showScreen();
+  }
+}
+
+// A slot tab was tapped.
+void ThrottleScreen::slots_callback(lv_event_t *e) {
+  if (isCleanedUp)
+    return;
+  const uint32_t id = lv_buttonmatrix_get_selected_button(btnm_slots);
+  if (id == LV_BUTTONMATRIX_BUTTON_NONE) {
+    return;
+  }
+  switchToSlot(static_cast<int>(id));
+}
+
+// Dragging the arc: every value is queued, WifiControl coalesces them.
+void ThrottleScreen::arc_speed_callback(lv_event_t *e) {
+  if (isCleanedUp)
+    return;
+  setSpeed(static_cast<int>(lv_arc_get_value(arc_speed)));
+}
+
+// A function key was toggled; sends the new state of that function to the
+// lead loco.
+bool ThrottleScreen::toggleFunction(int function, bool on) {
+  if (isCleanedUp)
+    return false;
+  auto slots = utilities::ThrottleSlots::instance();
+  return slots->setFunction(slots->active(), function, on);
+}
+
+} // namespace display
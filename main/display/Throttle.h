@@ -0,0 +1,126 @@
+#pragma once
+#include "FunctionPanel.h"
+#include "RotaryListScreenBase.h"
+#include "utilities/ThrottleSlots.h"
+#include <array>
+#include <memory>
+
+namespace display {
+class ThrottleScreen : public RotaryListScreenBase, public std::enable_shared_from_this<ThrottleScreen> {
+public:
+  static std::shared_ptr<ThrottleScreen> instance() {
+    static std::shared_ptr<ThrottleScreen> s;
+    if (!s)
+      s.reset(new ThrottleScreen());
+    return s;
+  }
+  ThrottleScreen(const ThrottleScreen &) = delete;
+  ThrottleScreen &operator=(const ThrottleScreen &) = delete;
+  ~ThrottleScreen() override = default;
+
+  void show(lv_obj_t *parent = nullptr, std::weak_ptr<Screen> parentScreen = std::weak_ptr<Screen>{}) override;
+  void cleanUp() override;
+
+  void unsubscribeAll();
+
+  void button_back_callback(lv_event_t *e);
+  void button_direction_callback(lv_event_t *e);
+  void button_stop_callback(lv_event_t *e);
+  void button_estop_callback(lv_event_t *e);
+  void button_release_callback(lv_event_t *e);
+  void slots_callback(lv_event_t *e);
+  void arc_speed_callback(lv_event_t *e);
+
+  static constexpr int kMaxSpeed = utilities::ThrottleSlots::kMaxSpeed;
+
+private:
+  bool rotaryInputEnabled() const override { return !isCleanedUp; }
+  bool rotaryAccelerated() const override { return true; }
+  void rotaryMoveFocus(int direction) override { changeSpeed(direction); }
+  void rotaryActivateFocused() override;
+  void rotaryHandleDoubleClick() override;
+  lv_obj_t *rotaryFocusObject(int index) const override { return nullptr; }
+
+  const utilities::ThrottleSlots::Slot *activeSlot() const;
+  void changeSpeed(int delta);
+  void setSpeed(int newSpeed);
+  void setDirection(bool newForward);
+  void switchToSlot(int index);
+  void showSlot();
+  void showSlotTabs();
+  void showSpeed();
+  void showDirection();
+  void showFunctions();
+  bool toggleFunction(int function, bool on);
+
+  // Button labels for the slot tabs; btnm_slots keeps pointers into these.
+  std::array<std::array<char, 12>, utilities::ThrottleSlots::kMaxSlots> slotTabText{};
+  std::array<const char *, utilities::ThrottleSlots::kMaxSlots + 1> slotTabMap{};
+
+  lv_msg_sub_dsc_t *loco_changed_sub = nullptr;
+
+  bool isCleanedUp = false;
+  lv_obj_t *lbl_title = nullptr;
+  lv_obj_t *btnm_slots = nullptr;
+  lv_obj_t *lbl_address = nullptr;
+  lv_obj_t *arc_speed = nullptr;
+  lv_obj_t *lbl_speed = nullptr;
+  lv_obj_t *btn_reverse = nullptr;
+  lv_obj_t *btn_stop = nullptr;
+  lv_obj_t *btn_forward = nullptr;
+  FunctionPanel functionPanel;
+  lv_obj_t *btn_back = nullptr;
+  lv_obj_t *btn_release = nullptr;
+  lv_obj_t *btn_estop = nullptr;
+
+protected:
+  ThrottleScreen() = default;
+
+  static void event_back_trampoline(lv_event_t *e) {
+    auto *self = static_cast<ThrottleScreen *>(lv_event_get_user_data(e));
+    if (self)
+      self->button_back_callback(e);
+  }
+
+  static void event_direction_trampoline(lv_event_t *e) {
+    auto *self = static_cast<ThrottleScreen *>(lv_event_get_user_data(e));
+    if (self)
+      self->button_direction_callback(e);
+  }
+
+  static void event_stop_trampoline(lv_event_t *e) {
+    auto *self = static_cast<ThrottleScreen *>(lv_event_get_user_data(e));
+    if (self)
+      self->button_stop_callback(e);
+  }
+
+  static void event_estop_trampoline(lv_event_t *e) {
+    auto *self = static_cast<ThrottleScreen *>(lv_event_get_user_data(e));
+    if (self)
+      self->button_estop_callback(e);
+  }
+
+  static void event_release_trampoline(lv_event_t *e) {
+    auto *self = static_cast<ThrottleScreen *>(lv_event_get_user_data(e));
+    if (self)
+      self->button_release_callback(e);
+  }
+
+  static void event_slots_trampoline(lv_event_t *e) {
+    auto *self = static_cast<ThrottleScreen *>(lv_event_get_user_data(e));
+    if (self)
+      self->slots_callback(e);
+  }
+
+  static void event_arc_speed_trampoline(lv_event_t *e) {
+    auto *self = static_cast<ThrottleScreen *>(lv_event_get_user_data(e));
+    if (self)
+      self->arc_speed_callback(e);
+  }
+
+  static bool function_toggled_trampoline(int function, bool on, void *userData) {
+    auto *self = static_cast<ThrottleScreen *>(userData);
+    return self && self->toggleFunction(function, on);
+  }
+};
+} // namespace display
@@ -0,0 +1,400 @@
+/**
+ * @file TrackDiagram.cpp
+ * @brief Schematic track diagram with the turnouts drawn at their points.
+ *
+ * The layout is read from CONFIG_TRACK_DIAGRAM_PATH on the spiffs partition
+ * (see spiffs/layout.txt for the format). Plain track, both legs of every
+ * point and the labels are rendered once into a canvas whose buffer lives in
+ * PSRAM, and the screen is kept in the ScreenCache so that image survives
+ * leaving and coming back. Each point has a small transparent object on top
+ * of the canvas that draws only the leg the turnout is set to; a
+ * MSG_DCC_TURNOUT_CHANGED invalidates just that object, so LVGL redraws a
+ * point-sized area instead of the diagram. Tapping a point, or focusing it
+ * with the encoder and clicking, throws it through WifiControl.
+ */
+#include "TrackDiagram.h"
+#include "LvglWrapper.h"
+#include "connection/wifi_control.h"
+#include "definitions.h"
+#include "sdkconfig.h"
+#include <DCCEXProtocol.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <esp_heap_caps.h>
+
+namespace display {
+
+static const char *TAG = "TRACK_DIAGRAM_SCREEN";
+
+namespace {
+constexpr int32_t kTop = 48;         // diagram area below the title
+constexpr int32_t kPointRadius = 18; // half the size of a point's hit/redraw box
+constexpr int32_t kTrackWidth = 4;
+
+lv_color_t trackColor() { return lv_palette_darken(LV_PALETTE_GREY, 1); }
+lv_color_t legColor() { return lv_palette_lighten(LV_PALETTE_GREY, 1); }
+lv_color_t closedColor() { return lv_palette_main(LV_PALETTE_GREEN); }
+lv_color_t thrownColor() { return lv_palette_main(LV_PALETTE_ORANGE); }
+
+void drawLine(lv_layer_t *layer, lv_draw_line_dsc_t *dsc, int32_t x1, int32_t y1, int32_t x2, int32_t y2) {
+  dsc->p1.x = x1;
+  dsc->p1.y = y1;
+  dsc->p2.x = x2;
+  dsc->p2.y = y2;
+  lv_draw_line(layer, dsc);
+}
+} // namespace
+
+// Builds the diagram: loads the layout, renders the static image once and
+// puts a point object over every turnout.
+void TrackDiagramScreen::show(lv_obj_t *parent, std::weak_ptr<Screen> parentScreen) {
+  isCleanedUp = false;
+  focusedIndex = -1;
+
+  lbl_title = makeLabel(lvObj_, "Track Diagram", LV_ALIGN_TOP_MID, 0, 8, "label.title", &lv_font_montserrat_30);
+
+  btn_back = makeButton(lvObj_, "Back", 100, 40, LV_ALIGN_BOTTOM_LEFT, 8, -12, "button.secondary");
+  lv_obj_add_event_cb(btn_back, &TrackDiagramScreen::event_back_trampoline, LV_EVENT_CLICKED, this);
+
+  if (!loadLayout(CONFIG_TRACK_DIAGRAM_PATH)) {
+    lbl_empty = makeLabel(lvObj_, "No track diagram.\nAdd " CONFIG_TRACK_DIAGRAM_PATH " to the spiffs partition.",
+                          LV_ALIGN_CENTER, 0, 0, "label.main");
+    lv_obj_set_style_text_align(lbl_empty, LV_TEXT_ALIGN_CENTER, LV_PART_MAIN);
+  } else {
+    renderStatic();
+    createPointObjects();
+    refreshStates();
+    if (!points.empty()) {
+      focusedIndex = 0;
+      rotaryShowFocus(focusedIndex);
+    }
+  }
+
+  subscribeAll();
+  rotaryAttach();
+}
+
+// Reattaches the cached screen; the static image is kept, only the turnout
+// states are re-read.
+void TrackDiagramScreen::resume() {
+  isCleanedUp = false;
+  subscribeAll();
+  refreshStates();
+  rotaryAttach();
+}
+
+// Subscribes to turnout changes and to new turnout lists.
+void TrackDiagramScreen::subscribeAll() {
+  unsubscribeAll();
+  turnout_changed_sub = lv_msg_subscribe(
+      MSG_DCC_TURNOUT_CHANGED,
+      [](lv_msg_t *msg) {
+        TrackDiagramScreen *self = static_cast<TrackDiagramScreen *>(lv_msg_get_user_data(msg));
+        if (!self || self->isCleanedUp)
+          return;
+        const auto *data = static_cast<const TurnoutActionData *>(lv_msg_get_payload(msg));
+        auto it = data ? self->pointIndexById.find(data->turnoutId) : self->pointIndexById.end();
+        if (it != self->pointIndexById.end()) {
+          self->setThrown(it->second, data->thrown);
+        }
+      },
+      this);
+  turnout_list_sub = lv_msg_subscribe(
+      MSG_DCC_TURNOUT_LIST_RECEIVED,
+      [](lv_msg_t *msg) {
+        TrackDiagramScreen *self = static_cast<TrackDiagramScreen *>(lv_msg_get_user_data(msg));
+        if (!self || self->isCleanedUp)
+          return;
+        self->refreshStates();
+      },
+      this);
+}
+
+// Removes diagram-related lv_msg subscriptions.
+void TrackDiagramScreen::unsubscribeAll() {
+  if (turnout_changed_sub) {
+    lv_msg_unsubscribe(turnout_changed_sub);
+    turnout_changed_sub = nullptr;
+  }
+  if (turnout_list_sub) {
+    lv_msg_unsubscribe(turnout_list_sub);
+    turnout_list_sub = nullptr;
+  }
+}
+
+// Reads `path`: "track x1 y1 x2 y2" and
+// "point id x y closedX closedY thrownX thrownY [label]" lines; blank lines and
+// lines starting with '#' are skipped. Returns false if the file cannot be
+// read or describes nothing.
+bool TrackDiagramScreen::loadLayout(const char *path) {
+  segments.clear();
+  points.clear();
+  pointIndexById.clear();
+
+  FILE *file = fopen(path, "r");
+  if (!file) {
+    ESP_LOGW(TAG, "Cannot open %s", path);
+    return false;
+  }
+
+  char line[128];
+  int lineNumber = 0;
+  while (fgets(line, sizeof(line), file)) {
+    ++lineNumber;
+    line[strcspn(line, "\r\n")] = '\0';
+    int x1, y1, x2, y2, x3, y3, id, consumed = 0;
+    if (line[0] == '\0' || line[0] == '#') {
+      continue;
+    }
+    if (sscanf(line, "track %d %d %d %d", &x1, &y1, &x2, &y2) == 4) {
+      segments.push_back(Segment{static_cast<int16_t>(x1), static_cast<int16_t>(y1), static_cast<int16_t>(x2),
+                                 static_cast<int16_t>(y2)});
+    } else if (sscanf(line, "point %d %d %d %d %d %d %d %n", &id, &x1, &y1, &x2, &y2, &x3, &y3, &consumed) == 7) {
+      if (pointIndexById.count(id)) {
+        ESP_LOGW(TAG, "%s:%d: turnout %d is already drawn, skipped", path, lineNumber, id);
+        continue;
+      }
+      pointIndexById.emplace(id, points.size());
+      points.push_back(Point{id, static_cast<int16_t>(x1), static_cast<int16_t>(y1), static_cast<int16_t>(x2),
+                             static_cast<int16_t>(y2), static_cast<int16_t>(x3), static_cast<int16_t>(y3),
+                             consumed > 0 ? std::string(line + consumed) : std::string()});
+    } else {
+      ESP_LOGW(TAG, "%s:%d: not understood: %s", path, lineNumber, line);
+    }
+  }
+  fclose(file);
+
+  ESP_LOGI(TAG, "Layout %s: %u track segments, %u points", path, static_cast<unsigned>(segments.size()),
+           static_cast<unsigned>(points.size()));
+  return !segments.empty() || !points.empty();
+}
+
+// Draws everything that never changes into the canvas: track, both legs of
+// each point and the point labels. Done once per build of the screen.
+void TrackDiagramScreen::renderStatic() {
+  if (!canvasBuffer) {
+    canvasBuffer = static_cast<uint8_t *>(heap_caps_malloc(
+        LV_CANVAS_BUF_SIZE(kWidth, kHeight, 16, LV_DRAW_BUF_STRIDE_ALIGN), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT));
+    if (!canvasBuffer) {
+      ESP_LOGE(TAG, "No memory for the track diagram image");
+      return;
+    }
+  }
+
+  canvas_track = lv_canvas_create(lvObj_);
+  lv_canvas_set_buffer(canvas_track, canvasBuffer, kWidth, kHeight, LV_COLOR_FORMAT_RGB565);
+  lv_obj_set_pos(canvas_track, 8, kTop);
+  lv_canvas_fill_bg(canvas_track, lv_color_white(), LV_OPA_COVER);
+
+  lv_layer_t layer;
+  lv_canvas_init_layer(canvas_track, &layer);
+
+  lv_draw_line_dsc_t line;
+  lv_draw_line_dsc_init(&line);
+  line.width = kTrackWidth;
+  line.round_start = 1;
+  line.round_end = 1;
+  line.color = trackColor();
+  for (const auto &segment : segments) {
+    drawLine(&layer, &line, segment.x1, segment.y1, segment.x2, segment.y2);
+  }
+  line.color = legColor();
+  for (const auto &point : points) {
+    drawLine(&layer, &line, point.x, point.y, point.closedX, point.closedY);
+    drawLine(&layer, &line, point.x, point.y, point.thrownX, point.thrownY);
+  }
+
+  lv_draw_label_dsc_t label;
+  lv_draw_label_dsc_init(&label);
+  label.font = &lv_font_montserrat_14;
+  label.color = lv_color_black();
+  for (const auto &point : points) {
+    if (point.label.empty()) {
+      continue;
+    }
+    label.text = point.label.c_str();
+    lv_area_t area = {point.x - 60, point.y - kPointRadius - 18, point.x + 60, point.y - kPointRadius};
+    label.align = LV_TEXT_ALIGN_CENTER;
+    lv_draw_label(&layer, &label, &area);
+  }
+
+  lv_canvas_finish_layer(canvas_track, &layer);
+}
+
+// Creates the transparent hit/redraw object over each point.
+void TrackDiagramScreen::createPointObjects() {
+  pointObjects.clear();
+  if (!canvas_track) {
+    return;
+  }
+  pointObjects.reserve(points.size());
+  for (size_t i = 0; i < points.size(); ++i) {
+    lv_obj_t *obj = lv_obj_create(canvas_track);
+    lv_obj_remove_style_all(obj);
+    lv_obj_set_size(obj, kPointRadius * 2, kPointRadius * 2);
+    lv_obj_set_pos(obj, points[i].x - kPointRadius, points[i].y - kPointRadius);
+    lv_obj_add_flag(obj, LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_remove_flag(obj, LV_OBJ_FLAG_SCROLLABLE);
+    setFocusStyle(obj);
+    setItemIndex(obj, i);
+    lv_obj_add_event_cb(obj, &TrackDiagramScreen::event_point_click_trampoline, LV_EVENT_CLICKED, this);
+    lv_obj_add_event_cb(obj, &TrackDiagramScreen::event_point_draw_trampoline, LV_EVENT_DRAW_MAIN, this);
+    pointObjects.push_back(obj);
+  }
+}
+
+// Reads every point's state from the server's turnout list.
+void TrackDiagramScreen::refreshStates() {
+  for (size_t i = 0; i < points.size(); ++i) {
+    auto *turnout = DCCExController::Turnout::getById(points[i].id);
+    if (!turnout) {
+      if (points[i].known) {
+        points[i].known = false; // no longer on the server: only the dim legs are shown
+        lv_obj_invalidate(pointObjects[i]);
+      }
+      continue;
+    }
+    if (!points[i].known || turnout->getThrown() != points[i].thrown) {
+      setThrown(i, turnout->getThrown());
+    }
+  }
+}
+
+// Records a point's state and invalidates only its own small area.
+void TrackDiagramScreen::setThrown(size_t index, bool thrown) {
+  points[index].thrown = thrown;
+  points[index].known = true;
+  if (index < pointObjects.size()) {
+    lv_obj_invalidate(pointObjects[index]);
+  }
+}
+
+// Sends the throw/close command for a point, showing the new state at once.
+void TrackDiagramScreen::throwPoint(size_t index) {
+  const Point &point = points[index];
+  const bool newThrown = !point.thrown;
+  if (!DCCExController::Turnout::getById(point.id)) {
+    ESP_LOGW(TAG, "No turnout found for ID %d", point.id);
+    return;
+  }
+  if (utilities::WifiControl::instance()->setTurnoutThrown(point.id, newThrown)) {
+    // Optimistic; the server's broadcast confirms or corrects it.
+    setThrown(index, newThrown);
+  } else {
+    ESP_LOGW(TAG, "Unable to send turnout command while disconnected");
+  }
+}
+
+// Draws the leg a point is set to, from its centre to the edge of its box,
+// over the dim legs in the static image.
+void TrackDiagramScreen::point_draw_callback(lv_event_t *e) {
+  lv_obj_t *obj = static_cast<lv_obj_t *>(lv_event_get_target(e));
+  const int index = getItemIndex(obj);
+  if (index < 0 || static_cast<size_t>(index) >= points.size() || !points[index].known) {
+    return;
+  }
+  const Point &point = points[index];
+  const int32_t dx = (point.thrown ? point.thrownX : point.closedX) - point.x;
+  const int32_t dy = (point.thrown ? point.thrownY : point.closedY) - point.y;
+  const float length = std::sqrt(static_cast<float>(dx * dx + dy * dy));
+  if (length < 1.0f) {
+    return;
+  }
+
+  lv_area_t coords;
+  lv_obj_get_coords(obj, &coords);
+  const int32_t cx = coords.x1 + kPointRadius;
+  const int32_t cy = coords.y1 + kPointRadius;
+  const float reach = std::min(length, static_cast<float>(kPointRadius - kTrackWidth));
+
+  lv_draw_line_dsc_t line;
+  lv_draw_line_dsc_init(&line);
+  line.width = kTrackWidth + 2;
+  line.round_start = 1;
+  line.round_end = 1;
+  line.color = point.thrown ? thrownColor() : closedColor();
+  drawLine(lv_event_get_layer(e), &line, cx, cy, cx + static_cast<int32_t>(dx * reach / length),
+           cy + static_cast<int32_t>(dy * reach / length));
+}
+
+// Detaches the screen when navigating away. The widgets and the static image
+// stay built in the ScreenCache until evicted().
+void TrackDiagramScreen::cleanUp() {
+  ESP_LOGI(TAG, "Cleaning up TrackDiagramScreen");
+  isCleanedUp = true;
+  unsubscribeAll();
+  rotaryDetach();
+}
+
+// The cache is deleting this screen's widgets: releases the pointers to them
+// and the image buffer the canvas draws from.
+void TrackDiagramScreen::evicted() {
+  segments.clear();
+  points.clear();
+  pointIndexById.clear();
+  pointObjects.clear();
+  lbl_title = nullptr;
+  canvas_track = nullptr;
+  lbl_empty = nullptr;
+  btn_back = nullptr;
+  focusedIndex = -1;
+  if (canvasBuffer) {
+    heap_caps_free(canvasBuffer);
+    canvasBuffer = nullptr;
+  }
+}
+
+// Returns to the previous screen (the turnout list).
+void TrackDiagramScreen::button_back_callback(lv_event_t *e) {
+  if (isCleanedUp)
+    return;
+  if (lv_event_get_code(e) == LV_EVENT_CLICKED) {
+    if (auto screen = parentScreen_.lock()) {
+      cleanUp();
+      screen->showScreen();
+    }
+  }
+}
+
+// A point was tapped: focuses and throws it.
+void TrackDiagramScreen::point_click_callback(lv_event_t *e) {
+  if (isCleanedUp)
+    return;
+  const int index = getItemIndex(static_cast<lv_obj_t *>(lv_event_get_target(e)));
+  if (index < 0 || static_cast<size_t>(index) >= points.size()) {
+    return;
+  }
+  focusedIndex = index;
+  rotaryShowFocus(focusedIndex);
+  throwPoint(static_cast<size_t>(index));
+}
+
+// Point object drawn as focused for `index`.
+lv_obj_t *TrackDiagramScreen::rotaryFocusObject(int index) const {
+  if (index < 0 || static_cast<size_t>(index) >= pointObjects.size()) {
+    return nullptr;
+  }
+  return pointObjects[index];
+}
+
+// Moves the rotary focus through the points in file order.
+void TrackDiagramScreen::rotaryMoveFocus(int direction) {
+  const int count = static_cast<int>(pointObjects.size());
+  if (isCleanedUp || count == 0 || direction == 0) {
+    return;
+  }
+  focusedIndex = rotaryStepIndex(focusedIndex, direction, count);
+  rotaryShowFocus(focusedIndex);
+}
+
+// Single click: throws the focused point.
+void TrackDiagramScreen::rotaryActivateFocused() {
+  if (isCleanedUp || focusedIndex < 0 || static_cast<size_t>(focusedIndex) >= pointObjects.size()) {
+    return;
+  }
+  throwPoint(static_cast<size_t>(focusedIndex));
+}
+
+} // namespace display
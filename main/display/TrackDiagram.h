@@ -0,0 +1,104 @@
+#pragma once
+#include "RotaryListScreenBase.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace display {
+class TrackDiagramScreen : public RotaryListScreenBase, public std::enable_shared_from_this<TrackDiagramScreen> {
+public:
+  static std::shared_ptr<TrackDiagramScreen> instance() {
+    static std::shared_ptr<TrackDiagramScreen> s;
+    if (!s)
+      s.reset(new TrackDiagramScreen());
+    return s;
+  }
+  TrackDiagramScreen(const TrackDiagramScreen &) = delete;
+  TrackDiagramScreen &operator=(const TrackDiagramScreen &) = delete;
+  ~TrackDiagramScreen() override = default;
+
+  void show(lv_obj_t *parent = nullptr, std::weak_ptr<Screen> parentScreen = std::weak_ptr<Screen>{}) override;
+  void cleanUp() override;
+
+  void unsubscribeAll();
+
+  void button_back_callback(lv_event_t *e);
+  void point_click_callback(lv_event_t *e);
+  void point_draw_callback(lv_event_t *e);
+
+  static constexpr int32_t kWidth = 304;
+  static constexpr int32_t kHeight = 368;
+
+private:
+  struct Segment {
+    int16_t x1, y1, x2, y2;
+  };
+
+  // A turnout drawn at (x, y) with legs towards the closed and thrown ends.
+  struct Point {
+    int id;
+    int16_t x, y;
+    int16_t closedX, closedY;
+    int16_t thrownX, thrownY;
+    std::string label;
+    bool thrown = false;
+    bool known = false; // the server has reported this turnout
+  };
+
+  bool loadLayout(const char *path);
+  void renderStatic();
+  void createPointObjects();
+  void refreshStates();
+  void setThrown(size_t index, bool thrown);
+  void throwPoint(size_t index);
+  void subscribeAll();
+
+  bool cacheable() const override { return true; }
+  void resume() override;
+  void evicted() override;
+
+  bool rotaryInputEnabled() const override { return !isCleanedUp; }
+  void rotaryMoveFocus(int direction) override;
+  void rotaryActivateFocused() override;
+  lv_obj_t *rotaryFocusObject(int index) const override;
+
+  std::vector<Segment> segments;
+  std::vector<Point> points;
+  std::unordered_map<int, size_t> pointIndexById; // turnout ID -> position in `points`
+  std::vector<lv_obj_t *> pointObjects;          // one hit/overlay object per point
+  uint8_t *canvasBuffer = nullptr;                // static track image, in PSRAM
+  int focusedIndex = -1;
+
+  lv_msg_sub_dsc_t *turnout_changed_sub = nullptr;
+  lv_msg_sub_dsc_t *turnout_list_sub = nullptr;
+
+  bool isCleanedUp = false;
+  lv_obj_t *lbl_title = nullptr;
+  lv_obj_t *canvas_track = nullptr;
+  lv_obj_t *lbl_empty = nullptr;
+  lv_obj_t *btn_back = nullptr;
+
+protected:
+  TrackDiagramScreen() = default;
+
+  static void event_back_trampoline(lv_event_t *e) {
+    auto *self = static_cast<TrackDiagramScreen *>(lv_event_get_user_data(e));
+    if (self)
+      self->button_back_callback(e);
+  }
+
+  static void event_point_click_trampoline(lv_event_t *e) {
+    auto *self = static_cast<TrackDiagramScreen *>(lv_event_get_user_data(e));
+    if (self)
+      self->point_click_callback(e);
+  }
+
+  static void event_point_draw_trampoline(lv_event_t *e) {
+    auto *self = static_cast<TrackDiagramScreen *>(lv_event_get_user_data(e));
+    if (self)
+      self->point_draw_callback(e);
+  }
+};
+} // namespace display
@@ -4,17 +4,25 @@
  *
  * Each entry shows the turnout name and thrown/closed state. Tapping or
  * pressing the rotary encoder toggles the turnout via WiThrottle. Supports
- * rotary-encoder navigation with focus outlines.
+ * rotary-encoder navigation with focus outlines. Rows are drawn by a
+ * VirtualList, so only the visible window of turnouts has widgets. A new
+ * turnout list from the server is reconciled by ID, so unchanged rows, the
+ * focused turnout and the scroll position are kept. A filter bar above the
+ * list narrows it to turnouts whose name contains the typed text. Diagram
+ * opens the TrackDiagramScreen with the same turnouts drawn on the layout.
  */
 #include "TurnoutList.h"
 #include "DCCMenu.h"
 #include "FirstScreen.h"
 #include "LvglWrapper.h"
 #include "Screen.h"
+#include "TrackDiagram.h"
 #include "WaitingScreen.h"
 #include "connection/wifi_control.h"
 #include "definitions.h"
+#include "images/CustomImages.h"
 #include "utilities/WifiHandler.h"
+#include <algorithm>
 #include <memory>
 #include <vector>
 
@@ -22,25 +30,50 @@ namespace display {
 
 static const char *TAG = "TURNOUT_LIST_SCREEN";
 
-// Builds the turnout list UI, registers rotary callbacks and subscribes to
-// turnout updated / thrown-state messages.
+// Builds the turnout list UI on the screen's cached LVGL screen, registers
+// rotary callbacks and subscribes to turnout messages.
 void TurnoutListScreen::show(lv_obj_t *parent, std::weak_ptr<Screen> parentScreen) {
   isCleanedUp = false;
 
-  listItems.clear();
+  turnouts.clear();
+  turnoutIndexById.clear();
+  focusedTurnoutId = -1;
   currentButton = nullptr;
 
   // Title
   lbl_title = makeLabel(lvObj_, "Turnouts", LV_ALIGN_TOP_MID, 0, 8, "label.title", &lv_font_montserrat_30);
 
-  // List for Auto Detect
-  list_turnouts = makeListView(lvObj_, 0, 40, 320, 380);
+  // Turnout rows, below the filter bar
+  list_turnouts = turnoutRows.create(lvObj_, 0, 88, 320, 332, &TurnoutListScreen::bind_row_trampoline, this);
   lv_obj_add_event_cb(list_turnouts, event_listitem_click_trampoline, LV_EVENT_CLICKED, this);
 
   // Bottom Buttons
   btn_back = makeButton(lvObj_, "Back", 100, 40, LV_ALIGN_BOTTOM_LEFT, 8, -12, "button.secondary");
   lv_obj_add_event_cb(btn_back, &TurnoutListScreen::event_back_trampoline, LV_EVENT_CLICKED, this);
+  btn_diagram = makeButton(lvObj_, "Diagram", 100, 40, LV_ALIGN_BOTTOM_RIGHT, -8, -12, "button.primary");
+  lv_obj_add_event_cb(btn_diagram, &TurnoutListScreen::event_diagram_trampoline, LV_EVENT_CLICKED, this);
 
+  // Filter bar; created last so its keyboard draws over the list
+  ta_filter = turnoutFilter.create(lvObj_, 8, 44, 304, &TurnoutListScreen::filter_changed_trampoline, this);
+
+  subscribeAll();
+  refreshList();
+  rotaryAttach();
+}
+
+// Reattaches the cached screen: subscriptions and rotary input come back and
+// the kept rows are reconciled with whatever changed while it was hidden. An
+// unchanged list costs one walk of the turnouts; nothing is rebuilt.
+void TurnoutListScreen::resume() {
+  isCleanedUp = false;
+  subscribeAll();
+  refreshList();
+  rotaryAttach();
+}
+
+// Subscribes to turnout list / thrown-state messages.
+void TurnoutListScreen::subscribeAll() {
+  unsubscribeAll();
   turnout_changed_sub = lv_msg_subscribe(
       MSG_DCC_TURNOUT_CHANGED,
       [](lv_msg_t *msg) {
@@ -50,20 +83,27 @@ void TurnoutListScreen::show(lv_obj_t *parent, std::weak_ptr<Screen> parentScree
         ESP_LOGI(TAG, "Turnout changed message received");
         TurnoutActionData *data = static_cast<TurnoutActionData *>(const_cast<void *>(lv_msg_get_payload(msg)));
         ESP_LOGI(TAG, "Turnout ID=%d changed to Thrown=%s", data->turnoutId, data->thrown ? "thrown" : "closed");
-        auto item = self->getItemByTurnoutId(data->turnoutId);
-        if (item) {
-          self->throwTurnout(item, data->thrown);
+        const int index = self->indexOfTurnout(data->turnoutId);
+        if (index >= 0) {
+          self->throwTurnout(static_cast<size_t>(index), data->thrown);
         } else {
           ESP_LOGW(TAG, "No item found for turnout ID %d", data->turnoutId);
         }
       },
       this);
 
-  refreshList();
-  rotaryAttach();
+  turnout_list_sub = lv_msg_subscribe(
+      MSG_DCC_TURNOUT_LIST_RECEIVED,
+      [](lv_msg_t *msg) {
+        TurnoutListScreen *self = static_cast<TurnoutListScreen *>(lv_msg_get_user_data(msg));
+        if (!self || self->isCleanedUp)
+          return;
+        self->refreshList();
+      },
+      this);
 }
 
-// Clears and repopulates the list widget from the latest turnout data.
+// Reconciles the list widget with the latest turnout data.
 void TurnoutListScreen::refreshList() {
   ESP_LOGI(TAG, "Refreshing turnout list");
   auto wifiControl = utilities::WifiControl::instance();
@@ -79,43 +119,125 @@ void TurnoutListScreen::refreshList() {
     return;
   }
 
-  listItems.clear();
-  lv_obj_clean(list_turnouts);
+  populateList();
+}
 
+// Reads the DCCEXProtocol turnout list and reconciles `turnouts` with it by
+// turnout ID; only added, removed, moved or changed rows are rebound. While a
+// filter is applied the rows are a filtered view, so the list is re-filtered
+// instead. The ID map and filter index only depend on the IDs and names, so
+// they are rebuilt only when those changed, not for thrown state.
+void TurnoutListScreen::populateList() {
+  std::vector<TurnoutEntry> latest;
+  latest.reserve(turnouts.size());
   for (auto turnout = DCCExController::Turnout::getFirst(); turnout; turnout = turnout->getNext()) {
-    ESP_LOGI(TAG, "Turnout ID=%d, Name=%s, Thrown=%s", turnout->getId(), turnout->getName(),
+    ESP_LOGD(TAG, "Turnout ID=%d, Name=%s, Thrown=%s", turnout->getId(), turnout->getName(),
              turnout->getThrown() ? "thrown" : "closed");
+    const char *name = turnout->getName();
+    latest.push_back(TurnoutEntry{turnout->getId(), name ? name : "", turnout->getThrown()});
+  }
+  if (latest == turnouts) {
+    return;
+  }
+  const bool namesChanged =
+      !std::equal(latest.begin(), latest.end(), turnouts.begin(), turnouts.end(),
+                  [](const TurnoutEntry &a, const TurnoutEntry &b) { return a.id == b.id && a.name == b.name; });
+
+  const bool filtered = turnoutFilter.active();
+  if (filtered) {
+    turnouts = std::move(latest);
+  } else {
+    turnoutRows.reconcile(turnouts, std::move(latest), [](const TurnoutEntry &entry) { return entry.id; });
+  }
+  if (namesChanged) {
+    turnoutIndexById.clear();
+    turnoutIndexById.reserve(turnouts.size());
+    for (size_t i = 0; i < turnouts.size(); ++i) {
+      turnoutIndexById.emplace(turnouts[i].id, i);
+    }
+    turnoutFilter.build(turnouts, [](const TurnoutEntry &entry) { return entry.name; });
+  }
 
-    auto listItem = std::make_shared<TurnoutListItem>(list_turnouts, listItems.size(), turnout->getId(),
-                                                      turnout->getName(), turnout->getThrown());
-    listItems.push_back(listItem);
+  if (filtered) {
+    showFilteredRows();
+    return;
   }
+  focusedIndex = turnoutRows.focusedIndex();
+  if (focusedIndex < 0 && !turnouts.empty()) {
+    focusedIndex = 0;
+    updateFocusedState();
+  } else {
+    rememberFocusedTurnout();
+  }
+}
 
-  focusedIndex = listItems.empty() ? -1 : 0;
+// Resizes the list to the filter's matches and keeps the focus on the same
+// turnout if it still matches, else on the first row.
+void TurnoutListScreen::showFilteredRows() {
+  turnoutRows.setCount(turnoutFilter.rowCount());
+  const int entry = indexOfTurnout(focusedTurnoutId);
+  focusedIndex = entry >= 0 ? turnoutFilter.rowForEntry(static_cast<size_t>(entry)) : -1;
+  if (focusedIndex < 0 && turnoutRows.count() > 0) {
+    focusedIndex = 0;
+  }
   updateFocusedState();
 }
 
+// Records which turnout the focused row shows.
+void TurnoutListScreen::rememberFocusedTurnout() {
+  if (focusedIndex < 0 || static_cast<size_t>(focusedIndex) >= turnoutRows.count()) {
+    focusedTurnoutId = -1;
+    return;
+  }
+  focusedTurnoutId = turnouts[turnoutFilter.entryForRow(static_cast<size_t>(focusedIndex))].id;
+}
+
+// VirtualList bind callback: shows the thrown/closed icon and name for a row.
+void TurnoutListScreen::bindRow(lv_obj_t *row, size_t index) {
+  const size_t entry = turnoutFilter.entryForRow(index);
+  if (entry >= turnouts.size()) {
+    return;
+  }
+  const auto &turnout = turnouts[entry];
+  VirtualList::setRowContent(row, turnout.thrown ? &turnoutclosed : &turnoutopen, turnout.name.c_str());
+}
+
 // Removes turnout-related lv_msg subscriptions.
 void TurnoutListScreen::unsubscribeAll() {
   if (turnout_changed_sub) {
     lv_msg_unsubscribe(turnout_changed_sub);
     turnout_changed_sub = nullptr;
   }
+  if (turnout_list_sub) {
+    lv_msg_unsubscribe(turnout_list_sub);
+    turnout_list_sub = nullptr;
+  }
 }
 
-// Releases widget pointers, unregisters rotary callbacks and clears item list.
+// Detaches the screen when navigating away. The widgets stay built in the
+// ScreenCache until evicted().
 void TurnoutListScreen::cleanUp() {
   ESP_LOGI(TAG, "Cleaning up TurnoutListScreen");
   isCleanedUp = true;
   unsubscribeAll();
-  listItems.clear();
+  rotaryDetach();
+}
+
+// The cache is deleting this screen's widgets: releases the pointers to them
+// and clears the item list.
+void TurnoutListScreen::evicted() {
+  turnouts.clear();
+  turnoutIndexById.clear();
+  turnoutRows.reset();
+  turnoutFilter.reset();
   lbl_title = nullptr;
+  ta_filter = nullptr;
   list_turnouts = nullptr;
   btn_back = nullptr;
+  btn_diagram = nullptr;
   currentButton = nullptr;
   focusedIndex = -1;
-  rotaryDetach();
-  lv_obj_clean(lvObj_);
+  focusedTurnoutId = -1;
 }
 
 // Returns to the previous screen.
@@ -130,6 +252,16 @@ void TurnoutListScreen::button_back_callback(lv_event_t *e) {
   }
 }
 
+// Opens the track diagram; its Back returns here.
+void TurnoutListScreen::button_diagram_callback(lv_event_t *e) {
+  if (isCleanedUp)
+    return;
+  if (lv_event_get_code(e) == LV_EVENT_CLICKED) {
+    cleanUp();
+    TrackDiagramScreen::instance()->showScreen(shared_from_this());
+  }
+}
+
 // Handles touch taps on list items: toggles the turnout thrown state.
 void TurnoutListScreen::button_listitem_click_event_callback(lv_event_t *e) {
   if (isCleanedUp)
@@ -148,78 +280,58 @@ void TurnoutListScreen::button_listitem_click_event_callback(lv_event_t *e) {
       return;
     }
 
-    // void * event_data = lv_event_get_user_data(e);
-    ESP_LOGI(TAG, "Toggling: %s", lv_list_get_btn_text(list_turnouts, target));
-
-    auto item = getItem(target);
-    if (item) {
-      focusedIndex = static_cast<int>(item->index);
+    const int index = turnoutRows.indexForRow(target);
+    if (index >= 0) {
+      const size_t entry = turnoutFilter.entryForRow(static_cast<size_t>(index));
+      ESP_LOGI(TAG, "Toggling: %s", turnouts[entry].name.c_str());
+      focusedIndex = index;
       updateFocusedState();
-      throwTurnout(item, !item->isThrown());
+      throwTurnout(entry, !turnouts[entry].thrown);
     } else {
       ESP_LOGW(TAG, "No item found for clicked button");
     }
   }
 }
 
-// Refreshes focus outlines across all list items.
+// Moves the focus highlight to the focused turnout, scrolling it into view.
 void TurnoutListScreen::updateFocusedState() {
-  for (size_t i = 0; i < listItems.size(); ++i) {
-    auto obj = listItems[i]->getLvObj();
-    if (!obj) {
-      continue;
-    }
-    if (static_cast<int>(i) == focusedIndex) {
-      lv_obj_add_state(obj, LV_STATE_FOCUSED);
-      applyFocusOutline(obj, true);
-      lv_obj_scroll_to_view(obj, LV_ANIM_OFF);
-    } else {
-      lv_obj_clear_state(obj, LV_STATE_FOCUSED);
-      applyFocusOutline(obj, false);
-    }
-  }
+  turnoutRows.setFocusedIndex(focusedIndex);
+  rememberFocusedTurnout();
 }
 
-// Moves the rotary focus by `direction` steps (+1 down, -1 up).
+// Row currently showing the turnout at `index`, if it is materialised.
+lv_obj_t *TurnoutListScreen::rotaryFocusObject(int index) const { return turnoutRows.rowForIndex(index); }
+
+// Moves the rotary focus by `direction` rows (positive down, negative up).
 void TurnoutListScreen::moveFocus(int direction) {
-  if (isCleanedUp || listItems.empty() || direction == 0) {
+  const int count = static_cast<int>(turnoutRows.count());
+  if (isCleanedUp || count == 0 || direction == 0) {
     return;
   }
 
-  int index = focusedIndex;
-  if (index < 0 || index >= static_cast<int>(listItems.size())) {
-    index = 0;
-  }
-
-  index = (index + direction) % static_cast<int>(listItems.size());
-  if (index < 0) {
-    index += static_cast<int>(listItems.size());
-  }
-
-  focusedIndex = index;
+  focusedIndex = rotaryStepIndex(focusedIndex, direction, count);
   updateFocusedState();
 }
 
 // Sends a throw/close command for the focused turnout.
 void TurnoutListScreen::activateFocused() {
-  if (isCleanedUp || focusedIndex < 0 || focusedIndex >= static_cast<int>(listItems.size())) {
+  if (isCleanedUp || focusedIndex < 0 || focusedIndex >= static_cast<int>(turnoutRows.count())) {
     return;
   }
 
-  auto item = listItems[focusedIndex];
-  if (item) {
-    throwTurnout(item, !item->isThrown());
-  }
+  const size_t entry = turnoutFilter.entryForRow(static_cast<size_t>(focusedIndex));
+  throwTurnout(entry, !turnouts[entry].thrown);
 }
 
-// Sends the throw/close command for `item` with the specified new state.
-void TurnoutListScreen::throwTurnout(std::shared_ptr<TurnoutListItem> item, bool newThrownState) {
-  ESP_LOGI(TAG, "Found item for turnout ID %d new thrown %s", item->getTurnoutId(),
-           newThrownState ? "thrown" : "closed");
+// Sends the throw/close command for the turnout at position `index` in
+// `turnouts` with the specified new state.
+void TurnoutListScreen::throwTurnout(size_t index, bool newThrownState) {
+  const int turnoutId = turnouts[index].id;
+  ESP_LOGI(TAG, "Found item for turnout ID %d new thrown %s", turnoutId, newThrownState ? "thrown" : "closed");
   auto wifiControl = utilities::WifiControl::instance();
-  auto turnout = DCCExController::Turnout::getById(item->getTurnoutId());
+  auto turnout = DCCExController::Turnout::getById(turnoutId);
   if (!turnout) {
-    ESP_LOGW(TAG, "No turnout found for ID %d", item->index);
+    ESP_LOGW(TAG, "No turnout found for ID %d", turnoutId);
     return;
   }
 
@@ -228,37 +340,34 @@ void TurnoutListScreen::throwTurnout(std::shared_ptr<TurnoutListItem> item, bool
   if (newThrownState == turnout->getThrown()) {
     ESP_LOGI(TAG, "Turnout ID %d is already in the desired state %s, update display", turnout->getId(),
              newThrownState ? "thrown" : "closed");
-    item->updateThrown(newThrownState);
+    setThrown(index, newThrownState);
     return;
   }
 
   ESP_LOGI(TAG, "Setting turnout ID %d to %s", turnout->getId(), newThrownState ? "thrown" : "closed");
   if (wifiControl->setTurnoutThrown(turnout->getId(), newThrownState)) {
     // Optimistically update display; server updates still reconcile via delegate messages.
-    item->updateThrown(newThrownState);
+    setThrown(index, newThrownState);
   } else {
     ESP_LOGW(TAG, "Unable to send turnout command while disconnected");
   }
 }
 
-// Returns the TurnoutListItem whose LVGL button matches bn, or nullptr.
-std::shared_ptr<TurnoutListItem> TurnoutListScreen::getItem(lv_obj_t *bn) {
-  for (const auto &item : listItems) {
-    if (item->getLvObj() == bn) {
-      return item;
-    }
+// Updates the cached thrown state of the turnout at `index` and redraws its
+// row if it passes the filter and is visible.
+void TurnoutListScreen::setThrown(size_t index, bool thrown) {
+  turnouts[index].thrown = thrown;
+  const int row = turnoutFilter.rowForEntry(index);
+  if (row >= 0) {
+    turnoutRows.refreshIndex(static_cast<size_t>(row));
   }
-  return nullptr;
 }
 
-// Returns the TurnoutListItem matching the given DCC turnout ID, or nullptr.
-std::shared_ptr<TurnoutListItem> TurnoutListScreen::getItemByTurnoutId(int turnoutId) {
-  for (const auto &item : listItems) {
-    if (item->getTurnoutId() == turnoutId) {
-      return item;
-    }
-  }
-  return nullptr;
+// Returns the position of the turnout with the given DCC ID in `turnouts`, or
+// -1.
+int TurnoutListScreen::indexOfTurnout(int turnoutId) const {
+  auto it = turnoutIndexById.find(turnoutId);
+  return it != turnoutIndexById.end() ? static_cast<int>(it->second) : -1;
 }
 
-} // namespace display
\ No newline at end of file
+} // namespace display
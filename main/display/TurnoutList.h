@@ -1,8 +1,11 @@
 #pragma once
+#include "ListFilter.h"
 #include "RotaryListScreenBase.h"
+#include "VirtualList.h"
 #include <memory>
-
-#include "TurnoutListItem.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace display {
 class TurnoutListScreen : public RotaryListScreenBase, public std::enable_shared_from_this<TurnoutListScreen> {
@@ -22,30 +25,59 @@ public:
 
   void refreshList();
   void unsubscribeAll();
-  std::shared_ptr<TurnoutListItem> getItem(lv_obj_t *bn);
 
   void button_back_callback(lv_event_t *e);
+  void button_diagram_callback(lv_event_t *e);
   void button_listitem_click_event_callback(lv_event_t *e);
 
 private:
-  std::vector<std::shared_ptr<TurnoutListItem>> listItems;
-  int focusedIndex = -1;
+  friend class UiBenchmark;
+
+  struct TurnoutEntry {
+    int id;
+    std::string name;
+    bool thrown;
+
+    bool operator==(const TurnoutEntry &) const = default;
+  };
+
+  std::vector<TurnoutEntry> turnouts;
+  std::unordered_map<int, size_t> turnoutIndexById; // DCC ID -> position in `turnouts`
+  VirtualList turnoutRows;
+  ListFilter turnoutFilter;
+  int focusedIndex = -1;     // focused list row
+  int focusedTurnoutId = -1; // DCC ID shown in that row, kept across filter changes
+
+  bool cacheable() const override { return true; }
+  void resume() override;
+  void evicted() override;
+  void subscribeAll();
 
   bool rotaryInputEnabled() const override { return !isCleanedUp; }
+  bool rotaryAccelerated() const override { return true; }
   void rotaryMoveFocus(int direction) override { moveFocus(direction); }
   void rotaryActivateFocused() override { activateFocused(); }
-  void throwTurnout(std::shared_ptr<TurnoutListItem> item, bool newThrownState);
-  std::shared_ptr<TurnoutListItem> getItemByTurnoutId(int turnoutId);
+  lv_obj_t *rotaryFocusObject(int index) const override;
+  void populateList();
+  void showFilteredRows();
+  void rememberFocusedTurnout();
+  void bindRow(lv_obj_t *row, size_t index);
+  void throwTurnout(size_t index, bool newThrownState);
+  void setThrown(size_t index, bool thrown);
+  int indexOfTurnout(int turnoutId) const;
   void updateFocusedState();
   void moveFocus(int direction);
   void activateFocused();
 
   lv_msg_sub_dsc_t *turnout_changed_sub = nullptr;
+  lv_msg_sub_dsc_t *turnout_list_sub = nullptr;
 
   bool isCleanedUp = false;
   lv_obj_t *lbl_title = nullptr;
+  lv_obj_t *ta_filter = nullptr;
   lv_obj_t *list_turnouts = nullptr;
   lv_obj_t *btn_back = nullptr;
+  lv_obj_t *btn_diagram = nullptr;
   lv_obj_t *currentButton = nullptr;
 
 protected:
@@ -57,10 +89,28 @@ protected:
       self->button_back_callback(e);
   }
 
+  static void event_diagram_trampoline(lv_event_t *e) {
+    auto *self = static_cast<TurnoutListScreen *>(lv_event_get_user_data(e));
+    if (self)
+      self->button_diagram_callback(e);
+  }
+
   static void event_listitem_click_trampoline(lv_event_t *e) {
     auto *self = static_cast<TurnoutListScreen *>(lv_event_get_user_data(e));
     if (self)
       self->button_listitem_click_event_callback(e);
   }
+
+  static void bind_row_trampoline(lv_obj_t *row, size_t index, void *userData) {
+    auto *self = static_cast<TurnoutListScreen *>(userData);
+    if (self)
+      self->bindRow(row, index);
+  }
+
+  static void filter_changed_trampoline(void *userData) {
+    auto *self = static_cast<TurnoutListScreen *>(userData);
+    if (self && !self->isCleanedUp)
+      self->showFilteredRows();
+  }
 };
 } // namespace display
@@ -4,7 +4,9 @@
  *
  * Each turntable entry expands to show its named index positions. Tapping or
  * confirming with the rotary encoder sends a move-to-index command. Supports
- * rotary-encoder focus navigation.
+ * rotary-encoder focus navigation. Rows are held as parallel arrays with a
+ * kind tag, and each turntable records the range of its index rows, so
+ * lookups, focus moves and the flash tick need no casts or full scans.
  */
 #include "TurntableList.h"
 #include "DCCMenu.h"
@@ -14,7 +16,9 @@
 #include "WaitingScreen.h"
 #include "connection/wifi_control.h"
 #include "definitions.h"
+#include "images/CustomImages.h"
 #include "utilities/WifiHandler.h"
+#include <algorithm>
 #include <cstdio>
 #include <memory>
 #include <vector>
@@ -23,13 +27,12 @@ namespace display {
 
 static const char *TAG = "Turntable_LIST_SCREEN";
 
-// Builds the turntable list UI, registers rotary callbacks and subscribes to
-// turntable updated / move messages.
+// Builds the turntable list UI on the screen's cached LVGL screen, registers
+// rotary callbacks and subscribes to turntable updated / move messages.
 void TurntableListScreen::show(lv_obj_t *parent, std::weak_ptr<Screen> parentScreen) {
   isCleanedUp = false;
 
-  listItems.clear();
-  currentButton = nullptr;
+  clearRows();
 
   // Title
   lbl_title = makeLabel(lvObj_, "Turntables", LV_ALIGN_TOP_MID, 0, 8, "label.title", &lv_font_montserrat_30);
@@ -42,6 +45,26 @@ void TurntableListScreen::show(lv_obj_t *parent, std::weak_ptr<Screen> parentScr
   btn_back = makeButton(lvObj_, "Back", 100, 40, LV_ALIGN_BOTTOM_LEFT, 8, -12, "button.secondary");
   lv_obj_add_event_cb(btn_back, &TurntableListScreen::event_back_trampoline, LV_EVENT_CLICKED, this);
 
+  subscribeAll();
+  refreshList();
+  rotaryAttach();
+}
+
+// Reattaches the cached screen. The rows are only rebuilt if the turntables
+// changed while it was hidden (e.g. after reconnecting to another server).
+void TurntableListScreen::resume() {
+  isCleanedUp = false;
+  subscribeAll();
+  auto dccProtocol = utilities::WifiControl::instance()->dccProtocol();
+  if (dccProtocol && dccProtocol->receivedTurntableList() && !rowsMatchTurntables()) {
+    populateList();
+  }
+  rotaryAttach();
+}
+
+// Subscribes to turntable updated / move messages.
+void TurntableListScreen::subscribeAll() {
+  unsubscribeAll();
   turntable_changed_sub = lv_msg_subscribe(
       MSG_DCC_TURNTABLE_CHANGED,
       [](lv_msg_t *msg) {
@@ -52,8 +75,7 @@ void TurntableListScreen::show(lv_obj_t *parent, std::weak_ptr<Screen> parentScr
         TurntableActionData *data = static_cast<TurntableActionData *>(const_cast<void *>(lv_msg_get_payload(msg)));
         ESP_LOGI(TAG, "Turntable ID=%d position=%d moving=%s", data->turntableId, data->position,
                  data->moving ? "moving" : "stopped");
-        auto item = self->getIndexItemByTurntableAndIndex(data->turntableId, data->position);
-        if (item) {
+        if (self->rowOfIndex(data->turntableId, data->position) >= 0) {
           if (data->moving) {
             self->startTurntableFlashing(data->turntableId, data->position);
           } else {
@@ -65,9 +87,6 @@ void TurntableListScreen::show(lv_obj_t *parent, std::weak_ptr<Screen> parentScr
         }
       },
       this);
-
-  refreshList();
-  rotaryAttach();
 }
 
 // Clears and repopulates the list widget from the latest turntable data.
@@ -86,32 +105,117 @@ void TurntableListScreen::refreshList() {
     return;
   }
 
-  listItems.clear();
+  populateList();
+}
+
+// Rebuilds the list widget from the DCCEXProtocol turntable list, one row per
+// turntable followed by a row per index, and focuses the first index.
+void TurntableListScreen::populateList() {
+  clearRows();
   lv_obj_clean(list_Turntables);
 
   for (auto Turntable = DCCExController::Turntable::getFirst(); Turntable; Turntable = Turntable->getNext()) {
-    ESP_LOGI(TAG, "Turntable ID=%d, Name=%s", Turntable->getId(), Turntable->getName());
+    ESP_LOGD(TAG, "Turntable ID=%d, Name=%s", Turntable->getId(), Turntable->getName());
 
-    auto listItem = std::make_shared<TurntableListItem>(list_Turntables, listItems.size(), Turntable->getId(),
-                                                        Turntable->getName());
-    listItems.push_back(listItem);
+    addRow(RowKind::Turntable, Turntable->getId(), -1, Turntable->getName());
+    TurntableRange range{Turntable->getId(), rowObj.size(), rowObj.size()};
     for (auto index = Turntable->getFirstIndex(); index; index = index->getNextIndex()) {
-      ESP_LOGI(TAG, "  Index ID=%d Name=%s", index->getId(), index->getName());
+      ESP_LOGD(TAG, "  Index ID=%d Name=%s", index->getId(), index->getName());
 
-      auto indexListItem = std::make_shared<TurntableIndexListItem>(
-          list_Turntables, listItems.size(), Turntable->getId(), index->getId(), index->getName());
-      listItems.push_back(indexListItem);
+      indexRows.push_back(rowObj.size());
+      addRow(RowKind::Index, Turntable->getId(), index->getId(), index->getName());
     }
+    range.endRow = rowObj.size();
+    turntableById.emplace(range.turntableId, turntables.size());
+    turntables.push_back(range);
+  }
+  if (flashingTurntableId >= 0) {
+    flashingRow = rowOfIndex(flashingTurntableId, flashingIndexId);
   }
 
+  focusedSlot = 0;
+  focusedIndex = indexRows.empty() ? -1 : static_cast<int>(indexRows.front());
+  updateFocusedState();
+}
+
+// True if the rows still list exactly the turntables and indexes known to
+// DCCEXProtocol, in the same order.
+bool TurntableListScreen::rowsMatchTurntables() const {
+  size_t row = 0;
+  for (auto Turntable = DCCExController::Turntable::getFirst(); Turntable; Turntable = Turntable->getNext()) {
+    if (row >= rowObj.size() || rowKind[row] != RowKind::Turntable || rowTurntableId[row] != Turntable->getId()) {
+      return false;
+    }
+    ++row;
+    for (auto index = Turntable->getFirstIndex(); index; index = index->getNextIndex(), ++row) {
+      if (row >= rowObj.size() || rowTurntableId[row] != Turntable->getId() || rowIndexId[row] != index->getId()) {
+        return false;
+      }
+    }
+  }
+  return row == rowObj.size();
+}
+
+// Empties the row model; the widgets are deleted with the list.
+void TurntableListScreen::clearRows() {
+  rowKind.clear();
+  rowTurntableId.clear();
+  rowIndexId.clear();
+  rowObj.clear();
+  turntables.clear();
+  turntableById.clear();
+  indexRows.clear();
+  focusedSlot = 0;
   focusedIndex = -1;
-  for (size_t i = 0; i < listItems.size(); ++i) {
-    if (std::dynamic_pointer_cast<TurntableIndexListItem>(listItems[i])) {
-      focusedIndex = static_cast<int>(i);
-      break;
+  flashingRow = -1;
+}
+
+// Appends a list button for a turntable header or one of its indexes. Index
+// rows are indented and checkable; the row's position is kept in its user data.
+void TurntableListScreen::addRow(RowKind kind, int turntableId, int indexId, const char *name) {
+  lv_obj_t *row = lv_list_add_btn_mode(list_Turntables, &turnoutopen, name ? name : "", LV_LABEL_LONG_MODE_DOTS);
+  lv_obj_add_flag(row, LV_OBJ_FLAG_EVENT_BUBBLE);
+  setItemIndex(row, rowObj.size());
+  lv_obj_set_flex_align(row, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_START);
+  lv_obj_set_height(row, 48);
+  lv_obj_set_style_margin_bottom(row, 2, LV_PART_MAIN);
+  if (kind == RowKind::Turntable) {
+    setStylePart(row, "list.item.bold", LV_PART_MAIN);
+  } else {
+    setStylePart(row, "list.item", LV_PART_MAIN);
+    setStylePart(row, "list.item.selected", LV_STATE_CHECKED);
+    lv_obj_set_style_pad_left(row, 50, LV_PART_MAIN);
+  }
+
+  rowKind.push_back(kind);
+  rowTurntableId.push_back(turntableId);
+  rowIndexId.push_back(indexId);
+  rowObj.push_back(row);
+}
+
+// Row of the given turntable index, or -1. Only that turntable's index range
+// is searched.
+int TurntableListScreen::rowOfIndex(int turntableId, int indexId) const {
+  auto it = turntableById.find(turntableId);
+  if (it == turntableById.end()) {
+    return -1;
+  }
+  const TurntableRange &range = turntables[it->second];
+  for (size_t row = range.firstIndexRow; row < range.endRow; ++row) {
+    if (rowIndexId[row] == indexId) {
+      return static_cast<int>(row);
     }
   }
-  updateFocusedState();
+  return -1;
+}
+
+// Row whose button is `obj`, or -1.
+int TurntableListScreen::rowOfObject(const lv_obj_t *obj) const {
+  const int row = getItemIndex(obj);
+  if (row < 0 || static_cast<size_t>(row) >= rowObj.size() || rowObj[row] != obj) {
+    return -1;
+  }
+  return row;
 }
 
 // Removes turntable-related lv_msg subscriptions.
@@ -122,20 +226,23 @@ void TurntableListScreen::unsubscribeAll() {
   }
 }
 
-// Releases widget pointers, unregisters rotary callbacks and clears item lists.
+// Detaches the screen when navigating away and stops any flashing. The
+// widgets stay built in the ScreenCache until evicted().
 void TurntableListScreen::cleanUp() {
   ESP_LOGI(TAG, "Cleaning up TurntableListScreen");
   isCleanedUp = true;
   stopTurntableFlashing(false);
   unsubscribeAll();
-  listItems.clear();
+  rotaryDetach();
+}
+
+// The cache is deleting this screen's widgets: releases the pointers to them
+// and clears the row model.
+void TurntableListScreen::evicted() {
+  clearRows();
   lbl_title = nullptr;
   list_Turntables = nullptr;
   btn_back = nullptr;
-  currentButton = nullptr;
-  focusedIndex = -1;
-  rotaryDetach();
-  lv_obj_clean(lvObj_);
 }
 
 // Returns to the previous screen.
@@ -168,186 +275,117 @@ void TurntableListScreen::button_listitem_click_event_callback(lv_event_t *e) {
       return;
     }
 
-    // void * event_data = lv_event_get_user_data(e);
     ESP_LOGI(TAG, "Moving To: %s", lv_list_get_btn_text(list_Turntables, target));
 
-    activateItem(target);
+    activateRow(rowOfObject(target));
   }
 }
 
-// Sends a move-to-index command for the given item to the DCC server.
-void TurntableListScreen::activateItem(lv_obj_t *target) {
-  auto item = getItem(target);
-  auto index = std::dynamic_pointer_cast<TurntableIndexListItem>(item);
-  if (index) {
-    focusedIndex = static_cast<int>(item->index);
-    updateFocusedState();
+// Activates an index row: moves the turntable there, or reverses it if that
+// index is already selected. Turntable header rows are ignored.
+void TurntableListScreen::activateRow(int row) {
+  if (row < 0 || rowKind[row] != RowKind::Index) {
+    ESP_LOGW(TAG, "No item found for clicked button");
+    return;
+  }
 
-    if (isTurntableMoving(index->getTurntableId())) {
-      ESP_LOGW(TAG, "Ignoring index click while turntable ID %d is moving", index->getTurntableId());
-      return;
-    }
+  const auto slot = std::lower_bound(indexRows.begin(), indexRows.end(), static_cast<size_t>(row));
+  focusedSlot = static_cast<size_t>(slot - indexRows.begin());
+  focusedIndex = row;
+  updateFocusedState();
 
-    const bool isSelectedIndex = lv_obj_has_state(index->getLvObj(), LV_STATE_CHECKED) ||
-                                 (index->getTurntableId() == flashingTurntableId && index->getId() == flashingIndexId);
-    if (isSelectedIndex) {
-      auto wifiControl = utilities::WifiControl::instance();
-      if (!wifiControl->sendTurntableReverseCommand(index->getTurntableId())) {
-        ESP_LOGW(TAG, "Cannot send turntable reverse command while disconnected");
-      }
-      return;
-    }
+  const int turntableId = rowTurntableId[row];
+  const int indexId = rowIndexId[row];
+  if (isTurntableMoving(turntableId)) {
+    ESP_LOGW(TAG, "Ignoring index click while turntable ID %d is moving", turntableId);
+    return;
+  }
 
-    moveToIndex(index);
-  } else {
-    ESP_LOGW(TAG, "No item found for clicked button");
+  const bool isSelectedIndex = lv_obj_has_state(rowObj[row], LV_STATE_CHECKED) ||
+                               (turntableId == flashingTurntableId && indexId == flashingIndexId);
+  if (isSelectedIndex) {
+    auto wifiControl = utilities::WifiControl::instance();
+    if (!wifiControl->sendTurntableReverseCommand(turntableId)) {
+      ESP_LOGW(TAG, "Cannot send turntable reverse command while disconnected");
+    }
+    return;
   }
+
+  moveToIndex(turntableId, indexId);
 }
 
-// Refreshes focus outlines across all list items.
-void TurntableListScreen::updateFocusedState() {
-  for (size_t i = 0; i < listItems.size(); ++i) {
-    auto obj = listItems[i]->getLvObj();
-    if (!obj) {
-      continue;
-    }
-    if (static_cast<int>(i) == focusedIndex) {
-      lv_obj_add_state(obj, LV_STATE_FOCUSED);
-      applyFocusOutline(obj, true);
-      lv_obj_scroll_to_view(obj, LV_ANIM_OFF);
-    } else {
-      lv_obj_clear_state(obj, LV_STATE_FOCUSED);
-      applyFocusOutline(obj, false);
-    }
+// Moves the focus highlight to the focused list item.
+void TurntableListScreen::updateFocusedState() { rotaryShowFocus(focusedIndex); }
+
+// Maps a focus index to its list row.
+lv_obj_t *TurntableListScreen::rotaryFocusObject(int index) const {
+  if (index < 0 || index >= static_cast<int>(rowObj.size())) {
+    return nullptr;
   }
+  return rowObj[index];
 }
 
-// Moves the rotary focus by `direction` steps (+1 down, -1 up).
+// Moves the rotary focus by `direction` index rows (+1 down, -1 up), skipping
+// turntable headers and wrapping at either end.
 void TurntableListScreen::moveFocus(int direction) {
-  if (isCleanedUp || listItems.empty() || direction == 0) {
+  if (isCleanedUp || indexRows.empty() || direction == 0) {
     return;
   }
 
-  int index = focusedIndex;
-  if (index < 0 || index >= static_cast<int>(listItems.size()) ||
-      !std::dynamic_pointer_cast<TurntableIndexListItem>(listItems[index])) {
-    index = -1;
-  }
-
-  for (size_t attempts = 0; attempts < listItems.size(); ++attempts) {
-    index += direction;
-    if (index >= static_cast<int>(listItems.size())) {
-      index = 0;
-    } else if (index < 0) {
-      index = static_cast<int>(listItems.size()) - 1;
-    }
-
-    if (std::dynamic_pointer_cast<TurntableIndexListItem>(listItems[index])) {
-      focusedIndex = index;
-      updateFocusedState();
-      return;
-    }
+  const int count = static_cast<int>(indexRows.size());
+  int slot = (static_cast<int>(focusedSlot) + direction) % count;
+  if (slot < 0) {
+    slot += count;
   }
+  focusedSlot = static_cast<size_t>(slot);
+  focusedIndex = static_cast<int>(indexRows[focusedSlot]);
+  updateFocusedState();
 }
 
 // Triggers the action for the currently focused item.
 void TurntableListScreen::activateFocused() {
-  if (isCleanedUp || focusedIndex < 0 || focusedIndex >= static_cast<int>(listItems.size())) {
+  if (isCleanedUp || focusedIndex < 0 || focusedIndex >= static_cast<int>(rowObj.size())) {
     return;
   }
 
-  auto item = listItems[focusedIndex];
-  if (item) {
-    activateItem(item->getLvObj());
-  }
+  activateRow(focusedIndex);
 }
 
-// Sends a move-to-index command for the given index item to the DCC server.
-void TurntableListScreen::moveToIndex(std::shared_ptr<TurntableIndexListItem> index) {
-  ESP_LOGI(TAG, "Moving to Turntable ID %d Index ID %d", index->getTurntableId(), index->getId());
+// Sends a move-to-index command for the given turntable index to the DCC server.
+void TurntableListScreen::moveToIndex(int turntableId, int indexId) {
+  ESP_LOGI(TAG, "Moving to Turntable ID %d Index ID %d", turntableId, indexId);
   auto wifiControl = utilities::WifiControl::instance();
-  auto turnTable = DCCExController::Turntable::getById(index->getTurntableId());
+  auto turnTable = DCCExController::Turntable::getById(turntableId);
   if (turnTable) {
-    auto turnTableIndex = turnTable->getIndexById(index->getId());
+    auto turnTableIndex = turnTable->getIndexById(indexId);
     if (turnTableIndex) {
       if (!wifiControl->rotateTurntableToIndex(turnTable->getId(), turnTableIndex->getId())) {
         ESP_LOGW(TAG, "Cannot move turntable while disconnected");
       }
     } else {
-      ESP_LOGW(TAG, "No Turntable index found for ID %d", index->getId());
+      ESP_LOGW(TAG, "No Turntable index found for ID %d", indexId);
     }
   } else {
-    ESP_LOGW(TAG, "No Turntable found for ID %d", index->getTurntableId());
-  }
-}
-
-// Returns the list item (turntable or index) whose LVGL button matches bn.
-std::shared_ptr<IListItem> TurntableListScreen::getItem(lv_obj_t *bn) {
-  for (const auto &item : listItems) {
-    if (item->getLvObj() == bn) {
-      return item;
-    }
+    ESP_LOGW(TAG, "No Turntable found for ID %d", turntableId);
   }
-  return nullptr;
-}
-
-// Returns the TurntableListItem matching the given DCC turntable ID, or nullptr.
-std::shared_ptr<TurntableListItem> TurntableListScreen::getItemByTurntableId(int TurntableId) {
-  for (const auto &item : listItems) {
-    auto turnTableItem = std::dynamic_pointer_cast<TurntableListItem>(item);
-    if (turnTableItem && turnTableItem->getId() == TurntableId) {
-      return turnTableItem;
-    }
-  }
-  return nullptr;
-}
-
-// Returns the index item matching the given turntable ID and index number.
-std::shared_ptr<TurntableIndexListItem> TurntableListScreen::getIndexItemByTurntableAndIndex(int turntableId,
-                                                                                             int indexId) {
-  for (const auto &item : listItems) {
-    auto indexItem = std::dynamic_pointer_cast<TurntableIndexListItem>(item);
-    if (indexItem && indexItem->getTurntableId() == turntableId && indexItem->getId() == indexId) {
-      return indexItem;
-    }
-  }
-  return nullptr;
 }
 
 void TurntableListScreen::setTurntableIndexCheckedState(int turntableId, int indexId, bool checked) {
-  for (const auto &item : listItems) {
-    auto indexItem = std::dynamic_pointer_cast<TurntableIndexListItem>(item);
-    if (!indexItem) {
-      continue;
-    }
-
-    if (indexItem->getTurntableId() == turntableId && indexItem->getId() == indexId) {
-      if (checked) {
-        lv_obj_add_state(indexItem->getLvObj(), LV_STATE_CHECKED);
-      } else {
-        lv_obj_clear_state(indexItem->getLvObj(), LV_STATE_CHECKED);
-      }
-      return;
-    }
+  const int row = rowOfIndex(turntableId, indexId);
+  if (row >= 0) {
+    lv_obj_set_state(rowObj[row], LV_STATE_CHECKED, checked);
   }
 }
 
+// Checks `indexId` and unchecks the turntable's other indexes.
 void TurntableListScreen::setExclusiveTurntableIndexChecked(int turntableId, int indexId) {
-  for (const auto &item : listItems) {
-    auto indexItem = std::dynamic_pointer_cast<TurntableIndexListItem>(item);
-    if (!indexItem) {
-      continue;
-    }
-
-    if (indexItem->getTurntableId() != turntableId) {
-      continue;
-    }
-
-    if (indexItem->getId() == indexId) {
-      lv_obj_add_state(indexItem->getLvObj(), LV_STATE_CHECKED);
-    } else {
-      lv_obj_clear_state(indexItem->getLvObj(), LV_STATE_CHECKED);
-    }
+  auto it = turntableById.find(turntableId);
+  if (it == turntableById.end()) {
+    return;
+  }
+  const TurntableRange &range = turntables[it->second];
+  for (size_t row = range.firstIndexRow; row < range.endRow; ++row) {
+    lv_obj_set_state(rowObj[row], LV_STATE_CHECKED, rowIndexId[row] == indexId);
   }
 }
 
@@ -356,6 +394,7 @@ void TurntableListScreen::startTurntableFlashing(int turntableId, int indexId) {
     stopTurntableFlashing(false);
     flashingTurntableId = turntableId;
     flashingIndexId = indexId;
+    flashingRow = rowOfIndex(turntableId, indexId);
   }
 
   setExclusiveTurntableIndexChecked(turntableId, indexId);
@@ -384,29 +423,23 @@ void TurntableListScreen::stopTurntableFlashing(bool keepHighlighted) {
 
   flashingTurntableId = -1;
   flashingIndexId = -1;
+  flashingRow = -1;
   flashCheckedState = false;
 }
 
+// Flash timer tick: toggles the checked state of the row resolved when
+// flashing started.
 void TurntableListScreen::onFlashTimerTick() {
-  if (isCleanedUp || flashingTurntableId < 0) {
-    return;
-  }
-
-  auto item = getIndexItemByTurntableAndIndex(flashingTurntableId, flashingIndexId);
-  if (!item) {
+  if (isCleanedUp || flashingRow < 0) {
     return;
   }
 
   flashCheckedState = !flashCheckedState;
-  if (flashCheckedState) {
-    lv_obj_add_state(item->getLvObj(), LV_STATE_CHECKED);
-  } else {
-    lv_obj_clear_state(item->getLvObj(), LV_STATE_CHECKED);
-  }
+  lv_obj_set_state(rowObj[flashingRow], LV_STATE_CHECKED, flashCheckedState);
 }
 
 bool TurntableListScreen::isTurntableMoving(int turntableId) const {
   return turntable_flash_timer != nullptr && flashingTurntableId == turntableId;
 }
 
-} // namespace display
\ No newline at end of file
+} // namespace display
@@ -1,9 +1,9 @@
 #pragma once
 #include "RotaryListScreenBase.h"
+#include <cstdint>
 #include <memory>
-
-#include "ListItemBase.h"
-#include "TurntableListItem.h"
+#include <unordered_map>
+#include <vector>
 
 namespace display {
 class TurntableListScreen : public RotaryListScreenBase, public std::enable_shared_from_this<TurntableListScreen> {
@@ -24,44 +24,73 @@ public:
 
   void refreshList();
   void unsubscribeAll();
-  std::shared_ptr<IListItem> getItem(lv_obj_t *bn);
 
   void button_back_callback(lv_event_t *e);
   void button_listitem_click_event_callback(lv_event_t *e);
 
-  void moveToIndex(std::shared_ptr<TurntableIndexListItem> index);
-
 private:
+  friend class UiBenchmark;
+
+  enum class RowKind : uint8_t { Turntable, Index };
+
+  // Rows [firstIndexRow, endRow) are the index rows of one turntable; its
+  // header row sits at firstIndexRow - 1.
+  struct TurntableRange {
+    int turntableId;
+    size_t firstIndexRow;
+    size_t endRow;
+  };
+
+  bool cacheable() const override { return true; }
+  void resume() override;
+  void evicted() override;
+  void subscribeAll();
+
+  void populateList();
+  bool rowsMatchTurntables() const;
+  void clearRows();
+  void addRow(RowKind kind, int turntableId, int indexId, const char *name);
+  int rowOfIndex(int turntableId, int indexId) const;
+  int rowOfObject(const lv_obj_t *obj) const;
   void setTurntableIndexCheckedState(int turntableId, int indexId, bool checked);
   void setExclusiveTurntableIndexChecked(int turntableId, int indexId);
   bool rotaryInputEnabled() const override { return !isCleanedUp; }
   void rotaryMoveFocus(int direction) override { moveFocus(direction); }
   void rotaryActivateFocused() override { activateFocused(); }
+  lv_obj_t *rotaryFocusObject(int index) const override;
   void updateFocusedState();
   void moveFocus(int direction);
   void activateFocused();
-  void activateItem(lv_obj_t *target);
+  void activateRow(int row);
+  void moveToIndex(int turntableId, int indexId);
   void startTurntableFlashing(int turntableId, int indexId);
   void stopTurntableFlashing(bool keepHighlighted);
   void onFlashTimerTick();
   bool isTurntableMoving(int turntableId) const;
 
-  std::vector<std::shared_ptr<IListItem>> listItems;
-  int focusedIndex = -1;
-  std::shared_ptr<TurntableListItem> getItemByTurntableId(int TurntableId);
-  std::shared_ptr<TurntableIndexListItem> getIndexItemByTurntableAndIndex(int turntableId, int indexId);
+  // One entry per list row, struct-of-arrays.
+  std::vector<RowKind> rowKind;
+  std::vector<int> rowTurntableId;
+  std::vector<int> rowIndexId; // -1 for turntable header rows
+  std::vector<lv_obj_t *> rowObj;
+
+  std::vector<TurntableRange> turntables;
+  std::unordered_map<int, size_t> turntableById; // turntable ID -> position in `turntables`
+  std::vector<size_t> indexRows;                 // rows of every index, in list order; the focus cycles over these
+  size_t focusedSlot = 0;                        // position of the focused row in indexRows
+  int focusedIndex = -1;                         // focused row, or -1
 
   lv_msg_sub_dsc_t *turntable_changed_sub = nullptr;
   lv_timer_t *turntable_flash_timer = nullptr;
   int flashingTurntableId = -1;
   int flashingIndexId = -1;
+  int flashingRow = -1;
   bool flashCheckedState = false;
 
   bool isCleanedUp = false;
   lv_obj_t *lbl_title = nullptr;
   lv_obj_t *list_Turntables = nullptr;
   lv_obj_t *btn_back = nullptr;
-  lv_obj_t *currentButton = nullptr;
 
 protected:
   TurntableListScreen() = default;
@@ -0,0 +1,411 @@
+/**
+ * @file UiBenchmark.cpp
+ * @brief Boot-time scripted benchmark of the real UI screens.
+ *
+ * Replays fixed scenarios (DCC menu, connect screen, turnout list, a focus
+ * walk over a 300-row turnout list, roster and turntable lists) against the
+ * live display driver, forcing a synchronous refresh after each action.
+ * DCC-EX data is synthesised through the DCCEXProtocol object lists, so no
+ * server connection is needed. List sizes that would not fit in the LVGL pool
+ * are skipped rather than exhausting it.
+ * Only built when CONFIG_UI_BENCHMARK is enabled.
+ */
+#include "sdkconfig.h"
+
+#if CONFIG_UI_BENCHMARK
+
+#include "UiBenchmark.h"
+#include "ConnectDCC.h"
+#include "DCCMenu.h"
+#include "DisplayManager.h"
+#include "RosterList.h"
+#include "ScreenCache.h"
+#include "TurnoutList.h"
+#include "TurntableList.h"
+#include "connection/dcc_delegate.h"
+#include "connection/wifi_control.h"
+#include "definitions.h"
+#include "ui/lv_msg.h"
+
+#include <cinttypes>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+namespace display {
+
+static const char *TAG = "UI_BENCHMARK";
+
+namespace {
+constexpr uint32_t kTurnoutSizes[] = {50, 100, 200, 500};
+constexpr uint32_t kFocusRows = 300;
+constexpr uint32_t kRosterSize = 100;
+constexpr uint32_t kTurntableCount = 4;
+constexpr uint32_t kIndexesPerTurntable = 8;
+constexpr uint32_t kScrollSteps = 50;
+constexpr uint32_t kToggleCount = 20;
+constexpr uint32_t kPoolReserveBytes = 8 * 1024; // left free for the screens' own widgets
+} // namespace
+
+// Runs every scenario in order and logs one line per step. Leaves the screen
+// cache and the active screen empty and the DCCEXProtocol lists cleared.
+void UiBenchmark::run() {
+  display_ = lv_display_get_default();
+  if (display_ == nullptr) {
+    ESP_LOGE(TAG, "No LVGL display, benchmark skipped");
+    return;
+  }
+
+  lv_mem_monitor_t mem;
+  lv_mem_monitor(&mem);
+  ESP_LOGI(TAG, "UI benchmark start: %lux%lu, LVGL pool %lu KB",
+           static_cast<unsigned long>(lv_display_get_horizontal_resolution(display_)),
+           static_cast<unsigned long>(lv_display_get_vertical_resolution(display_)),
+           static_cast<unsigned long>(mem.total_size / 1024));
+
+  lv_obj_clean(lv_screen_active());
+  renderFrame();
+
+  runMenu();
+  runConnect();
+  runTurnouts();
+  runFocus();
+  runRoster();
+  runTurntables();
+
+  ScreenCache::instance()->evictAll();
+  lv_obj_clean(lv_screen_active());
+  names_.clear();
+  lv_mem_monitor(&mem);
+  ESP_LOGI(TAG, "UI benchmark done: LVGL heap peak %lu KB", static_cast<unsigned long>(mem.max_used / 1024));
+}
+
+// DCC menu: open, walk the focus over every button, close.
+void UiBenchmark::runMenu() {
+  auto menu = DCCMenu::instance();
+
+  beginStep("menu", "open");
+  menu->showScreen();
+  renderFrame();
+  endStep();
+
+  beginStep("menu", "focus x7");
+  for (int i = 0; i < 7; ++i) {
+    menu->rotaryMoveFocus(1);
+    renderFrame();
+  }
+  endStep();
+
+  beginStep("menu", "back");
+  menu->cleanUp();
+  renderFrame();
+  endStep();
+}
+
+// Connect screen with no discovered servers: open and close.
+void UiBenchmark::runConnect() {
+  auto connect = ConnectDCCScreen::instance();
+
+  beginStep("connect", "open");
+  connect->showScreen();
+  renderFrame();
+  endStep();
+
+  beginStep("connect", "back");
+  connect->cleanUp();
+  renderFrame();
+  endStep();
+}
+
+// Turnout list: grows the list through kTurnoutSizes, repopulates it
+// unchanged, filters it, then scrolls, toggles turnouts through the
+// MSG_DCC_TURNOUT_CHANGED path, navigates back and returns from the menu.
+void UiBenchmark::runTurnouts() {
+  auto screen = TurnoutListScreen::instance();
+
+  beginStep("turnouts", "open");
+  screen->showScreen();
+  renderFrame();
+  endStep();
+
+  const uint32_t baselineUsed = lvglHeapUsed();
+  uint32_t bytesPerItem = 0;
+  uint32_t created = 0;
+  for (uint32_t size : kTurnoutSizes) {
+    if (!fitsInPool(size, bytesPerItem, baselineUsed)) {
+      ESP_LOGW(TAG, "turnouts: skipping %lu items, ~%lu B each would overflow the LVGL pool",
+               static_cast<unsigned long>(size), static_cast<unsigned long>(bytesPerItem));
+      break;
+    }
+    for (; created < size; ++created) {
+      auto *turnout = new DCCExController::Turnout(static_cast<int>(created + 1), (created % 3) == 0);
+      turnout->setName(keepName("Turnout " + std::to_string(created + 1)));
+    }
+
+    beginStep("turnouts", "populate " + std::to_string(size));
+    screen->populateList();
+    renderFrame();
+    endStep();
+
+    const uint32_t used = lvglHeapUsed();
+    bytesPerItem = used > baselineUsed ? (used - baselineUsed) / size : 0;
+  }
+  turnoutRowBytes_ = bytesPerItem;
+
+  // A list message with nothing changed should rebind no rows.
+  beginStep("turnouts", "repopulate");
+  screen->populateList();
+  renderFrame();
+  endStep();
+
+  // Typing into the filter bar: a short query, one that narrows it, then clear.
+  for (const char *query : {"1", "12", ""}) {
+    beginStep("turnouts", std::string("filter \"") + query + "\"");
+    lv_textarea_set_text(screen->ta_filter, query);
+    renderFrame();
+    endStep();
+  }
+
+  beginStep("turnouts", "scroll " + std::to_string(kScrollSteps));
+  for (uint32_t i = 0; i < kScrollSteps; ++i) {
+    screen->rotaryMoveFocus(1);
+    renderFrame();
+  }
+  endStep();
+
+  beginStep("turnouts", "toggle " + std::to_string(kToggleCount));
+  for (uint32_t i = 0; i < kToggleCount && i < screen->turnouts.size(); ++i) {
+    auto turnout = DCCExController::Turnout::getById(screen->turnouts[i].id);
+    if (turnout == nullptr) {
+      continue;
+    }
+    turnout->setThrown(!turnout->getThrown());
+    TurnoutActionData data{turnout->getId(), turnout->getThrown()};
+    lv_msg_send(MSG_DCC_TURNOUT_CHANGED, &data);
+    renderFrame();
+  }
+  endStep();
+
+  beginStep("turnouts", "back");
+  screen->cleanUp();
+  renderFrame();
+  endStep();
+
+  // Away to the menu and back again: the cached list is loaded, not rebuilt.
+  auto menu = DCCMenu::instance();
+  menu->showScreen();
+  renderFrame();
+  beginStep("turnouts", "reopen");
+  menu->cleanUp();
+  screen->showScreen();
+  renderFrame();
+  endStep();
+  screen->cleanUp();
+
+  DCCExController::Turnout::clearTurnoutList();
+}
+
+// Focus walk: a turnout list of kFocusRows rows, focus stepped through every
+// row with one frame per step, so the step's avg and max frame time are the
+// per-step figures. Uses the row cost measured by runTurnouts for the pool
+// check.
+void UiBenchmark::runFocus() {
+  auto screen = TurnoutListScreen::instance();
+  screen->showScreen();
+  renderFrame();
+
+  if (!fitsInPool(kFocusRows, turnoutRowBytes_, lvglHeapUsed())) {
+    ESP_LOGW(TAG, "focus: skipping %lu rows, ~%lu B each would overflow the LVGL pool",
+             static_cast<unsigned long>(kFocusRows), static_cast<unsigned long>(turnoutRowBytes_));
+    screen->cleanUp();
+    renderFrame();
+    return;
+  }
+  for (uint32_t i = 0; i < kFocusRows; ++i) {
+    auto *turnout = new DCCExController::Turnout(static_cast<int>(i + 1), (i % 3) == 0);
+    turnout->setName(keepName("Turnout " + std::to_string(i + 1)));
+  }
+
+  beginStep("focus", "populate " + std::to_string(kFocusRows));
+  screen->populateList();
+  renderFrame();
+  endStep();
+
+  beginStep("focus", "focus x" + std::to_string(kFocusRows));
+  for (uint32_t i = 0; i < kFocusRows; ++i) {
+    screen->rotaryMoveFocus(1);
+    renderFrame();
+  }
+  endStep();
+
+  beginStep("focus", "back");
+  screen->cleanUp();
+  renderFrame();
+  endStep();
+
+  DCCExController::Turnout::clearTurnoutList();
+}
+
+// Roster list: open, populate with kRosterSize locos, close.
+void UiBenchmark::runRoster() {
+  auto screen = RosterListScreen::instance();
+
+  beginStep("roster", "open");
+  screen->showScreen();
+  renderFrame();
+  endStep();
+
+  for (uint32_t i = 0; i < kRosterSize; ++i) {
+    auto *loco = new DCCExController::Loco(static_cast<int>(i + 1), DCCExController::LocoSource::LocoSourceRoster);
+    loco->setName(keepName("Loco " + std::to_string(i + 1)));
+  }
+
+  beginStep("roster", "populate " + std::to_string(kRosterSize));
+  screen->populateList();
+  renderFrame();
+  endStep();
+
+  beginStep("roster", "back");
+  screen->cleanUp();
+  renderFrame();
+  endStep();
+
+  DCCExController::Loco::clearRoster();
+}
+
+// Turntable list: kTurntableCount turntables with kIndexesPerTurntable
+// positions each; open, populate, walk the focus over every row, close.
+void UiBenchmark::runTurntables() {
+  auto screen = TurntableListScreen::instance();
+
+  beginStep("turntables", "open");
+  screen->showScreen();
+  renderFrame();
+  endStep();
+
+  for (uint32_t t = 0; t < kTurntableCount; ++t) {
+    auto *turntable = new DCCExController::Turntable(static_cast<int>(t + 1));
+    turntable->setName(keepName("Turntable " + std::to_string(t + 1)));
+    turntable->setNumberOfIndexes(static_cast<int>(kIndexesPerTurntable));
+    for (uint32_t i = 0; i < kIndexesPerTurntable; ++i) {
+      turntable->addIndex(new DCCExController::TurntableIndex(static_cast<int>(t + 1), static_cast<int>(i),
+                                                              static_cast<int>(i * 450),
+                                                              keepName("Road " + std::to_string(i + 1))));
+    }
+  }
+
+  const uint32_t rows = kTurntableCount * (kIndexesPerTurntable + 1);
+  beginStep("turntables", "populate " + std::to_string(rows));
+  screen->populateList();
+  renderFrame();
+  endStep();
+
+  beginStep("turntables", "focus x" + std::to_string(rows));
+  for (uint32_t i = 0; i < rows; ++i) {
+    screen->rotaryMoveFocus(1);
+    renderFrame();
+  }
+  endStep();
+
+  beginStep("turntables", "back");
+  screen->cleanUp();
+  renderFrame();
+  endStep();
+
+  DCCExController::Turntable::clearTurntableList();
+}
+
+// Starts measuring a step: snapshots the object count and resets the flush
+// counters.
+void UiBenchmark::beginStep(const char *scenario, const std::string &step) {
+  scenario_ = scenario;
+  step_ = step;
+  frames_ = 0;
+  frameUs_ = 0;
+  maxFrameUs_ = 0;
+  objectsBefore_ = countObjects(lv_screen_active());
+  DisplayManager::takeFlushStats();
+  stepStartUs_ = esp_timer_get_time();
+}
+
+// Finishes the current step and logs its figures. "step" is the wall time of
+// the whole step (widget work plus frames); "frame" covers lv_refr_now only.
+void UiBenchmark::endStep() {
+  const uint64_t stepUs = static_cast<uint64_t>(esp_timer_get_time() - stepStartUs_);
+  const auto flush = DisplayManager::takeFlushStats();
+  const uint32_t objects = countObjects(lv_screen_active());
+  const uint64_t avgFrameUs = frames_ > 0 ? frameUs_ / frames_ : 0;
+
+  lv_mem_monitor_t mem;
+  lv_mem_monitor(&mem);
+
+  ESP_LOGI(TAG,
+           "%-10s %-14s step %6" PRIu64 ".%" PRIu64 " ms | frames %3lu avg %5" PRIu64 ".%" PRIu64 " ms max %5" PRIu64
+           ".%" PRIu64 " ms | objs %5lu (%+ld) | heap %3lu KB peak %3lu KB | flushed %5" PRIu64 " KB",
+           scenario_, step_.c_str(), stepUs / 1000, (stepUs / 100) % 10, static_cast<unsigned long>(frames_),
+           avgFrameUs / 1000, (avgFrameUs / 100) % 10, maxFrameUs_ / 1000, (maxFrameUs_ / 100) % 10,
+           static_cast<unsigned long>(objects),
+           static_cast<long>(objects) - static_cast<long>(objectsBefore_),
+           static_cast<unsigned long>((mem.total_size - mem.free_size) / 1024),
+           static_cast<unsigned long>(mem.max_used / 1024), flush.bytes / 1024);
+
+  // Frames busy-wait on the flush; let the idle task run between steps so the
+  // task watchdog stays quiet.
+  vTaskDelay(1);
+}
+
+// Renders and flushes everything invalidated so far, synchronously.
+void UiBenchmark::renderFrame() {
+  const int64_t start = esp_timer_get_time();
+  lv_refr_now(display_);
+  const uint64_t elapsed = static_cast<uint64_t>(esp_timer_get_time() - start);
+  ++frames_;
+  frameUs_ += elapsed;
+  if (elapsed > maxFrameUs_) {
+    maxFrameUs_ = elapsed;
+  }
+}
+
+// True when `items` list rows at the measured per-row cost fit in the LVGL
+// pool with kPoolReserveBytes to spare. With no measurement yet, assumes yes.
+bool UiBenchmark::fitsInPool(uint32_t items, uint32_t bytesPerItem, uint32_t baselineUsed) const {
+  if (bytesPerItem == 0) {
+    return true;
+  }
+  lv_mem_monitor_t mem;
+  lv_mem_monitor(&mem);
+  const uint64_t needed = static_cast<uint64_t>(baselineUsed) + static_cast<uint64_t>(items) * bytesPerItem;
+  return needed + kPoolReserveBytes <= mem.total_size;
+}
+
+// Stores a name for a synthetic DCC-EX object and returns a pointer that stays
+// valid until run() returns.
+char *UiBenchmark::keepName(std::string name) {
+  names_.push_back(std::move(name));
+  return names_.back().data();
+}
+
+// Number of objects in the tree rooted at obj, including obj.
+uint32_t UiBenchmark::countObjects(lv_obj_t *obj) {
+  if (obj == nullptr) {
+    return 0;
+  }
+  uint32_t count = 1;
+  const uint32_t children = lv_obj_get_child_count(obj);
+  for (uint32_t i = 0; i < children; ++i) {
+    count += countObjects(lv_obj_get_child(obj, static_cast<int32_t>(i)));
+  }
+  return count;
+}
+
+// Bytes currently allocated from the LVGL pool.
+uint32_t UiBenchmark::lvglHeapUsed() {
+  lv_mem_monitor_t mem;
+  lv_mem_monitor(&mem);
+  return static_cast<uint32_t>(mem.total_size - mem.free_size);
+}
+
+} // namespace display
+
+#endif // CONFIG_UI_BENCHMARK
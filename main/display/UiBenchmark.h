@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+
+#include <lvgl.h>
+
+namespace display {
+
+// Scripted render benchmark for the real screen classes. Enabled with
+// CONFIG_UI_BENCHMARK, it runs once at boot before the first screen is shown:
+// each scenario opens a screen, fills it with synthetic DCC-EX data, scrolls,
+// toggles and navigates back, rendering a frame after every action. Per-step
+// frame time, live object count, LVGL heap use and bytes flushed are logged so
+// two firmware builds can be compared. host/ runs the same scenarios on Linux.
+// Must run on the LVGL task (or with the LVGL lock held before the render task
+// starts).
+class UiBenchmark {
+public:
+  static std::shared_ptr<UiBenchmark> instance() {
+    static std::shared_ptr<UiBenchmark> s;
+    if (!s)
+      s.reset(new UiBenchmark());
+    return s;
+  }
+
+  UiBenchmark(const UiBenchmark &) = delete;
+  UiBenchmark &operator=(const UiBenchmark &) = delete;
+
+  void run();
+
+private:
+  UiBenchmark() = default;
+
+  void runMenu();
+  void runConnect();
+  void runTurnouts();
+  void runFocus();
+  void runRoster();
+  void runTurntables();
+
+  void beginStep(const char *scenario, const std::string &step);
+  void endStep();
+  void renderFrame();
+  bool fitsInPool(uint32_t items, uint32_t bytesPerItem, uint32_t baselineUsed) const;
+  char *keepName(std::string name);
+
+  static uint32_t countObjects(lv_obj_t *obj);
+  static uint32_t lvglHeapUsed();
+
+  lv_display_t *display_ = nullptr;
+
+  // Current step.
+  const char *scenario_ = "";
+  std::string step_;
+  int64_t stepStartUs_ = 0;
+  uint32_t objectsBefore_ = 0;
+  uint32_t frames_ = 0;
+  uint64_t frameUs_ = 0;
+  uint64_t maxFrameUs_ = 0;
+
+  // LVGL pool bytes per turnout row, measured by runTurnouts.
+  uint32_t turnoutRowBytes_ = 0;
+
+  // Names handed to DCCEXProtocol objects; kept alive until the synthetic
+  // lists are cleared.
+  std::deque<std::string> names_;
+};
+
+} // namespace display
@@ -0,0 +1,298 @@
+/**
+ * @file VirtualList.cpp
+ * @brief Recycling list widget for long DCC-EX lists.
+ *
+ * Rows are created once for the visible window (plus kMarginRows above and
+ * below) and row i % poolSize is reused for data index i, so scrolling by one
+ * row rebinds a single widget. A transparent spacer at the end of the logical
+ * range gives LVGL the full scroll height without materialising every row.
+ */
+#include "VirtualList.h"
+#include "LvglWrapper.h"
+
+#include <algorithm>
+
+namespace display {
+
+namespace {
+constexpr size_t kMarginRows = 2;
+constexpr int kStaleIndex = -2; // slot still shows an old entry and must be rebound
+} // namespace
+
+// Creates the scroll container and the row pool sized to its viewport.
+// Returns the container; click handlers can be attached to it and resolve the
+// tapped row with indexForRow().
+lv_obj_t *VirtualList::create(lv_obj_t *parent, int32_t x, int32_t y, int32_t width, int32_t height,
+                              BindCallback bind, void *userData, const std::string &rowStyle) {
+  reset();
+  bind_ = bind;
+  userData_ = userData;
+  rowStyle_ = rowStyle;
+
+  list_ = makeListView(parent, x, y, width, height);
+  // Rows are positioned by index, not by the list's flex layout.
+  lv_obj_set_layout(list_, LV_LAYOUT_NONE);
+  lv_obj_add_event_cb(list_, &VirtualList::scroll_event_trampoline, LV_EVENT_SCROLL, this);
+
+  spacer_ = lv_obj_create(list_);
+  lv_obj_remove_style_all(spacer_);
+  lv_obj_remove_flag(spacer_, LV_OBJ_FLAG_CLICKABLE);
+  lv_obj_set_size(spacer_, 1, 1);
+
+  lv_obj_update_layout(list_);
+  viewportHeight_ = lv_obj_get_content_height(list_);
+  const size_t visibleRows = static_cast<size_t>((viewportHeight_ + kRowPitch - 1) / kRowPitch) + 1;
+  const size_t poolSize = visibleRows + 2 * kMarginRows;
+  rows_.reserve(poolSize);
+  slotIndex_.assign(poolSize, -1);
+  for (size_t i = 0; i < poolSize; ++i) {
+    rows_.push_back(createRow());
+  }
+  return list_;
+}
+
+// Forgets all widgets and state. The widgets themselves are deleted with the
+// screen's lv_obj_clean().
+void VirtualList::reset() {
+  list_ = nullptr;
+  spacer_ = nullptr;
+  rows_.clear();
+  slotIndex_.clear();
+  count_ = 0;
+  viewportHeight_ = 0;
+  focusedIndex_ = -1;
+  checkedIndex_ = -1;
+}
+
+// Sets the logical row count, clamps focus/checked to it and rebinds every
+// visible row.
+void VirtualList::setCount(size_t count) {
+  if (!list_) {
+    return;
+  }
+  count_ = count;
+  if (focusedIndex_ >= static_cast<int>(count_)) {
+    focusedIndex_ = -1;
+  }
+  if (checkedIndex_ >= static_cast<int>(count_)) {
+    checkedIndex_ = -1;
+  }
+
+  const int32_t contentBottom = count_ > 0 ? static_cast<int32_t>(count_) * kRowPitch - kRowGap : 1;
+  lv_obj_set_y(spacer_, contentBottom - 1);
+  lv_obj_update_layout(list_);
+  clampScroll();
+  updateWindow(true);
+}
+
+// Second half of reconcile(): resizes the scroll range to `count`, marks the
+// rows for changed or shifted indices stale and rebinds only those, then
+// refreshes the state of the rows that lost focus/checked.
+void VirtualList::applyReconcile(size_t count, size_t firstShifted, const std::vector<size_t> &changed,
+                                 int oldFocused, int oldChecked) {
+  if (!list_) {
+    return;
+  }
+  const size_t oldCount = count_;
+  count_ = count;
+  if (count_ != oldCount) {
+    const int32_t contentBottom = count_ > 0 ? static_cast<int32_t>(count_) * kRowPitch - kRowGap : 1;
+    lv_obj_set_y(spacer_, contentBottom - 1);
+    lv_obj_update_layout(list_);
+    // A shorter list may pull the scroll offset back; the scroll event then
+    // moves the window before the stale rows below are rebound.
+    clampScroll();
+  }
+
+  for (size_t slot = 0; slot < rows_.size(); ++slot) {
+    const int index = slotIndex_[slot];
+    if (index < 0) {
+      continue;
+    }
+    if (static_cast<size_t>(index) >= firstShifted ||
+        std::binary_search(changed.begin(), changed.end(), static_cast<size_t>(index))) {
+      slotIndex_[slot] = kStaleIndex;
+    }
+  }
+  updateWindow(false);
+
+  for (int index : {oldFocused, oldChecked, focusedIndex_, checkedIndex_}) {
+    if (lv_obj_t *row = rowForIndex(index)) {
+      applyRowState(row, index);
+    }
+  }
+}
+
+// Rebinds every materialised row, e.g. after the underlying data changed.
+void VirtualList::refresh() { updateWindow(true); }
+
+// Rebinds the row showing `index`, if it is materialised.
+void VirtualList::refreshIndex(size_t index) {
+  if (rows_.empty() || index >= count_) {
+    return;
+  }
+  const size_t slot = index % rows_.size();
+  if (slotIndex_[slot] == static_cast<int>(index)) {
+    bindSlot(slot, static_cast<int>(index), true);
+  }
+}
+
+// Moves focus to `index` (or clears it with -1), scrolling it into view. Only
+// the previously and newly focused rows change state.
+void VirtualList::setFocusedIndex(int index) {
+  if (index >= static_cast<int>(count_)) {
+    index = -1;
+  }
+  const int previous = focusedIndex_;
+  focusedIndex_ = index;
+  if (lv_obj_t *row = rowForIndex(previous)) {
+    applyRowState(row, previous);
+  }
+  scrollIndexIntoView(index);
+  if (lv_obj_t *row = rowForIndex(index)) {
+    applyRowState(row, index);
+  }
+}
+
+// Marks `index` as the checked (selected) row, or clears it with -1.
+void VirtualList::setCheckedIndex(int index) {
+  if (index >= static_cast<int>(count_)) {
+    index = -1;
+  }
+  const int previous = checkedIndex_;
+  checkedIndex_ = index;
+  if (lv_obj_t *row = rowForIndex(previous)) {
+    applyRowState(row, previous);
+  }
+  if (lv_obj_t *row = rowForIndex(index)) {
+    applyRowState(row, index);
+  }
+}
+
+// Row currently bound to `index`, or nullptr when it is outside the window.
+lv_obj_t *VirtualList::rowForIndex(int index) const {
+  if (index < 0 || rows_.empty()) {
+    return nullptr;
+  }
+  const size_t slot = static_cast<size_t>(index) % rows_.size();
+  return slotIndex_[slot] == index ? rows_[slot] : nullptr;
+}
+
+// Data index bound to `row`, or -1 if it is not one of this list's rows. Each
+// row carries its pool slot in its user data.
+int VirtualList::indexForRow(const lv_obj_t *row) const {
+  const int slot = getItemIndex(row);
+  if (slot < 0 || static_cast<size_t>(slot) >= rows_.size() || rows_[slot] != row) {
+    return -1;
+  }
+  return slotIndex_[slot];
+}
+
+// Sets the icon (image descriptor or symbol string) and text of a row created
+// by this list.
+void VirtualList::setRowContent(lv_obj_t *row, const void *icon, const char *text) {
+  lv_obj_t *image = lv_obj_get_child(row, 0);
+  lv_obj_t *label = lv_obj_get_child(row, 1);
+  if (image && lv_image_get_src(image) != icon) {
+    lv_image_set_src(image, icon);
+  }
+  if (label) {
+    lv_label_set_text(label, text ? text : "");
+  }
+}
+
+// Creates one pooled row: a list button with an icon and a label, hidden
+// until bound. Its user data is the slot it will occupy in rows_.
+lv_obj_t *VirtualList::createRow() {
+  lv_obj_t *row = lv_list_add_btn_mode(list_, LV_SYMBOL_DUMMY, "", LV_LABEL_LONG_MODE_DOTS);
+  setItemIndex(row, rows_.size());
+  lv_obj_add_flag(row, LV_OBJ_FLAG_EVENT_BUBBLE);
+  lv_obj_add_flag(row, LV_OBJ_FLAG_HIDDEN);
+  lv_obj_set_flex_align(row, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_START);
+  lv_obj_set_height(row, kRowHeight);
+  setStylePart(row, rowStyle_, LV_PART_MAIN);
+  setStylePart(row, "list.item.selected", LV_STATE_CHECKED);
+  return row;
+}
+
+// Works out which indices should be materialised for the current scroll
+// position and binds the pool to them. Without rebindAll, rows already
+// showing the right index are left untouched.
+void VirtualList::updateWindow(bool rebindAll) {
+  if (!list_ || rows_.empty()) {
+    return;
+  }
+  const size_t poolSize = rows_.size();
+  const int32_t scrollY = std::max<int32_t>(0, lv_obj_get_scroll_y(list_));
+  size_t first = static_cast<size_t>(scrollY / kRowPitch);
+  first = first > kMarginRows ? first - kMarginRows : 0;
+  if (count_ > poolSize) {
+    first = std::min(first, count_ - poolSize);
+  } else {
+    first = 0;
+  }
+
+  for (size_t i = first; i < first + poolSize; ++i) {
+    bindSlot(i % poolSize, i < count_ ? static_cast<int>(i) : -1, rebindAll);
+  }
+}
+
+// Binds the row in `slot` to `index` (or hides it for -1).
+void VirtualList::bindSlot(size_t slot, int index, bool force) {
+  lv_obj_t *row = rows_[slot];
+  if (!force && slotIndex_[slot] == index) {
+    return;
+  }
+  slotIndex_[slot] = index;
+  if (index < 0) {
+    lv_obj_add_flag(row, LV_OBJ_FLAG_HIDDEN);
+    return;
+  }
+  lv_obj_set_y(row, index * kRowPitch);
+  applyRowState(row, index);
+  if (bind_) {
+    bind_(row, static_cast<size_t>(index), userData_);
+  }
+  lv_obj_remove_flag(row, LV_OBJ_FLAG_HIDDEN);
+}
+
+// Applies the focused/checked states that belong to `index`.
+void VirtualList::applyRowState(lv_obj_t *row, int index) const {
+  if (index == focusedIndex_) {
+    lv_obj_add_state(row, LV_STATE_FOCUSED);
+  } else {
+    lv_obj_remove_state(row, LV_STATE_FOCUSED);
+  }
+  if (index == checkedIndex_) {
+    lv_obj_add_state(row, LV_STATE_CHECKED);
+  } else {
+    lv_obj_remove_state(row, LV_STATE_CHECKED);
+  }
+}
+
+// Pulls the scroll offset back if the list shrank below it.
+void VirtualList::clampScroll() {
+  const int32_t scrollY = lv_obj_get_scroll_y(list_);
+  const int32_t overshoot = -lv_obj_get_scroll_bottom(list_);
+  if (scrollY > 0 && overshoot > 0) {
+    lv_obj_scroll_to_y(list_, std::max<int32_t>(0, scrollY - overshoot), LV_ANIM_OFF);
+  }
+}
+
+// Scrolls the container just enough for the row at `index` to be fully
+// visible. The resulting LV_EVENT_SCROLL rebinds the window.
+void VirtualList::scrollIndexIntoView(int index) {
+  if (!list_ || index < 0) {
+    return;
+  }
+  const int32_t top = index * kRowPitch;
+  const int32_t bottom = top + kRowHeight;
+  const int32_t scrollY = lv_obj_get_scroll_y(list_);
+  if (top < scrollY) {
+    lv_obj_scroll_to_y(list_, top, LV_ANIM_OFF);
+  } else if (bottom > scrollY + viewportHeight_) {
+    lv_obj_scroll_to_y(list_, bottom - viewportHeight_, LV_ANIM_OFF);
+  }
+}
+
+} // namespace display
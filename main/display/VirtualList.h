@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <lvgl.h>
+
+namespace display {
+
+// Scrollable list that keeps only enough row widgets to cover the viewport
+// plus a small margin, and rebinds them to data indices as the list scrolls.
+// The screen owns the data; the list asks for it through a bind callback.
+// Rows are fixed-height list buttons (icon + label) placed at index * pitch
+// inside a container whose scroll range spans the full logical count. Focus
+// and checked state are tracked by index so they survive row recycling.
+// All methods must run on the LVGL task.
+class VirtualList {
+public:
+  // Fills `row` for data `index`; use setRowContent() for icon and text.
+  using BindCallback = void (*)(lv_obj_t *row, size_t index, void *userData);
+
+  VirtualList() = default;
+  VirtualList(const VirtualList &) = delete;
+  VirtualList &operator=(const VirtualList &) = delete;
+
+  lv_obj_t *create(lv_obj_t *parent, int32_t x, int32_t y, int32_t width, int32_t height, BindCallback bind,
+                   void *userData, const std::string &rowStyle = "list.item");
+  void reset();
+
+  void setCount(size_t count);
+  size_t count() const { return count_; }
+  void refresh();
+  void refreshIndex(size_t index);
+
+  // Replaces `current` with `next`, matching entries by `key(entry)`, and
+  // rebinds only what changed: rows whose entry differs (operator==) while
+  // keeping its position, and rows at or after the first inserted, removed
+  // or reordered entry. Focus and checked state follow their key to its new
+  // index (or clear if the key is gone); the scroll offset is kept.
+  template <typename Entry, typename KeyFn>
+  void reconcile(std::vector<Entry> &current, std::vector<Entry> &&next, KeyFn key) {
+    const int oldFocused = focusedIndex_;
+    const int oldChecked = checkedIndex_;
+    const bool hadFocused = oldFocused >= 0 && oldFocused < static_cast<int>(current.size());
+    const bool hadChecked = oldChecked >= 0 && oldChecked < static_cast<int>(current.size());
+    const auto focusedKey = hadFocused ? key(current[oldFocused]) : decltype(key(current[0])){};
+    const auto checkedKey = hadChecked ? key(current[oldChecked]) : decltype(key(current[0])){};
+
+    size_t firstShifted = 0;
+    while (firstShifted < current.size() && firstShifted < next.size() &&
+           key(current[firstShifted]) == key(next[firstShifted])) {
+      ++firstShifted;
+    }
+    std::vector<size_t> changed;
+    for (size_t i = 0; i < firstShifted; ++i) {
+      if (!(current[i] == next[i])) {
+        changed.push_back(i);
+      }
+    }
+
+    current = std::move(next);
+    auto indexOf = [&](const auto &wanted) {
+      for (size_t i = 0; i < current.size(); ++i) {
+        if (key(current[i]) == wanted) {
+          return static_cast<int>(i);
+        }
+      }
+      return -1;
+    };
+    focusedIndex_ = hadFocused ? indexOf(focusedKey) : -1;
+    checkedIndex_ = hadChecked ? indexOf(checkedKey) : -1;
+    applyReconcile(current.size(), firstShifted, changed, oldFocused, oldChecked);
+  }
+
+  void setFocusedIndex(int index);
+  int focusedIndex() const { return focusedIndex_; }
+  void setCheckedIndex(int index);
+  int checkedIndex() const { return checkedIndex_; }
+
+  lv_obj_t *obj() const { return list_; }
+  lv_obj_t *rowForIndex(int index) const;
+  int indexForRow(const lv_obj_t *row) const;
+
+  static void setRowContent(lv_obj_t *row, const void *icon, const char *text);
+
+  static constexpr int32_t kRowHeight = 48;
+  static constexpr int32_t kRowGap = 2;
+  static constexpr int32_t kRowPitch = kRowHeight + kRowGap;
+
+private:
+  static void scroll_event_trampoline(lv_event_t *e) {
+    auto *self = static_cast<VirtualList *>(lv_event_get_user_data(e));
+    if (self)
+      self->updateWindow(false);
+  }
+
+  lv_obj_t *createRow();
+  void updateWindow(bool rebindAll);
+  void applyReconcile(size_t count, size_t firstShifted, const std::vector<size_t> &changed, int oldFocused,
+                      int oldChecked);
+  void bindSlot(size_t slot, int index, bool force);
+  void applyRowState(lv_obj_t *row, int index) const;
+  void scrollIndexIntoView(int index);
+  void clampScroll();
+
+  lv_obj_t *list_ = nullptr;
+  lv_obj_t *spacer_ = nullptr;
+  std::vector<lv_obj_t *> rows_;     // row widgets, reused round-robin by index
+  std::vector<int> slotIndex_;       // data index bound to each row, -1 when unused
+  std::string rowStyle_;
+  BindCallback bind_ = nullptr;
+  void *userData_ = nullptr;
+  size_t count_ = 0;
+  int32_t viewportHeight_ = 0;
+  int focusedIndex_ = -1;
+  int checkedIndex_ = -1;
+};
+
+} // namespace display
@@ -58,7 +58,7 @@ void WifiConnectScreen::wifi_connected_callback(lv_msg_t *msg) {
               utilities::WifiHandler::instance()->saveConfiguration();
               vTaskDelete(nullptr);
             },
-            "wifi_save_cfg", 2048, nullptr, tskIDLE_PRIORITY, nullptr);
+            "wifi_save_cfg", 3072, nullptr, tskIDLE_PRIORITY, nullptr);
 
         lv_timer_delete(t);
       },
@@ -14,20 +14,39 @@ public:
 
   WifiListItem(lv_obj_t *parent, size_t index, std::string ssid, int8_t rssi)
       : parentObj(parent), index(index), ssid(std::move(ssid)), rssi(rssi) {
-    lvObj = lv_list_add_btn_mode(parent, LV_SYMBOL_WIFI, (this->ssid + " (" + std::to_string(this->rssi) + "dBm)").c_str(), LV_LABEL_LONG_MODE_DOTS);
+    lvObj = lv_list_add_btn_mode(parent, LV_SYMBOL_WIFI, labelText().c_str(), LV_LABEL_LONG_MODE_DOTS);
     lv_obj_add_flag(lvObj, LV_OBJ_FLAG_EVENT_BUBBLE);
+    setItemIndex(lvObj, index);
     setStylePart(lvObj, "wifi.item", LV_PART_MAIN);
     setStylePart(lvObj, "wifi.item.selected", LV_STATE_CHECKED);
   }
 
-  // update RSSI and icon
-  void setSignalStrength(int rssi) { this->rssi = rssi; }
+  // update RSSI and the label showing it
+  void setSignalStrength(int8_t rssi) {
+    if (this->rssi == rssi)
+      return;
+    this->rssi = rssi;
+    if (lv_obj_t *label = lv_obj_get_child_by_type(lvObj, 0, &lv_label_class))
+      lv_label_set_text(label, labelText().c_str());
+  }
+  // record the item's new position in the list
+  void setIndex(size_t newIndex) {
+    index = newIndex;
+    setItemIndex(lvObj, newIndex);
+  }
+  // true once the running scan has reported this network; cached items are not
+  void markFresh() { fresh = true; }
+  bool isFresh() const { return fresh; }
+  int8_t getRssi() const { return rssi; }
   lv_obj_t *getLvObj() const { return lvObj; }
   std::string getSsid() const { return ssid; }
 
 private:
+  std::string labelText() const { return ssid + " (" + std::to_string(rssi) + "dBm)"; }
+
   lv_obj_t *lvObj;
   std::string ssid;
   int8_t rssi = -100;
+  bool fresh = false;
 };
 } // namespace display
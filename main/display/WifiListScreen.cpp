@@ -2,17 +2,26 @@
  * @file WifiListScreen.cpp
  * @brief Screen that scans for nearby WiFi networks and lets the user pick one.
  *
- * On entry, stops any running mDNS search and kicks off a background scan task.
- * When the scan completes the list is populated and the user can select an
- * access point and tap Connect to proceed to WifiConnectScreen.
+ * On entry, stops any running mDNS search, shows the networks from the last
+ * scan straight away and starts a background scan task. The task scans one
+ * channel at a time and hands each channel's results to the LVGL thread, where
+ * they are merged into the list: a network already listed has its RSSI
+ * updated and its row moved, a new one is inserted at its place by signal
+ * strength. When the scan finishes, networks it did not see are removed and
+ * the results become the new cache. The user can select an access point and
+ * tap Connect to proceed to WifiConnectScreen.
  */
 #include "WifiListScreen.h"
+#include "LvglTask.h"
 #include "LvglWrapper.h"
 #include "WifiConnectScreen.h"
 #include "WifiListItem.h"
 #include "definitions.h"
+#include <algorithm>
+#include <cinttypes>
 #include <esp_event.h>
 #include <esp_log.h>
+#include <esp_timer.h>
 #include <nvs_flash.h>
 #include <regex.h>
 #include <string>
@@ -21,7 +30,8 @@ namespace display {
 
 static const char *TAG = "WIFI_LIST_SCREEN";
 
-// Builds the WiFi scan UI, stops mDNS and starts the background scan task.
+// Builds the WiFi scan UI, shows the cached networks, stops mDNS and starts
+// the background scan task unless one is still running from the last visit.
 void WifiListScreen::show(lv_obj_t *parent, std::weak_ptr<Screen> parentScreen) {
   utilities::WifiHandler::instance()->stopMdnsSearchLoop();
   isCleanedUp = false;
@@ -51,16 +61,36 @@ void WifiListScreen::show(lv_obj_t *parent, std::weak_ptr<Screen> parentScreen)
   // Create spinner overlay (centered)
   spinner = makeSpinner(lvObj_, 0, 0, 50);
 
-  disableButtons();
+  lv_obj_add_state(btn_connect, LV_STATE_DISABLED);
   updateFocusedState();
   rotaryAttach();
 
+  if (!cachedNetworks.empty()) {
+    // Keep the spinner out of the way of the cached list while rescanning.
+    lv_obj_set_size(spinner, 28, 28);
+    lv_obj_align(spinner, LV_ALIGN_TOP_RIGHT, -8, 4);
+    const int64_t ageS = (esp_timer_get_time() - cachedAtUs) / 1000000;
+    ESP_LOGI(TAG, "Showing %u cached networks from %" PRId64 "s ago", (unsigned)cachedNetworks.size(), ageS);
+    if (ageS < 60) {
+      lv_label_set_text_fmt(lbl_title, "WiFi List (%" PRId64 "s ago)", ageS);
+    } else {
+      lv_label_set_text_fmt(lbl_title, "WiFi List (%" PRId64 "m ago)", ageS / 60);
+    }
+    mergeNetworks(cachedNetworks, false);
+  }
+
+  if (scanTaskHandle != 0) {
+    ESP_LOGI(TAG, "Scan still running, its results will stream into this list");
+    return;
+  }
+
   // Start Wi-Fi scan in a separate task
+  scanNetworks.clear();
   xTaskCreate(
       [](void *param) {
         auto *self = static_cast<WifiListScreen *>(param);
         self->scanWifiTask();
-        self->scanTaskHandle = 0; // null before self-delete so cleanUp() won't double-delete
+        self->scanTaskHandle = 0;
         vTaskDelete(nullptr);
       },
       "wifi_scan_task",
@@ -70,15 +100,12 @@ void WifiListScreen::show(lv_obj_t *parent, std::weak_ptr<Screen> parentScreen)
       &scanTaskHandle);
 }
 
-// Releases widget pointers and aborts any running scan task.
+// Releases widget pointers. A running scan task stops itself after the
+// current channel.
 void WifiListScreen::cleanUp() {
   ESP_LOGI(TAG, "WifiListScreen cleaned up");
   isCleanedUp = true;
   rotaryDetach();
-  if (scanTaskHandle != 0) {
-    vTaskDelete(scanTaskHandle);
-    scanTaskHandle = 0;
-  }
   lbl_title = nullptr;
   btn_back = nullptr;
   btn_connect = nullptr;
@@ -86,99 +113,215 @@ void WifiListScreen::cleanUp() {
   spinner = nullptr;
   currentButton = nullptr;
   focusedIndex = -1;
+  items.clear();
   lv_obj_clean(lvObj_);
 }
 
-// FreeRTOS task body: runs the esp_wifi scan, then uses lv_async_call to
-// populate the list on the LVGL thread.
+// FreeRTOS task body: scans the channels one at a time and uses
+// LvglTask::asyncCall to merge each channel's networks into the list on the
+// LVGL thread. Stops early if the screen is cleaned up.
 void WifiListScreen::scanWifiTask() {
   ESP_LOGI(TAG, "Starting background Wi-Fi scan...");
   ESP_ERROR_CHECK(esp_wifi_start());
 
-  wifi_scan_config_t scan_conf = {};
-  scan_conf.ssid = nullptr;
-  scan_conf.bssid = nullptr;
-  scan_conf.channel = 0;
-  scan_conf.show_hidden = true;
+  std::vector<uint8_t> channels;
+#if CONFIG_EXAMPLE_USE_SCAN_CHANNEL_BITMAP
+  channels = {1, 6, 11};
+#else
+  wifi_country_t country = {};
+  if (esp_wifi_get_country(&country) != ESP_OK || country.nchan == 0) {
+    country.schan = 1;
+    country.nchan = 13;
+  }
+  for (uint8_t i = 0; i < country.nchan; ++i) {
+    channels.push_back(country.schan + i);
+  }
+#endif
+
+  const int64_t startUs = esp_timer_get_time();
+  bool complete = true;
+  std::vector<wifi_ap_record_t> ap_info(DEFAULT_SCAN_LIST_SIZE);
+  for (uint8_t channel : channels) {
+    if (isCleanedUp) {
+      complete = false;
+      break;
+    }
+
+    wifi_scan_config_t scan_conf = {};
+    scan_conf.ssid = nullptr;
+    scan_conf.bssid = nullptr;
+    scan_conf.channel = channel;
+    scan_conf.show_hidden = true;
+
+    esp_err_t err = esp_wifi_scan_start(&scan_conf, true);
+    if (err != ESP_OK) {
+      ESP_LOGW(TAG, "Scan of channel %u failed: %s", channel, esp_err_to_name(err));
+      complete = false;
+      continue;
+    }
 
-  ESP_ERROR_CHECK(esp_wifi_scan_start(&scan_conf, true));
+    uint16_t ap_count = 0;
+    esp_wifi_scan_get_ap_num(&ap_count);
+    uint16_t max_records = std::min<uint16_t>(ap_count, DEFAULT_SCAN_LIST_SIZE);
+    if (max_records == 0 || esp_wifi_scan_get_ap_records(&max_records, ap_info.data()) != ESP_OK) {
+      esp_wifi_clear_ap_list();
+      continue;
+    }
+    esp_wifi_clear_ap_list();
+
+    // Copy results into heap before passing to LVGL thread
+    auto *results = new std::vector<Network>();
+    results->reserve(max_records);
+    for (uint16_t i = 0; i < max_records; ++i) {
+      const wifi_ap_record_t &ap = ap_info[i];
+      std::string ssid_str(reinterpret_cast<const char *>(ap.ssid),
+                           strnlen(reinterpret_cast<const char *>(ap.ssid), sizeof(ap.ssid)));
+      if (ssid_str.empty())
+        ssid_str = "<hidden>";
+      ESP_LOGI(TAG, "Found AP on channel %u: SSID='%s', RSSI=%d", channel, ssid_str.c_str(), ap.rssi);
+      results->push_back(Network{std::move(ssid_str), ap.rssi});
+    }
 
-  uint16_t ap_count = 0;
-  ESP_ERROR_CHECK(esp_wifi_scan_get_ap_num(&ap_count));
-  if (ap_count == 0) {
-    ESP_LOGI(TAG, "No APs found");
-    lv_async_call(
+    LvglTask::asyncCall(
         [](void *data) {
-          auto *self = static_cast<WifiListScreen *>(data);
-          if (self->isCleanedUp)
-            return;
-          lv_obj_add_flag(self->spinner, LV_OBJ_FLAG_HIDDEN);
+          auto *ctx = static_cast<std::pair<WifiListScreen *, std::vector<Network> *> *>(data);
+          if (!ctx->first->isCleanedUp) {
+            ctx->first->mergeNetworks(*ctx->second, true);
+          }
+          delete ctx->second;
+          delete ctx;
         },
-        this);
-    return;
+        new std::pair<WifiListScreen *, std::vector<Network> *>(this, results));
   }
 
-  uint16_t max_records = std::min<uint16_t>(ap_count, DEFAULT_SCAN_LIST_SIZE);
-  std::vector<wifi_ap_record_t> ap_info(max_records);
-  ESP_ERROR_CHECK(esp_wifi_scan_get_ap_records(&max_records, ap_info.data()));
-
-  // Copy results into heap before passing to LVGL thread
-  auto *results = new std::vector<wifi_ap_record_t>(ap_info);
-
-  // Now update UI safely
-  lv_async_call(
+  ESP_LOGI(TAG, "Wi-Fi scan %s after %" PRId64 " ms", complete ? "complete" : "stopped",
+           (esp_timer_get_time() - startUs) / 1000);
+  LvglTask::asyncCall(
       [](void *data) {
-        auto *ctx = static_cast<std::pair<WifiListScreen *, std::vector<wifi_ap_record_t> *> *>(data);
-        if (ctx->first->isCleanedUp) {
-          delete ctx->second;
-          delete ctx;
-          return;
-        }
-        auto *self = ctx->first;
-        auto *records = ctx->second;
-        self->populateList(*records);
-        lv_obj_add_flag(self->spinner, LV_OBJ_FLAG_HIDDEN);
-        self->enableButtons();
-        delete records;
+        auto *ctx = static_cast<std::pair<WifiListScreen *, bool> *>(data);
+        ctx->first->finishScan(ctx->second);
         delete ctx;
       },
-      new std::pair<WifiListScreen *, std::vector<wifi_ap_record_t> *>(this, results));
-
-  ESP_ERROR_CHECK(esp_wifi_scan_stop());
+      new std::pair<WifiListScreen *, bool>(this, complete));
 }
 
-// Populates the list widget with the scan results.
-void WifiListScreen::populateList(const std::vector<wifi_ap_record_t> &records) {
-  for (const auto &ap : records) {
-    std::string ssid_str(reinterpret_cast<const char *>(ap.ssid),
-                         strnlen(reinterpret_cast<const char *>(ap.ssid), sizeof(ap.ssid)));
-    if (ssid_str.empty())
-      ssid_str = "<hidden>";
-    ESP_LOGI(TAG, "Found AP: SSID='%s', RSSI=%d", ssid_str.c_str(), ap.rssi);
-
-    auto item = std::make_shared<WifiListItem>(list_view, items.size(), ssid_str, ap.rssi);
-    items.push_back(item);
+// Merges networks into the list without rebuilding it. Rows are kept sorted
+// by RSSI, strongest first, and an SSID appears once. Within one scan a row
+// keeps the strongest RSSI reported for it; the first report from the scan
+// replaces the cached value. Runs on the LVGL thread.
+void WifiListScreen::mergeNetworks(const std::vector<Network> &networks, bool fromScan) {
+  // Remember what has focus by object, since rows may move.
+  const int listSize = static_cast<int>(items.size());
+  lv_obj_t *focusedItem = focusedIndex >= 0 && focusedIndex < listSize ? items[focusedIndex]->getLvObj() : nullptr;
+  const int focusedButton = listSize > 0 && focusedIndex >= listSize ? focusedIndex - listSize : -1;
+  rotaryShowFocus(-1);
+
+  for (const auto &network : networks) {
+    if (fromScan) {
+      auto found = std::find_if(scanNetworks.begin(), scanNetworks.end(),
+                                [&](const Network &known) { return known.ssid == network.ssid; });
+      if (found == scanNetworks.end()) {
+        scanNetworks.push_back(network);
+      } else if (network.rssi > found->rssi) {
+        found->rssi = network.rssi;
+      }
+    }
+
+    std::shared_ptr<WifiListItem> item;
+    int from = findItem(network.ssid);
+    if (from >= 0) {
+      item = items[from];
+      if (item->isFresh() && network.rssi <= item->getRssi()) {
+        continue;
+      }
+      item->setSignalStrength(network.rssi);
+      items.erase(items.begin() + from);
+    } else {
+      item = std::make_shared<WifiListItem>(list_view, items.size(), network.ssid, network.rssi);
+      from = static_cast<int>(items.size());
+    }
+    if (fromScan) {
+      item->markFresh();
+    }
+
+    const auto to = std::find_if(items.begin(), items.end(), [&](const std::shared_ptr<WifiListItem> &other) {
+      return other->getRssi() < network.rssi;
+    });
+    const int toIndex = static_cast<int>(to - items.begin());
+    items.insert(to, item);
+    lv_obj_move_to_index(item->getLvObj(), toIndex);
+    for (int i = std::min(from, toIndex); i <= std::max(from, toIndex); ++i) {
+      items[i]->setIndex(i);
+    }
   }
 
-  ESP_LOGI(TAG, "Wi-Fi scan complete, list populated with %u entries", (unsigned)records.size());
+  if (focusedItem) {
+    focusedIndex = getItemIndex(focusedItem);
+  } else if (focusedButton >= 0) {
+    focusedIndex = static_cast<int>(items.size()) + focusedButton;
+  }
   updateFocusedState();
 }
 
-// Disables the Connect and Back buttons (used during scan).
-void WifiListScreen::disableButtons() {
-  if (isCleanedUp)
+// Called on the LVGL thread once the scan task is done. A complete scan
+// replaces the cache and removes rows for networks it did not see.
+void WifiListScreen::finishScan(bool complete) {
+  if (complete) {
+    cachedNetworks = scanNetworks;
+    std::stable_sort(cachedNetworks.begin(), cachedNetworks.end(),
+                     [](const Network &a, const Network &b) { return a.rssi > b.rssi; });
+    cachedAtUs = esp_timer_get_time();
+  }
+  scanNetworks.clear();
+  if (isCleanedUp) {
     return;
-  ESP_LOGI(TAG, "DisableButtons");
-  lv_obj_add_state(btn_connect, LV_STATE_DISABLED);
-  lv_obj_add_state(btn_back, LV_STATE_DISABLED);
+  }
+
+  if (complete) {
+    const int listSize = static_cast<int>(items.size());
+    lv_obj_t *focusedItem = focusedIndex >= 0 && focusedIndex < listSize ? items[focusedIndex]->getLvObj() : nullptr;
+    const int focusedButton = focusedIndex >= listSize ? focusedIndex - listSize : -1;
+    rotaryShowFocus(-1);
+    for (size_t i = 0; i < items.size();) {
+      if (items[i]->isFresh()) {
+        items[i]->setIndex(i);
+        ++i;
+        continue;
+      }
+      lv_obj_t *obj = items[i]->getLvObj();
+      ESP_LOGI(TAG, "No longer seen: %s", items[i]->getSsid().c_str());
+      if (obj == currentButton) {
+        currentButton = nullptr;
+        lv_obj_add_state(btn_connect, LV_STATE_DISABLED);
+      }
+      if (obj == focusedItem) {
+        focusedItem = nullptr;
+        focusedIndex = static_cast<int>(i);
+      }
+      lv_obj_delete(obj);
+      items.erase(items.begin() + i);
+    }
+    if (focusedItem) {
+      focusedIndex = getItemIndex(focusedItem);
+    } else if (focusedButton >= 0) {
+      focusedIndex = static_cast<int>(items.size()) + focusedButton;
+    }
+    updateFocusedState();
+  }
+
+  lv_label_set_text(lbl_title, "WiFi List");
+  lv_obj_add_flag(spinner, LV_OBJ_FLAG_HIDDEN);
+  ESP_LOGI(TAG, "Wi-Fi list holds %u networks", (unsigned)items.size());
 }
 
-// Re-enables the Connect and Back buttons after the scan completes.
-void WifiListScreen::enableButtons() {
-  if (isCleanedUp)
-    return;
-  ESP_LOGI(TAG, "EnableButtons");
-  lv_obj_clear_state(btn_back, LV_STATE_DISABLED);
+// Position of the row for `ssid` in the list, or -1.
+int WifiListScreen::findItem(const std::string &ssid) const {
+  for (size_t i = 0; i < items.size(); ++i) {
+    if (items[i]->getSsid() == ssid) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
 }
 
 // Validates that a network is selected and opens WifiConnectScreen.
@@ -262,11 +405,9 @@ void WifiListScreen::button_listitem_click_event_callback(lv_event_t *e) {
       }
     }
 
-    for (size_t idx = 0; idx < items.size(); ++idx) {
-      if (items[idx]->getLvObj() == currentButton) {
-        focusedIndex = static_cast<int>(idx);
-        break;
-      }
+    const int idx = getItemIndex(currentButton);
+    if (idx >= 0 && static_cast<size_t>(idx) < items.size() && items[idx]->getLvObj() == currentButton) {
+      focusedIndex = idx;
     }
     updateFocusedState();
   }
@@ -291,21 +432,24 @@ void WifiListScreen::moveFocus(int direction) {
   updateFocusedState();
 }
 
-void WifiListScreen::updateFocusedState() {
+void WifiListScreen::updateFocusedState() { rotaryShowFocus(focusedIndex); }
+
+// Focus order: list items, then Back, then Connect.
+lv_obj_t *WifiListScreen::rotaryFocusObject(int index) const {
   const int listSize = static_cast<int>(items.size());
-  for (int i = 0; i < listSize; ++i) {
-    auto obj = items[i]->getLvObj();
-    if (!obj) {
-      continue;
-    }
-    applyFocusOutline(obj, i == focusedIndex);
-    if (i == focusedIndex) {
-      lv_obj_scroll_to_view(obj, LV_ANIM_OFF);
-    }
+  if (index < 0) {
+    return nullptr;
   }
-
-  applyFocusOutline(btn_back, focusedIndex == listSize);
-  applyFocusOutline(btn_connect, focusedIndex == listSize + 1);
+  if (index < listSize) {
+    return items[index]->getLvObj();
+  }
+  if (index == listSize) {
+    return btn_back;
+  }
+  if (index == listSize + 1) {
+    return btn_connect;
+  }
+  return nullptr;
 }
 
 void WifiListScreen::rotaryMoveFocus(int direction) { moveFocus(direction); }
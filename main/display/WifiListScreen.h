@@ -2,6 +2,7 @@
 #include "WifiListItem.h"
 #include <esp_wifi.h>
 #include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -57,10 +58,17 @@ private:
   bool rotaryInputEnabled() const override { return !isCleanedUp; }
   void rotaryMoveFocus(int direction) override;
   void rotaryActivateFocused() override;
+  lv_obj_t *rotaryFocusObject(int index) const override;
 
   void moveFocus(int direction);
   void updateFocusedState();
 
+  // One network as shown in the list: SSID and strongest RSSI seen for it.
+  struct Network {
+    std::string ssid;
+    int8_t rssi;
+  };
+
   int focusedIndex = -1;
   TaskHandle_t scanTaskHandle = 0;
   bool isCleanedUp = false;
@@ -73,10 +81,17 @@ private:
 
   std::vector<std::shared_ptr<WifiListItem>> items;
 
+  // Results of the last complete scan, strongest first, and when it finished.
+  // Shown as soon as the screen opens. Only touched on the LVGL thread.
+  std::vector<Network> cachedNetworks;
+  int64_t cachedAtUs = 0;
+  // Networks found so far by the running scan, deduplicated.
+  std::vector<Network> scanNetworks;
+
   void scanWifiTask();
-  void populateList(const std::vector<wifi_ap_record_t> &records);
-  void disableButtons();
-  void enableButtons();
+  void mergeNetworks(const std::vector<Network> &networks, bool fromScan);
+  void finishScan(bool complete);
+  int findItem(const std::string &ssid) const;
   std::shared_ptr<WifiListItem> getCurrentCheckedItem(lv_obj_t *bn);
 };
 
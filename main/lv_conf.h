@@ -54,8 +54,8 @@
     #define LV_MEM_CUSTOM_REALLOC realloc
 #endif     /*LV_MEM_CUSTOM*/
 
-/*Keep LVGL in single-thread mode; `lv_timer_handler()` runs in app_main loop*/
-#define LV_USE_OS   LV_OS_NONE
+/*FreeRTOS locking; `lv_timer_handler()` runs in the dedicated render task (display/LvglTask)*/
+#define LV_USE_OS   LV_OS_FREERTOS
 
 /*Number of the intermediate memory buffer used during rendering and other internal processing mechanisms.
  *You will see an error log message if there wasn't enough buffers. */
@@ -1,13 +1,19 @@
 #include "ESP_Millis.h"
 #include "LGFX_ILI9488_S3.hpp"
+#include "connection/wifi_control.h"
 #include "definitions.h"
+#include "display/ConnectDCC.h"
 #include "display/DisplayManager.h"
 #include "display/FirstScreen.h"
+#include "display/LvglTask.h"
 #include "display/ManualCalibration.h"
 #include "display/MessageBox.h"
+#include "display/UiBenchmark.h"
 #include "display/WifiConnectScreen.h"
 #include "ui/LvglTheme.h"
 #include "utilities/RotaryEncoder.h"
+#include "utilities/StartupSequencer.h"
+#include "utilities/TouchInput.h"
 #include "utilities/WifiHandler.h"
 #include <LovyanGFX.hpp>
 #include <atomic>
@@ -15,6 +21,7 @@
 #include <esp_event.h>
 #include <esp_log.h>
 #include <esp_netif.h>
+#include <esp_spiffs.h>
 #include <esp_task_wdt.h>
 #include <esp_timer.h>
 #include <esp_wifi.h>
@@ -39,31 +46,89 @@ static lv_display_t *lvgl_disp = nullptr;
 // --- Display sleep tracking ---
 static std::atomic_bool displaySleeping{false};
 constexpr uint32_t INACTIVITY_TIMEOUT_MS = 2 * 60 * 1000; // 2 minutes
+constexpr uint32_t FADE_OUT_MS = 800;
+constexpr uint32_t FADE_IN_MS = 250;
+static bool renderingSuspended = false; // only touched with the LVGL lock held
 
 // --- FADE EFFECT ---
-void fade_brightness(uint8_t from, uint8_t to, int duration_ms) {
-  const int steps = 25; // smoother
-  float step_time = (float)duration_ms / steps;
-  float delta = (to - from) / (float)steps;
-
-  for (int i = 0; i <= steps; ++i) {
-    uint8_t val = static_cast<uint8_t>(from + delta * i);
-    DisplayManager::gfx.setBrightness(val);
-    vTaskDelay(pdMS_TO_TICKS(step_time));
+// Stable address used as the lv_anim variable so a running fade can be
+// cancelled when the direction changes.
+static uint8_t fadeAnimVar = 0;
+
+// lv_anim exec callback: writes the animated value to the backlight. Only the
+// LEDC duty changes, so this never touches the SPI bus.
+static void fade_brightness_exec(void *, int32_t value) {
+  DisplayManager::gfx.setBrightness(static_cast<uint8_t>(value));
+}
+
+// Starts a non-blocking backlight fade from the current level to `to`,
+// replacing any fade still in progress. completed_cb runs on the LVGL task.
+void fade_brightness(uint8_t to, uint32_t duration_ms, lv_anim_completed_cb_t completed_cb) {
+  lv_anim_delete(&fadeAnimVar, fade_brightness_exec);
+
+  lv_anim_t anim;
+  lv_anim_init(&anim);
+  lv_anim_set_var(&anim, &fadeAnimVar);
+  lv_anim_set_exec_cb(&anim, fade_brightness_exec);
+  lv_anim_set_values(&anim, DisplayManager::gfx.getBrightness(), to);
+  lv_anim_set_duration(&anim, duration_ms);
+  lv_anim_set_completed_cb(&anim, completed_cb);
+  lv_anim_start(&anim);
+}
+
+// --- Render suspension ---
+// Fade-out completion: stops invalidation, the display refresh timer and all
+// animations so nothing is drawn while the backlight is off. Only input
+// polling keeps the render task waking.
+static void suspend_rendering(lv_anim_t *) {
+  if (!displaySleeping.load()) {
+    return;
+  }
+  lv_display_enable_invalidation(lvgl_disp, false);
+  lv_timer_pause(lv_display_get_refr_timer(lvgl_disp));
+  lv_timer_pause(lv_anim_get_timer());
+  renderingSuspended = true;
+  display::LvglTask::instance()->takeStats(); // start the asleep sample
+  ESP_LOGI(TAG, "Rendering suspended");
+}
+
+// Re-enables rendering and invalidates the whole screen, since changes made
+// while invalidation was off were not tracked. Logs the render-task load
+// measured while asleep.
+static void resume_rendering() {
+  if (!renderingSuspended) {
+    return;
+  }
+  renderingSuspended = false;
+  lv_timer_resume(lv_anim_get_timer());
+  lv_timer_resume(lv_display_get_refr_timer(lvgl_disp));
+  lv_display_enable_invalidation(lvgl_disp, true);
+  lv_obj_invalidate(lv_display_get_screen_active(lvgl_disp));
+
+  auto stats = display::LvglTask::instance()->takeStats();
+  if (stats.elapsedUs > 0) {
+    ESP_LOGI(TAG, "Asleep %llu ms: %lu render wakeups, LVGL busy %llu us (%llu.%02llu%% CPU)",
+             stats.elapsedUs / 1000ULL, static_cast<unsigned long>(stats.wakeups), stats.busyUs,
+             stats.busyUs * 100ULL / stats.elapsedUs, (stats.busyUs * 10000ULL / stats.elapsedUs) % 100ULL);
   }
 }
 
 // --- Display control helpers ---
+// Both directions return immediately; the fade runs as an lv_anim on the
+// render task so input keeps being processed throughout.
 void display_set_sleep(bool sleep) {
   if (sleep) {
     ESP_LOGI(TAG, "Display sleeping...");
-    fade_brightness(255, 0, 800); // fade out
+    fade_brightness(0, FADE_OUT_MS, suspend_rendering);
   } else {
     ESP_LOGI(TAG, "Display waking...");
-    fade_brightness(0, 255, 600); // fade in
+    resume_rendering();
+    fade_brightness(255, FADE_IN_MS, nullptr);
   }
 }
 
+// Wakes the panel on user input. Must be called with the LVGL lock held (the
+// touch read callback and the rotary activity callback both satisfy this).
 void wake_display_if_sleeping(lv_display_t *disp) {
   if (disp == nullptr) {
     return;
@@ -78,11 +143,35 @@ void wake_display_if_sleeping(lv_display_t *disp) {
   }
 }
 
+// --- Inactivity check (using LVGL's built-in tracking) ---
+// Runs on the render task after every timer pass with the LVGL lock held.
+void check_display_inactivity(void *) {
+  if (!displaySleeping.load()) {
+    uint32_t inactive_ms = lv_display_get_inactive_time(lvgl_disp);
+    if (inactive_ms > INACTIVITY_TIMEOUT_MS) {
+      displaySleeping.store(true);
+      display_set_sleep(true);
+    }
+  }
+}
+
 // --- Touchpad Read Callback ---
+// Drains filtered points queued by utilities::TouchInput; never touches the
+// SPI bus. Queued points are replayed one per read via continue_reading so
+// none are lost between LVGL input periods.
 void my_touchpad_read(lv_indev_t *indev_driver, lv_indev_data_t *data) {
-  int32_t x = 0;
-  int32_t y = 0;
-  bool touched = DisplayManager::gfx.getTouch(&x, &y);
+  static lv_indev_state_t lastState = LV_INDEV_STATE_RELEASED;
+  static lv_point_t lastPoint = {0, 0};
+  static bool swallowUntilRelease = false;
+
+  utilities::TouchInput::TouchPoint touch;
+  bool more = false;
+  if (!utilities::TouchInput::instance()->readPoint(&touch, &more)) {
+    data->point = lastPoint;
+    data->state = swallowUntilRelease ? LV_INDEV_STATE_RELEASED : lastState;
+    return;
+  }
+  data->continue_reading = more;
 
   // Adjust these to match your hardware / rotation
   // Try FLIP_Y = true to fix upside-down touches
@@ -90,55 +179,83 @@ void my_touchpad_read(lv_indev_t *indev_driver, lv_indev_data_t *data) {
   constexpr bool FLIP_Y = true;
   constexpr bool SWAP_XY = false;
 
-  if (touched) {
-    int32_t tx = x;
-    int32_t ty = y;
+  int32_t tx = touch.x;
+  int32_t ty = touch.y;
 
-    if (SWAP_XY)
-      std::swap(tx, ty);
-    if (FLIP_X)
-      tx = static_cast<int32_t>(DisplayManager::gfx.screenWidth - tx - 1);
-    if (FLIP_Y)
-      ty = static_cast<int32_t>(DisplayManager::gfx.screenHeight - ty - 1);
+  if (SWAP_XY)
+    std::swap(tx, ty);
+  if (FLIP_X)
+    tx = static_cast<int32_t>(DisplayManager::gfx.screenWidth - tx - 1);
+  if (FLIP_Y)
+    ty = static_cast<int32_t>(DisplayManager::gfx.screenHeight - ty - 1);
 
-    data->point.x = tx;
-    data->point.y = ty;
-    data->state = LV_INDEV_STATE_PRESSED;
+  lastPoint.x = tx;
+  lastPoint.y = ty;
+  lastState = touch.pressed ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
+  data->point = lastPoint;
+  data->state = lastState;
 
+  if (touch.pressed) {
     lv_display_trigger_activity(lvgl_disp); // reset inactivity timer on touch
 
+    // The press that wakes the panel is not delivered to the UI.
     if (displaySleeping.load()) {
       wake_display_if_sleeping(lvgl_disp);
-      data->state = LV_INDEV_STATE_RELEASED;
+      swallowUntilRelease = true;
     }
+    ESP_LOGD(TAG, "Touch latency %lld us", esp_timer_get_time() - touch.timestampUs);
   } else {
+    swallowUntilRelease = false;
+  }
+
+  if (swallowUntilRelease) {
     data->state = LV_INDEV_STATE_RELEASED;
   }
 }
 
 // --- App setup ---
+// Boot runs as StartupSequencer steps: the radio, the panel and the LVGL core
+// come up concurrently, and the Wi-Fi connect starts as soon as the UI is
+// listening for its messages.
 auto manualCalibration = display::ManualCalibration::instance();
 auto firstScreen = display::FirstScreen::instance();
 
-void setup() {
-  ESP_LOGI(TAG, "ES32 DCC Controller");
+static display::calibrateState calibrated = display::calibrateState::notCalibrated;
+static bool lvglReady = false; // display and input devices were created
+static bool uiStarted = false; // the first screen is shown and the render task runs
 
-  display::calibrateState calibrated = manualCalibration->loadCalibrationFromNVS();
+// Reads the touch calibration from NVS.
+static void step_calibration() { calibrated = manualCalibration->loadCalibrationFromNVS(); }
 
+// Brings up the panel over SPI and turns the backlight on.
+static void step_panel() {
   ESP_LOGI(TAG, "Init Display");
-
   DisplayManager::gfx.begin();
   DisplayManager::gfx.setRotation(0);
   DisplayManager::gfx.fillScreen(TFT_BLACK);
   DisplayManager::gfx.setBrightness(255); // ensure display on at start
+}
+
+// Initialises the LVGL core, which the theme and display steps need.
+static void step_lvgl() {
+  lv_init();
+  lv_tick_set_cb(lv_tick_ms_cb);
+}
+
+// Builds the theme's styles.
+static void step_theme() {
+  display::LvglLock lvglLock;
+  auto theme = std::make_shared<ui::LvglTheme>("Default");
+  ui::LvglTheme::setActive(theme);
+}
 
+// Creates the LVGL display on the panel and the touch and rotary inputs. Skipped
+// while calibrating: step_ui then owns the touch controller on the shared bus.
+static void step_lvgl_display() {
   if (calibrated == display::calibrateState::calibrate) {
-    manualCalibration->calibrate();
     return;
   }
-
-  lv_init();
-  lv_tick_set_cb(lv_tick_ms_cb);
+  display::LvglLock lvglLock;
   auto buffer_size = DisplayManager::bufferSize();
   lv_color_t *buf1 = new lv_color_t[buffer_size];
   lv_color_t *buf2 = new lv_color_t[buffer_size];
@@ -160,9 +277,11 @@ void setup() {
   lv_indev_set_display(indev, lvgl_disp);
   lv_indev_set_read_cb(indev, my_touchpad_read);
   ESP_LOGI(TAG, "Touch indev registered: %p", indev);
-
-  auto theme = std::make_shared<ui::LvglTheme>("Default");
-  ui::LvglTheme::setActive(theme);
+#if CONFIG_TOUCH_PENIRQ_ENABLE
+  utilities::TouchInput::instance()->init(indev, static_cast<gpio_num_t>(CONFIG_TOUCH_GPIO_PENIRQ));
+#else
+  utilities::TouchInput::instance()->init(indev);
+#endif
 
 #if CONFIG_ROTARY_ENCODER_ENABLE
   utilities::RotaryEncoder::instance()->init(
@@ -176,17 +295,31 @@ void setup() {
   );
   utilities::RotaryEncoder::instance()->setActivityCallback(
       [](void *disp) {
-        lv_async_call(
-            [](void *d) {
-              auto *display = static_cast<lv_display_t *>(d);
-              wake_display_if_sleeping(display);
-              lv_display_trigger_activity(display);
-            },
-            disp);
+        auto *display = static_cast<lv_display_t *>(disp);
+        display::LvglLock lock;
+        wake_display_if_sleeping(display);
+        lv_display_trigger_activity(display);
       },
       lvgl_disp);
 #endif
+  lvglReady = true;
+}
+
+// Starts the Wi-Fi driver. Connecting waits for step_connect.
+static void step_radio() { utilities::WifiHandler::instance()->init_wifi(); }
+
+// Subscribes the global handlers, shows the first screen (or runs the touch
+// calibration) and starts the render task.
+static void step_ui() {
+  if (calibrated == display::calibrateState::calibrate) {
+    manualCalibration->calibrate();
+    return;
+  }
+  if (!lvglReady) {
+    return;
+  }
 
+  display::LvglLock lvglLock;
   // Global handlers: show a message and return to the home screen once confirmed.
   lv_msg_subscribe(
       MSG_WIFI_FAILED,
@@ -217,15 +350,29 @@ void setup() {
       },
       nullptr);
 
+#if CONFIG_DCC_WARM_STANDBY
+  // Opens the session to the saved DCC server whenever Wi-Fi comes up, so it
+  // is connected and has its lists by the time a screen asks for it.
+  lv_msg_subscribe(
+      MSG_WIFI_CONNECTED,
+      [](lv_msg_t *) {
+        utilities::WithrottleDevice savedDevice;
+        if (!display::ConnectDCCScreen::loadSavedConnection(savedDevice)) {
+          return;
+        }
+        const std::string ip = savedDevice.ipString();
+        ESP_LOGI(TAG, "Warm standby: connecting to %s:%u", ip.c_str(), savedDevice.port);
+        utilities::WifiControl::instance()->startConnectToServer(ip.c_str(), savedDevice.port, true);
+      },
+      nullptr);
+#endif
+
   switch (calibrated) {
   case display::calibrateState::calibrated:
-    xTaskCreate(
-        [](void *parameters) {
-          vTaskDelay(pdMS_TO_TICKS(2000));
-          utilities::WifiHandler::instance()->init_wifi();
-          vTaskDelete(nullptr);
-        },
-        "wifi_init_del", 4096, nullptr, tskIDLE_PRIORITY + 1, nullptr);
+#if CONFIG_UI_BENCHMARK
+    // Runs before Wi-Fi connects so network traffic does not skew the numbers.
+    display::UiBenchmark::instance()->run();
+#endif
     firstScreen->showScreen();
     break;
   case display::calibrateState::notCalibrated:
@@ -238,9 +385,39 @@ void setup() {
     break;
   }
 
+  auto lvglTask = display::LvglTask::instance();
+  lvglTask->setLoopCallback(check_display_inactivity, nullptr);
+  if (!lvglTask->start()) {
+    ESP_LOGE(TAG, "LVGL render task failed to start");
+    return;
+  }
+  uiStarted = true;
   ESP_LOGI(TAG, "Setup complete. UI should be visible.");
 }
 
+// Connects with the saved credentials. Runs once the first screen is shown, so
+// it is subscribed to the Wi-Fi messages; not while calibrating.
+static void step_connect() {
+  if (uiStarted && calibrated == display::calibrateState::calibrated) {
+    utilities::WifiHandler::instance()->loadAndConnect();
+  }
+}
+
+// Mounts the spiffs partition at /spiffs for data files such as the track
+// diagram layout. A missing or unformatted partition is only logged.
+static void mount_storage() {
+  esp_vfs_spiffs_conf_t conf = {
+      .base_path = "/spiffs",
+      .partition_label = nullptr,
+      .max_files = 4,
+      .format_if_mount_failed = false,
+  };
+  esp_err_t ret = esp_vfs_spiffs_register(&conf);
+  if (ret != ESP_OK) {
+    ESP_LOGW(TAG, "spiffs not mounted: %s", esp_err_to_name(ret));
+  }
+}
+
 extern "C" void app_main() {
   esp_err_t ret = nvs_flash_init();
   if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
@@ -249,20 +426,33 @@ extern "C" void app_main() {
   } else {
     ESP_ERROR_CHECK(ret);
   }
+  ESP_LOGI(TAG, "ES32 DCC Controller");
 
-  setup();
-
-  while (true) {
-    lv_timer_handler();
-    vTaskDelay(pdMS_TO_TICKS(10));
-
-    // --- Inactivity check (using LVGL's built-in tracking) ---
-    if (!displaySleeping.load()) {
-      uint32_t inactive_ms = lv_display_get_inactive_time(lvgl_disp);
-      if (inactive_ms > INACTIVITY_TIMEOUT_MS) {
-        display_set_sleep(true);
-        displaySleeping.store(true);
-      }
-    }
-  }
+  // The singletons' instance() is not thread-safe; create the ones the steps
+  // share before the steps run concurrently.
+  display::LvglTask::instance();
+  utilities::TouchInput::instance();
+  utilities::RotaryEncoder::instance();
+  utilities::WifiHandler::instance();
+
+  using utilities::StartupSequencer;
+  StartupSequencer startup;
+  startup.add("storage", mount_storage);
+  const int calibration = startup.add("calibration", step_calibration);
+  const int panel = startup.add("panel", step_panel);
+  const int lvgl = startup.add("lvgl", step_lvgl);
+  const int radio = startup.add("radio", step_radio);
+  const int theme = startup.add("theme", step_theme, StartupSequencer::after(lvgl));
+  const int lvglDisplay = startup.add("lvgl_display", step_lvgl_display,
+                                      StartupSequencer::after(calibration) | StartupSequencer::after(lvgl) |
+                                          StartupSequencer::after(panel));
+  const int ui = startup.add("ui", step_ui,
+                             StartupSequencer::after(calibration) | StartupSequencer::after(theme) |
+                                 StartupSequencer::after(lvglDisplay),
+                             CONFIG_ESP_MAIN_TASK_STACK_SIZE);
+  startup.add("connect", step_connect, StartupSequencer::after(radio) | StartupSequencer::after(ui));
+
+  // Rendering continues on the LVGL render task; app_main returns and frees
+  // the main task stack.
+  startup.run();
 }
@@ -112,6 +112,27 @@ public:
     return *this;
   }
 
+  LvglStyle &outlineColor(lv_color_t color) {
+    outline_color_ = color;
+    has_outline_color_ = true;
+    lv_style_set_outline_color(&style_, color);
+    return *this;
+  }
+
+  LvglStyle &outlineWidth(int32_t width) {
+    outline_width_ = width;
+    has_outline_width_ = true;
+    lv_style_set_outline_width(&style_, width);
+    return *this;
+  }
+
+  LvglStyle &outlinePad(int32_t pad) {
+    outline_pad_ = pad;
+    has_outline_pad_ = true;
+    lv_style_set_outline_pad(&style_, pad);
+    return *this;
+  }
+
   //
   // Apply to LVGL object
   //
@@ -145,6 +166,12 @@ private:
       shadowColor(other.shadow_color_);
     if (other.has_shadow_width_)
       shadowWidth(other.shadow_width_);
+    if (other.has_outline_color_)
+      outlineColor(other.outline_color_);
+    if (other.has_outline_width_)
+      outlineWidth(other.outline_width_);
+    if (other.has_outline_pad_)
+      outlinePad(other.outline_pad_);
   }
 
   lv_style_t style_{};
@@ -155,11 +182,14 @@ private:
   lv_color_t text_color_;
   lv_color_t border_color_;
   lv_color_t shadow_color_;
+  lv_color_t outline_color_;
   const lv_font_t *font_ = nullptr;
   int32_t border_width_ = 0;
   int32_t radius_ = 0;
   int32_t pad_all_ = 0;
   int32_t shadow_width_ = 0;
+  int32_t outline_width_ = 0;
+  int32_t outline_pad_ = 0;
   lv_opa_t bg_opa_ = LV_OPA_COVER;
 
   bool has_bg_color_ = false;
@@ -172,6 +202,9 @@ private:
   bool has_pad_all_ = false;
   bool has_shadow_width_ = false;
   bool has_bg_opa_ = false;
+  bool has_outline_color_ = false;
+  bool has_outline_width_ = false;
+  bool has_outline_pad_ = false;
 };
 
 } // namespace ui
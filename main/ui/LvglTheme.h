@@ -119,6 +119,14 @@ private:
 
     defineStyle("label.muted").textColor(palette_.text).textFont(fonts_.small);
 
+    defineStyle("label.overlay")
+        .bgColor(palette_.black)
+        .bgOpacity(LV_OPA_70)
+        .textColor(palette_.white)
+        .textFont(fonts_.small)
+        .radius(metrics_.radius)
+        .padAll(metrics_.padding / 2);
+
     // ---- CHECKBOX ----
     defineStyle("checkbox.main").textColor(palette_.text).padAll(metrics_.padding / 2);
 
@@ -137,6 +145,11 @@ private:
 
     defineStyle("screen.main").bgColor(palette_.background).textColor(palette_.text);
 
+    // Rotary focus ring, bound to LV_STATE_FOCUSED by the widget factories. An
+    // inset outline does not change the widget's size, so moving focus only
+    // redraws the two affected widgets instead of relaying out the list.
+    defineStyle("focus.outline").outlineColor(lv_color_hex(0xFF6B00)).outlineWidth(2).outlinePad(-2);
+
     defineStyle("list.main").bgColor(palette_.background).borderWidth(2).padAll(6);
 
     defineStyle("wifi.item")
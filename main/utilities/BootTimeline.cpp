@@ -0,0 +1,66 @@
+/**
+ * @file BootTimeline.cpp
+ * @brief Boot milestones: first frame, Wi-Fi up, server connected, lists.
+ *
+ * Milestones are marked from the flush callback, the Wi-Fi event handler and
+ * the DCC protocol task. A mark after the first is a single relaxed load, so
+ * the hooks can stay on those hot paths.
+ */
+#include "BootTimeline.h"
+
+#include <cinttypes>
+#include <cstdio>
+#include <esp_log.h>
+#include <esp_timer.h>
+
+namespace utilities {
+
+static const char *TAG = "BOOT";
+
+std::atomic<int64_t> BootTimeline::times_[static_cast<size_t>(Milestone::Count)];
+
+namespace {
+const char *const kMilestoneNames[] = {"first frame", "wifi up", "server connected", "lists received"};
+} // namespace
+
+// Records the current time for `milestone` unless it was reached before.
+void BootTimeline::mark(Milestone milestone) {
+  auto &slot = times_[static_cast<size_t>(milestone)];
+  if (slot.load(std::memory_order_relaxed) != 0) {
+    return;
+  }
+  int64_t expected = 0;
+  const int64_t now = esp_timer_get_time();
+  if (!slot.compare_exchange_strong(expected, now)) {
+    return;
+  }
+  ESP_LOGI(TAG, "%s at %" PRId64 " ms", kMilestoneNames[static_cast<size_t>(milestone)], now / 1000);
+
+  if (milestone == Milestone::ListsReceived) {
+    char text[128];
+    format(text, sizeof(text));
+    ESP_LOGI(TAG, "Timeline: %s", text);
+  }
+}
+
+// Writes "frame 812 wifi 1630 dcc 2410 lists 3050 ms" into buf, with "-" for
+// milestones not reached yet. Returns the length written.
+size_t BootTimeline::format(char *buf, size_t size) {
+  static const char *const kShortNames[] = {"frame", "wifi", "dcc", "lists"};
+  size_t len = 0;
+  for (size_t i = 0; i < static_cast<size_t>(Milestone::Count) && len < size; ++i) {
+    const int64_t us = times_[i].load(std::memory_order_relaxed);
+    const int written = us != 0 ? snprintf(buf + len, size - len, "%s %" PRId64 " ", kShortNames[i], us / 1000)
+                                : snprintf(buf + len, size - len, "%s - ", kShortNames[i]);
+    if (written < 0) {
+      break;
+    }
+    len += static_cast<size_t>(written);
+  }
+  if (len < size) {
+    len += snprintf(buf + len, size - len, "ms");
+  }
+  return len < size ? len : size - 1;
+}
+
+} // namespace utilities
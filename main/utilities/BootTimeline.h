@@ -0,0 +1,34 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace utilities {
+
+// Time from power-on to each boot milestone, taken from esp_timer (which
+// starts with the application, a few hundred milliseconds after reset). Each
+// milestone is recorded once, by whichever task reaches it, and logged as it
+// happens; the whole timeline is logged again when the lists arrive.
+// Thread-safe.
+class BootTimeline {
+public:
+  enum class Milestone : uint8_t {
+    FirstFrame,
+    WifiUp,
+    ServerConnected,
+    ListsReceived,
+    Count,
+  };
+
+  static void mark(Milestone milestone);
+  static int64_t timeUs(Milestone milestone) {
+    return times_[static_cast<size_t>(milestone)].load(std::memory_order_relaxed);
+  }
+  static size_t format(char *buf, size_t size);
+
+private:
+  static std::atomic<int64_t> times_[static_cast<size_t>(Milestone::Count)];
+};
+
+} // namespace utilities
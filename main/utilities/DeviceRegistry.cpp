@@ -0,0 +1,155 @@
+/**
+ * @file DeviceRegistry.cpp
+ * @brief Versioned registry of discovered WiThrottle servers.
+ *
+ * The published list is copy-on-write: every add, change or removal builds a
+ * new vector, swaps it in under the mutex and bumps the version. Answers that
+ * only confirm a known server touch its aging entry, which is kept outside
+ * the published list, so the steady stream of mDNS refreshes neither copies
+ * the list nor wakes the UI. Devices are keyed by IPv4 address; goodbyes and
+ * partial answers that carry no address are matched by instance name.
+ */
+#include "DeviceRegistry.h"
+
+#include <lwip/ip4_addr.h>
+
+namespace utilities {
+
+// Dotted-decimal form of the address, or an empty string when unknown.
+std::string WithrottleDevice::ipString() const {
+  if (ipv4 == 0) {
+    return {};
+  }
+  ip4_addr_t addr;
+  addr.addr = ipv4;
+  char buf[16];
+  ip4addr_ntoa_r(&addr, buf, sizeof(buf));
+  return buf;
+}
+
+// Parses a dotted-decimal address. Leaves the address unknown and returns
+// false if it does not parse.
+bool WithrottleDevice::setIp(const char *dotted) {
+  ip4_addr_t addr;
+  if (!dotted || !ip4addr_aton(dotted, &addr)) {
+    ipv4 = 0;
+    return false;
+  }
+  ipv4 = addr.addr;
+  return true;
+}
+
+DeviceRegistry::DeviceRegistry()
+    : mutex_(xSemaphoreCreateMutex()), devices_(std::make_shared<const std::vector<WithrottleDevice>>()) {}
+
+// Records an answer for `device`, valid for `ttlSeconds`. A new server is
+// added only once its address is known; for a known one the details are
+// updated if they differ.
+DeviceRegistry::Change DeviceRegistry::upsert(WithrottleDevice device, uint32_t ttlSeconds, int64_t nowUs) {
+  Change change = Change::None;
+  xSemaphoreTake(mutex_, portMAX_DELAY);
+  const int index = indexOf(device);
+  if (index >= 0) {
+    aging_[index] = Aging{ttlSeconds, nowUs, false};
+    const WithrottleDevice &known = (*devices_)[index];
+    if (device.ipv4 != 0 && (device.instance != known.instance || device.hostname != known.hostname ||
+                             device.port != known.port || device.txt != known.txt)) {
+      std::vector<WithrottleDevice> next = *devices_;
+      next[index] = std::move(device);
+      publish(std::move(next));
+      change = Change::Changed;
+    }
+  } else if (device.ipv4 != 0) {
+    std::vector<WithrottleDevice> next = *devices_;
+    next.push_back(std::move(device));
+    aging_.push_back(Aging{ttlSeconds, nowUs, false});
+    publish(std::move(next));
+    change = Change::Added;
+  }
+  xSemaphoreGive(mutex_);
+  return change;
+}
+
+// Removes the server matching `device`, e.g. after an mDNS goodbye.
+DeviceRegistry::Change DeviceRegistry::remove(const WithrottleDevice &device) {
+  Change change = Change::None;
+  xSemaphoreTake(mutex_, portMAX_DELAY);
+  const int index = indexOf(device);
+  if (index >= 0) {
+    std::vector<WithrottleDevice> next = *devices_;
+    next.erase(next.begin() + index);
+    aging_.erase(aging_.begin() + index);
+    publish(std::move(next));
+    change = Change::Removed;
+  }
+  xSemaphoreGive(mutex_);
+  return change;
+}
+
+// Drops servers whose TTL ran out without a fresh answer and adds their count
+// to *expiredCount. Returns true when a server has passed `refreshPercent` of
+// its TTL, once per answer, so the caller can query it again before it expires.
+bool DeviceRegistry::expire(int64_t nowUs, int refreshPercent, size_t *expiredCount) {
+  bool refresh = false;
+  size_t expired = 0;
+  xSemaphoreTake(mutex_, portMAX_DELAY);
+  std::vector<bool> keep(aging_.size(), true);
+  for (size_t i = 0; i < aging_.size(); ++i) {
+    Aging &aging = aging_[i];
+    const int64_t age = nowUs - aging.lastSeenUs;
+    const int64_t ttlUs = static_cast<int64_t>(aging.ttlSeconds) * 1000000;
+    if (age >= ttlUs) {
+      keep[i] = false;
+      ++expired;
+    } else if (!aging.refreshSent && age >= ttlUs * refreshPercent / 100) {
+      aging.refreshSent = true;
+      refresh = true;
+    }
+  }
+  if (expired > 0) {
+    std::vector<WithrottleDevice> next;
+    std::vector<Aging> nextAging;
+    for (size_t i = 0; i < keep.size(); ++i) {
+      if (keep[i]) {
+        next.push_back((*devices_)[i]);
+        nextAging.push_back(aging_[i]);
+      }
+    }
+    aging_ = std::move(nextAging);
+    publish(std::move(next));
+  }
+  xSemaphoreGive(mutex_);
+  if (expiredCount) {
+    *expiredCount += expired;
+  }
+  return refresh;
+}
+
+// The current list. Holding the pointer keeps it valid; later changes publish
+// a new list rather than modifying this one.
+DeviceRegistry::Snapshot DeviceRegistry::snapshot() const {
+  xSemaphoreTake(mutex_, portMAX_DELAY);
+  Snapshot current = devices_;
+  xSemaphoreGive(mutex_);
+  return current;
+}
+
+// Position of the server matching `device` in the published list, or -1.
+// Called with the mutex held.
+int DeviceRegistry::indexOf(const WithrottleDevice &device) const {
+  for (size_t i = 0; i < devices_->size(); ++i) {
+    const WithrottleDevice &known = (*devices_)[i];
+    if (device.ipv4 != 0 ? known.ipv4 == device.ipv4 : !device.instance.empty() && known.instance == device.instance) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+// Swaps in a new list. Called with the mutex held.
+void DeviceRegistry::publish(std::vector<WithrottleDevice> devices) {
+  devices_ = std::make_shared<const std::vector<WithrottleDevice>>(std::move(devices));
+  version_.fetch_add(1, std::memory_order_release);
+}
+
+} // namespace utilities
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+namespace utilities {
+
+// A WiThrottle server, as discovered by mDNS or saved in NVS.
+struct WithrottleDevice {
+  std::string instance;
+  std::string hostname;
+  uint32_t ipv4 = 0; // network byte order, 0 when unknown
+  uint16_t port = 0;
+  std::vector<std::pair<std::string, std::string>> txt; // key/value pairs in the order received
+
+  bool hasAddress() const { return ipv4 != 0 && port != 0; }
+  bool sameEndpoint(const WithrottleDevice &other) const { return ipv4 == other.ipv4 && port == other.port; }
+  std::string ipString() const;
+  bool setIp(const char *dotted);
+};
+
+// Servers currently announced on the network. Writers (the mdns and aging
+// tasks) publish a new immutable list and bump the version only when
+// something visible changes; readers take the current list as a shared
+// pointer, so nothing is copied and the list stays valid while they use it.
+// Thread-safe.
+class DeviceRegistry {
+public:
+  using Snapshot = std::shared_ptr<const std::vector<WithrottleDevice>>;
+
+  enum class Change {
+    None,
+    Added,
+    Changed,
+    Removed,
+  };
+
+  DeviceRegistry();
+  DeviceRegistry(const DeviceRegistry &) = delete;
+  DeviceRegistry &operator=(const DeviceRegistry &) = delete;
+
+  Change upsert(WithrottleDevice device, uint32_t ttlSeconds, int64_t nowUs);
+  Change remove(const WithrottleDevice &device);
+  bool expire(int64_t nowUs, int refreshPercent, size_t *expiredCount);
+
+  Snapshot snapshot() const;
+  uint32_t version() const { return version_.load(std::memory_order_acquire); }
+
+private:
+  // When each published device was last heard from; parallel to *devices_.
+  struct Aging {
+    uint32_t ttlSeconds = 0;
+    int64_t lastSeenUs = 0;
+    bool refreshSent = false; // a refresh query has been asked for since the last answer
+  };
+
+  int indexOf(const WithrottleDevice &device) const;
+  void publish(std::vector<WithrottleDevice> devices);
+
+  SemaphoreHandle_t mutex_ = nullptr;
+  Snapshot devices_;
+  std::vector<Aging> aging_;
+  std::atomic<uint32_t> version_{0};
+};
+
+} // namespace utilities
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+
+namespace utilities {
+
+// Quadrature decoding shared by both rotary encoder backends. A state is
+// (A << 1) | B. Each valid transition between neighbouring states counts +1
+// or -1; a detent is kSubStepsPerDetent counts. The GPIO interrupt backend
+// looks transitions up in kQuadratureDelta; the pulse-counter backend is set
+// up from edgeDelta(), which reads the same table, so both count alike. Free
+// of ESP-IDF headers so it also builds on the host.
+namespace quadrature {
+
+// Index is (prev_state << 2) | current_state. Unchanged states and jumps of
+// two states (a missed edge) count 0.
+inline constexpr int8_t kQuadratureDelta[16] = {0, -1, 1, 0, 1, 0, 0, -1, -1, 0, 0, 1, 0, 1, -1, 0};
+inline constexpr int32_t kSubStepsPerDetent = 4;
+
+constexpr int8_t delta(uint8_t prevState, uint8_t currentState) {
+  return kQuadratureDelta[((prevState & 3u) << 2) | (currentState & 3u)];
+}
+
+// Count for one edge on channel A (or B) while the other channel is held
+// high or low: the pulse counter's edge and level actions.
+constexpr int8_t edgeDelta(bool onA, bool rising, bool otherHigh) {
+  const uint8_t other = otherHigh ? 1 : 0;
+  const uint8_t before = onA ? static_cast<uint8_t>(((rising ? 0 : 1) << 1) | other)
+                             : static_cast<uint8_t>((other << 1) | (rising ? 0 : 1));
+  const uint8_t after = onA ? static_cast<uint8_t>(((rising ? 1 : 0) << 1) | other)
+                            : static_cast<uint8_t>((other << 1) | (rising ? 1 : 0));
+  return delta(before, after);
+}
+
+// Turns a running count into whole detents, keeping the remainder for the
+// next call. Turning back within a detent cancels out.
+class DetentAccumulator {
+public:
+  constexpr int32_t update(int32_t count) {
+    subSteps_ += count - lastCount_;
+    lastCount_ = count;
+    const int32_t detents = subSteps_ / kSubStepsPerDetent;
+    subSteps_ -= detents * kSubStepsPerDetent;
+    return detents;
+  }
+
+private:
+  int32_t lastCount_ = 0;
+  int32_t subSteps_ = 0;
+};
+
+// One full cycle each way is one detent, A leading B counting up.
+static_assert(delta(0, 2) + delta(2, 3) + delta(3, 1) + delta(1, 0) == kSubStepsPerDetent);
+static_assert(delta(0, 1) + delta(1, 3) + delta(3, 2) + delta(2, 0) == -kSubStepsPerDetent);
+static_assert(delta(0, 3) == 0 && delta(1, 2) == 0 && delta(2, 2) == 0);
+// The pulse counter actions: on A, rising counts up with B low and down with
+// B high, and the opposite for falling; B mirrors A.
+static_assert(edgeDelta(true, true, false) == 1 && edgeDelta(true, true, true) == -1);
+static_assert(edgeDelta(true, false, false) == -1 && edgeDelta(true, false, true) == 1);
+static_assert(edgeDelta(false, true, false) == -1 && edgeDelta(false, true, true) == 1);
+static_assert(edgeDelta(false, false, false) == 1 && edgeDelta(false, false, true) == -1);
+static_assert([] {
+  DetentAccumulator acc;
+  return acc.update(3) == 0 && acc.update(5) == 1 && acc.update(1) == 0 && acc.update(-3) == -1;
+}());
+
+} // namespace quadrature
+} // namespace utilities
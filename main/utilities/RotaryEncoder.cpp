@@ -2,21 +2,51 @@
  * @file RotaryEncoder.cpp
  * @brief Quadrature rotary encoder driver with push-button support.
  *
- * Uses GPIO interrupts and a quadrature transition table to decode rotation
- * direction and count. Button events (single click, long press) are handled
+ * Decodes rotation with one of two backends, chosen in Kconfig. The pulse
+ * counter backend (CONFIG_ROTARY_ENCODER_BACKEND_PCNT) counts quadrature
+ * edges in hardware behind a glitch filter, so contact bounce costs no CPU
+ * time. The interrupt backend reads both pins on every edge and looks the
+ * transition up in a table. Both count the same way (see QuadratureDecoder.h).
+ * Button events (single click, long press) are handled
  * by the esp-idf `iot_button` component. All callbacks are invoked from a
  * dedicated FreeRTOS monitor task so callers receive events on a known stack.
+ * The monitor task also times detents: callbacks registered as accelerated
+ * get each detent scaled by the spin rate, up to CONFIG_ROTARY_ENCODER_ACCEL_MAX.
  */
 #include "RotaryEncoder.h"
+#include "QuadratureDecoder.h"
 
+#include "sdkconfig.h"
 #include <button_gpio.h>
 #include <esp_err.h>
 #include <esp_log.h>
+#include <esp_timer.h>
 #include <iot_button.h>
+#if CONFIG_ROTARY_ENCODER_BACKEND_PCNT
+#include <driver/pulse_cnt.h>
+#endif
 
 namespace {
-// Quadrature transition table: index is (prev_state << 2) | current_state.
-constexpr int8_t kQuadratureDelta[16] = {0, -1, 1, 0, 1, 0, 0, -1, -1, 0, 0, 1, 0, 1, -1, 0};
+#if CONFIG_ROTARY_ENCODER_BACKEND_PCNT
+constexpr const char *kBackendName = "PCNT";
+// The counter wraps at these limits; the driver adds each wrap to the count
+// it reports, so reads are not limited to this range.
+constexpr int kPcntLimit = 1000;
+#else
+constexpr const char *kBackendName = "ISR";
+#endif
+
+#if CONFIG_ROTARY_ENCODER_ENABLE
+constexpr int32_t kMaxAcceleration = CONFIG_ROTARY_ENCODER_ACCEL_MAX;
+#else
+constexpr int32_t kMaxAcceleration = 1;
+#endif
+// Detent intervals at or above kSlowDetentUs move one row per detent; at or
+// below kFastDetentUs they move kMaxAcceleration rows. A pause longer than
+// kIdleDetentUs, or a change of direction, starts again from slow.
+constexpr uint32_t kSlowDetentUs = 60000;
+constexpr uint32_t kFastDetentUs = 15000;
+constexpr uint32_t kIdleDetentUs = 150000;
 } // namespace
 
 namespace utilities {
@@ -68,7 +98,7 @@ void IRAM_ATTR RotaryEncoder::encoder_isr_handler(void *arg) {
   const uint8_t currentState = static_cast<uint8_t>((a << 1) | b);
   const uint8_t transition = static_cast<uint8_t>((self->prevState_ << 2) | currentState);
 
-  int8_t delta = kQuadratureDelta[transition];
+  int8_t delta = quadrature::kQuadratureDelta[transition];
   if (self->reverseDirection_) {
     delta = -delta;
   }
@@ -82,52 +112,81 @@ void IRAM_ATTR RotaryEncoder::encoder_isr_handler(void *arg) {
   self->prevState_ = currentState;
 }
 
-// FreeRTOS task that wakes on a notification from encoder_isr_handler and
-// calls emitRotate() with the accumulated delta.
+// FreeRTOS task that polls the count every 10 ms, converts it to detents
+// and calls emitRotate(). The interval between detents is smoothed over the
+// last few batches to pick the acceleration applied to this batch.
 void RotaryEncoder::monitor_task_trampoline(void *arg) {
   auto *self = static_cast<RotaryEncoder *>(arg);
-  int32_t lastCount = 0;
-  int32_t subStepAccumulator = 0;
-  constexpr int32_t kSubStepsPerDetent = 4;
+  quadrature::DetentAccumulator accumulator;
+  int64_t lastDetentUs = 0;
+  int32_t lastDirection = 0;
+  uint32_t smoothedIntervalUs = kSlowDetentUs;
 
   while (true) {
-    int32_t currentCount = 0;
-    portENTER_CRITICAL(&self->countMux_);
-    currentCount = self->count_;
-    portEXIT_CRITICAL(&self->countMux_);
-
-    int32_t delta = currentCount - lastCount;
-    if (delta != 0) {
-      subStepAccumulator += delta;
-      lastCount = currentCount;
-
-      int32_t detentSteps = 0;
-      while (subStepAccumulator >= kSubStepsPerDetent) {
-        ++detentSteps;
-        subStepAccumulator -= kSubStepsPerDetent;
-      }
-      while (subStepAccumulator <= -kSubStepsPerDetent) {
-        --detentSteps;
-        subStepAccumulator += kSubStepsPerDetent;
-      }
-
-      if (detentSteps != 0) {
-        ESP_LOGI(TAG, "%s detents=%ld count=%ld", detentSteps > 0 ? "ROTARY_UP" : "ROTARY_DOWN",
-                 static_cast<long>(detentSteps > 0 ? detentSteps : -detentSteps), static_cast<long>(currentCount));
-        self->emitRotate(detentSteps);
+    const int32_t currentCount = self->readCount();
+    const int32_t detentSteps = accumulator.update(currentCount);
+    if (detentSteps != 0) {
+      const int64_t now = esp_timer_get_time();
+      const int32_t direction = detentSteps > 0 ? 1 : -1;
+      const int32_t detents = detentSteps * direction;
+      const uint64_t elapsedUs = static_cast<uint64_t>(now - lastDetentUs);
+      if (direction != lastDirection || elapsedUs > kIdleDetentUs) {
+        smoothedIntervalUs = kSlowDetentUs;
+      } else {
+        const auto intervalUs = static_cast<uint32_t>(elapsedUs / static_cast<uint64_t>(detents));
+        smoothedIntervalUs = (smoothedIntervalUs * 3 + intervalUs) / 4;
       }
+      lastDetentUs = now;
+      lastDirection = direction;
+
+      const int32_t accelerated = detentSteps * accelerationFor(smoothedIntervalUs);
+      ESP_LOGD(TAG, "%s detents=%ld accelerated=%ld count=%ld", direction > 0 ? "ROTARY_UP" : "ROTARY_DOWN",
+               static_cast<long>(detents), static_cast<long>(accelerated * direction),
+               static_cast<long>(currentCount));
+      self->emitRotate(detentSteps, accelerated);
     }
 
     vTaskDelay(pdMS_TO_TICKS(10));
   }
 }
 
+// Quadrature count since init, in the configured direction.
+int32_t RotaryEncoder::readCount() {
+#if CONFIG_ROTARY_ENCODER_BACKEND_PCNT
+  int value = 0;
+  pcnt_unit_get_count(static_cast<pcnt_unit_handle_t>(pcntUnit_), &value);
+  return reverseDirection_ ? -value : value;
+#else
+  portENTER_CRITICAL(&countMux_);
+  const int32_t value = count_;
+  portEXIT_CRITICAL(&countMux_);
+  return value;
+#endif
+}
+
+// Rows per detent for a smoothed detent interval: 1 when turning slowly,
+// rising linearly to kMaxAcceleration for a fast spin.
+int32_t RotaryEncoder::accelerationFor(uint32_t detentIntervalUs) {
+  if (kMaxAcceleration <= 1 || detentIntervalUs >= kSlowDetentUs) {
+    return 1;
+  }
+  if (detentIntervalUs <= kFastDetentUs) {
+    return kMaxAcceleration;
+  }
+  const uint32_t speed = kSlowDetentUs - detentIntervalUs;
+  return 1 + static_cast<int32_t>(speed * static_cast<uint32_t>(kMaxAcceleration - 1) /
+                                  (kSlowDetentUs - kFastDetentUs));
+}
+
 // Registers rotate, click, long-press and optional process callbacks for the
-// given userData context. Replaces any previously registered set.
+// given userData context. Replaces any previously registered set. With
+// `accelerated` the rotate callback gets velocity-scaled deltas (long lists);
+// otherwise one step per detent.
 void RotaryEncoder::setCallbacks(RotateCallback rotateCb, ClickCallback clickCb, LongPressCallback longPressCb,
-                                 void *userData, DoubleClickCallback doubleClickCb) {
+                                 void *userData, DoubleClickCallback doubleClickCb, bool accelerated) {
   portENTER_CRITICAL(&callbackMux_);
   rotateCallback_ = rotateCb;
+  accelerated_ = accelerated;
   clickCallback_ = clickCb;
   doubleClickCallback_ = doubleClickCb;
   longPressCallback_ = longPressCb;
@@ -145,6 +204,7 @@ void RotaryEncoder::clearCallbacks(void *userData) {
     doubleClickCallback_ = nullptr;
     longPressCallback_ = nullptr;
     callbackUserData_ = nullptr;
+    accelerated_ = false;
   }
   portEXIT_CRITICAL(&callbackMux_);
 }
@@ -158,17 +218,22 @@ void RotaryEncoder::setActivityCallback(ActivityCallback cb, void *userData) {
   portEXIT_CRITICAL(&callbackMux_);
 }
 
-// Dispatches a rotation event with the given delta to all registered rotate
-// callbacks, then fires the activity callback.
-void RotaryEncoder::emitRotate(int32_t delta) {
+// Dispatches a rotation event to the registered rotate callback, as raw
+// detents or the accelerated delta depending on how it was registered, then
+// fires the activity callback.
+void RotaryEncoder::emitRotate(int32_t detents, int32_t acceleratedDelta) {
   RotateCallback rotateCb = nullptr;
   void *userData = nullptr;
   ActivityCallback actCb = nullptr;
   void *actData = nullptr;
+  int32_t delta = detents;
 
   portENTER_CRITICAL(&callbackMux_);
   rotateCb = rotateCallback_;
   userData = callbackUserData_;
+  if (accelerated_) {
+    delta = acceleratedDelta;
+  }
   actCb = activityCallback_;
   actData = activityUserData_;
   portEXIT_CRITICAL(&callbackMux_);
@@ -253,8 +318,8 @@ void RotaryEncoder::emitLongPress() {
 // Destructor: calls deinit() to free GPIO/ISR/task resources.
 RotaryEncoder::~RotaryEncoder() { deinit(); }
 
-// Configures GPIOs for encoder A/B (and optionally the switch), installs the
-// ISR, creates the monitor task and registers iot_button callbacks.
+// Starts the configured decoder on encoder A/B (and optionally the switch),
+// creates the monitor task and registers iot_button callbacks.
 bool RotaryEncoder::init(gpio_num_t gpioA, gpio_num_t gpioB, bool reverseDirection, bool enableSwitch,
                          gpio_num_t gpioSw, uint8_t switchActiveLevel) {
   if (initialized_) {
@@ -271,41 +336,14 @@ bool RotaryEncoder::init(gpio_num_t gpioA, gpio_num_t gpioB, bool reverseDirecti
   gpioB_ = gpioB;
   reverseDirection_ = reverseDirection;
 
-  gpio_config_t io_conf = {};
-  io_conf.intr_type = GPIO_INTR_ANYEDGE;
-  io_conf.mode = GPIO_MODE_INPUT;
-  io_conf.pin_bit_mask = (1ULL << static_cast<uint32_t>(gpioA_)) | (1ULL << static_cast<uint32_t>(gpioB_));
-  io_conf.pull_down_en = GPIO_PULLDOWN_DISABLE;
-  io_conf.pull_up_en = GPIO_PULLUP_ENABLE;
-  if (gpio_config(&io_conf) != ESP_OK) {
-    ESP_LOGE(TAG, "Failed to configure rotary GPIOs");
-    return false;
-  }
-
-  const esp_err_t isrServiceErr = gpio_install_isr_service(ESP_INTR_FLAG_IRAM);
-  if (isrServiceErr != ESP_OK && isrServiceErr != ESP_ERR_INVALID_STATE) {
-    ESP_LOGE(TAG, "Failed to install GPIO ISR service");
-    return false;
-  }
-
-  const uint8_t a = static_cast<uint8_t>(gpio_get_level(gpioA_));
-  const uint8_t b = static_cast<uint8_t>(gpio_get_level(gpioB_));
-  prevState_ = static_cast<uint8_t>((a << 1) | b);
-  count_ = 0;
-
-  if (gpio_isr_handler_add(gpioA_, encoder_isr_handler, this) != ESP_OK ||
-      gpio_isr_handler_add(gpioB_, encoder_isr_handler, this) != ESP_OK) {
-    ESP_LOGE(TAG, "Failed to add rotary ISR handlers");
-    gpio_isr_handler_remove(gpioA_);
-    gpio_isr_handler_remove(gpioB_);
+  if (!startDecoder()) {
     return false;
   }
 
   if (xTaskCreate(monitor_task_trampoline, "rotary_monitor", 3072, this, tskIDLE_PRIORITY + 1, &monitorTask_) !=
       pdPASS) {
     ESP_LOGE(TAG, "Failed to create rotary monitor task");
-    gpio_isr_handler_remove(gpioA_);
-    gpio_isr_handler_remove(gpioB_);
+    stopDecoder();
     return false;
   }
 
@@ -314,8 +352,7 @@ bool RotaryEncoder::init(gpio_num_t gpioA, gpio_num_t gpioB, bool reverseDirecti
       ESP_LOGE(TAG, "SW button enabled but GPIO is not configured");
       vTaskDelete(monitorTask_);
       monitorTask_ = nullptr;
-      gpio_isr_handler_remove(gpioA_);
-      gpio_isr_handler_remove(gpioB_);
+      stopDecoder();
       return false;
     }
 
@@ -332,8 +369,7 @@ bool RotaryEncoder::init(gpio_num_t gpioA, gpio_num_t gpioB, bool reverseDirecti
       ESP_LOGE(TAG, "Failed to create SW button on GPIO %d", static_cast<int>(gpioSw));
       vTaskDelete(monitorTask_);
       monitorTask_ = nullptr;
-      gpio_isr_handler_remove(gpioA_);
-      gpio_isr_handler_remove(gpioB_);
+      stopDecoder();
       return false;
     }
 
@@ -349,8 +385,7 @@ bool RotaryEncoder::init(gpio_num_t gpioA, gpio_num_t gpioB, bool reverseDirecti
       iot_button_delete(buttonHandle);
       vTaskDelete(monitorTask_);
       monitorTask_ = nullptr;
-      gpio_isr_handler_remove(gpioA_);
-      gpio_isr_handler_remove(gpioB_);
+      stopDecoder();
       return false;
     }
 
@@ -360,12 +395,147 @@ bool RotaryEncoder::init(gpio_num_t gpioA, gpio_num_t gpioB, bool reverseDirecti
   }
 
   initialized_ = true;
-  ESP_LOGI(TAG, "Rotary encoder ISR decoder initialized on GPIO A=%d B=%d", static_cast<int>(gpioA),
+  ESP_LOGI(TAG, "Rotary encoder %s decoder initialized on GPIO A=%d B=%d", kBackendName, static_cast<int>(gpioA),
            static_cast<int>(gpioB));
   return true;
 }
 
-// Removes the ISR, deletes the monitor task and releases button handles.
+#if CONFIG_ROTARY_ENCODER_BACKEND_PCNT
+// Sets up a pulse counter unit in 4x quadrature mode: one channel counts
+// edges on A with B as its level input, the other the reverse, with actions
+// from quadrature::edgeDelta(). Edges shorter than the glitch filter are
+// ignored in hardware.
+bool RotaryEncoder::startDecoder() {
+  pcnt_unit_config_t unitConfig = {};
+  unitConfig.low_limit = -kPcntLimit;
+  unitConfig.high_limit = kPcntLimit;
+  unitConfig.flags.accum_count = true;
+  pcnt_unit_handle_t unit = nullptr;
+  if (pcnt_new_unit(&unitConfig, &unit) != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to create rotary PCNT unit");
+    return false;
+  }
+  pcntUnit_ = unit;
+
+  pcnt_glitch_filter_config_t filterConfig = {};
+  filterConfig.max_glitch_ns = CONFIG_ROTARY_ENCODER_PCNT_GLITCH_NS;
+  if (filterConfig.max_glitch_ns > 0 && pcnt_unit_set_glitch_filter(unit, &filterConfig) != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to set rotary PCNT glitch filter");
+    stopDecoder();
+    return false;
+  }
+
+  auto action = [](int8_t delta) {
+    return delta > 0 ? PCNT_CHANNEL_EDGE_ACTION_INCREASE : PCNT_CHANNEL_EDGE_ACTION_DECREASE;
+  };
+  // Level actions apply on top of the edge action: HOLD (other pin high)
+  // keeps it, INVERSE (other pin low) flips it.
+  const gpio_num_t edgeGpios[2] = {gpioA_, gpioB_};
+  for (int i = 0; i < 2; ++i) {
+    const bool onA = i == 0;
+    pcnt_chan_config_t channelConfig = {};
+    channelConfig.edge_gpio_num = edgeGpios[i];
+    channelConfig.level_gpio_num = edgeGpios[1 - i];
+    pcnt_channel_handle_t channel = nullptr;
+    if (pcnt_new_channel(unit, &channelConfig, &channel) != ESP_OK ||
+        pcnt_channel_set_edge_action(channel, action(quadrature::edgeDelta(onA, true, true)),
+                                     action(quadrature::edgeDelta(onA, false, true))) != ESP_OK ||
+        pcnt_channel_set_level_action(channel, PCNT_CHANNEL_LEVEL_ACTION_KEEP, PCNT_CHANNEL_LEVEL_ACTION_INVERSE) !=
+            ESP_OK) {
+      ESP_LOGE(TAG, "Failed to set up rotary PCNT channel %c", onA ? 'A' : 'B');
+      if (channel != nullptr) {
+        pcnt_del_channel(channel);
+      }
+      stopDecoder();
+      return false;
+    }
+    pcntChannels_[i] = channel;
+  }
+  static_assert(quadrature::edgeDelta(true, true, false) == -quadrature::edgeDelta(true, true, true) &&
+                    quadrature::edgeDelta(true, false, false) == -quadrature::edgeDelta(true, false, true) &&
+                    quadrature::edgeDelta(false, true, false) == -quadrature::edgeDelta(false, true, true) &&
+                    quadrature::edgeDelta(false, false, false) == -quadrature::edgeDelta(false, false, true),
+                "a low level input must invert the edge action");
+
+  gpio_pullup_en(gpioA_);
+  gpio_pullup_en(gpioB_);
+
+  // Watch points at the limits let the driver carry the count past them.
+  if (pcnt_unit_add_watch_point(unit, -kPcntLimit) != ESP_OK || pcnt_unit_add_watch_point(unit, kPcntLimit) != ESP_OK ||
+      pcnt_unit_enable(unit) != ESP_OK || pcnt_unit_clear_count(unit) != ESP_OK || pcnt_unit_start(unit) != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to start rotary PCNT unit");
+    stopDecoder();
+    return false;
+  }
+  return true;
+}
+
+// Stops and releases the pulse counter unit and its channels.
+void RotaryEncoder::stopDecoder() {
+  auto unit = static_cast<pcnt_unit_handle_t>(pcntUnit_);
+  if (unit == nullptr) {
+    return;
+  }
+  pcnt_unit_stop(unit);
+  pcnt_unit_disable(unit);
+  for (auto &channel : pcntChannels_) {
+    if (channel != nullptr) {
+      pcnt_del_channel(static_cast<pcnt_channel_handle_t>(channel));
+      channel = nullptr;
+    }
+  }
+  pcnt_unit_remove_watch_point(unit, -kPcntLimit);
+  pcnt_unit_remove_watch_point(unit, kPcntLimit);
+  pcnt_del_unit(unit);
+  pcntUnit_ = nullptr;
+}
+#else
+// Configures the A/B GPIOs for interrupts on both edges and installs
+// encoder_isr_handler on each.
+bool RotaryEncoder::startDecoder() {
+  gpio_config_t io_conf = {};
+  io_conf.intr_type = GPIO_INTR_ANYEDGE;
+  io_conf.mode = GPIO_MODE_INPUT;
+  io_conf.pin_bit_mask = (1ULL << static_cast<uint32_t>(gpioA_)) | (1ULL << static_cast<uint32_t>(gpioB_));
+  io_conf.pull_down_en = GPIO_PULLDOWN_DISABLE;
+  io_conf.pull_up_en = GPIO_PULLUP_ENABLE;
+  if (gpio_config(&io_conf) != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to configure rotary GPIOs");
+    return false;
+  }
+
+  const esp_err_t isrServiceErr = gpio_install_isr_service(ESP_INTR_FLAG_IRAM);
+  if (isrServiceErr != ESP_OK && isrServiceErr != ESP_ERR_INVALID_STATE) {
+    ESP_LOGE(TAG, "Failed to install GPIO ISR service");
+    return false;
+  }
+
+  const uint8_t a = static_cast<uint8_t>(gpio_get_level(gpioA_));
+  const uint8_t b = static_cast<uint8_t>(gpio_get_level(gpioB_));
+  prevState_ = static_cast<uint8_t>((a << 1) | b);
+  count_ = 0;
+
+  if (gpio_isr_handler_add(gpioA_, encoder_isr_handler, this) != ESP_OK ||
+      gpio_isr_handler_add(gpioB_, encoder_isr_handler, this) != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to add rotary ISR handlers");
+    stopDecoder();
+    return false;
+  }
+  return true;
+}
+
+// Removes the A/B interrupt handlers.
+void RotaryEncoder::stopDecoder() {
+  if (gpioA_ != GPIO_NUM_NC) {
+    gpio_isr_handler_remove(gpioA_);
+  }
+  if (gpioB_ != GPIO_NUM_NC) {
+    gpio_isr_handler_remove(gpioB_);
+  }
+}
+#endif
+
+// Stops the decoder, deletes the monitor task and releases button handles.
 void RotaryEncoder::deinit() {
   if (!initialized_) {
     return;
@@ -387,12 +557,7 @@ void RotaryEncoder::deinit() {
     monitorTask_ = nullptr;
   }
 
-  if (gpioA_ != GPIO_NUM_NC) {
-    gpio_isr_handler_remove(gpioA_);
-  }
-  if (gpioB_ != GPIO_NUM_NC) {
-    gpio_isr_handler_remove(gpioB_);
-  }
+  stopDecoder();
 
   gpioA_ = GPIO_NUM_NC;
   gpioB_ = GPIO_NUM_NC;
@@ -32,7 +32,7 @@ public:
             gpio_num_t gpioSw = GPIO_NUM_NC, uint8_t switchActiveLevel = 0);
   void deinit();
   void setCallbacks(RotateCallback rotateCb, ClickCallback clickCb, LongPressCallback longPressCb, void *userData,
-                    DoubleClickCallback doubleClickCb = nullptr);
+                    DoubleClickCallback doubleClickCb = nullptr, bool accelerated = false);
   void clearCallbacks(void *userData = nullptr);
   void setActivityCallback(ActivityCallback cb, void *userData);
   bool isInitialized() const { return initialized_; }
@@ -45,7 +45,11 @@ private:
   static void sw_single_click_trampoline(void *button_handle, void *usr_data);
   static void sw_double_click_trampoline(void *button_handle, void *usr_data);
   static void sw_long_press_trampoline(void *button_handle, void *usr_data);
-  void emitRotate(int32_t delta);
+  static int32_t accelerationFor(uint32_t detentIntervalUs);
+  bool startDecoder();
+  void stopDecoder();
+  int32_t readCount();
+  void emitRotate(int32_t detents, int32_t acceleratedDelta);
   void emitClick();
   void emitDoubleClick();
   void emitLongPress();
@@ -54,8 +58,12 @@ private:
   gpio_num_t gpioA_ = GPIO_NUM_NC;
   gpio_num_t gpioB_ = GPIO_NUM_NC;
   bool reverseDirection_ = false;
+  // Interrupt backend state.
   volatile int32_t count_ = 0;
   volatile uint8_t prevState_ = 0;
+  // Pulse counter backend handles (pcnt_unit_handle_t, pcnt_channel_handle_t).
+  void *pcntUnit_ = nullptr;
+  void *pcntChannels_[2] = {};
   TaskHandle_t monitorTask_ = nullptr;
   portMUX_TYPE countMux_ = portMUX_INITIALIZER_UNLOCKED;
   portMUX_TYPE callbackMux_ = portMUX_INITIALIZER_UNLOCKED;
@@ -64,6 +72,7 @@ private:
   DoubleClickCallback doubleClickCallback_ = nullptr;
   LongPressCallback longPressCallback_ = nullptr;
   void *callbackUserData_ = nullptr;
+  bool accelerated_ = false; // rotate callback takes velocity-scaled deltas
   ActivityCallback activityCallback_ = nullptr;
   void *activityUserData_ = nullptr;
   bool initialized_ = false;
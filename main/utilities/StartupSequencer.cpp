@@ -0,0 +1,93 @@
+/**
+ * @file StartupSequencer.cpp
+ * @brief Dependency-ordered, concurrent boot steps.
+ *
+ * Every step gets a task at the caller's priority. The task blocks on an
+ * event group until the bits of its dependencies are set, runs the step, sets
+ * its own bit and deletes itself. A step whose task could not be created has
+ * its bit set by run(), and the steps depending on it finish without running.
+ * run() returns once every bit is set.
+ */
+#include "StartupSequencer.h"
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <freertos/task.h>
+
+namespace utilities {
+
+static const char *TAG = "STARTUP";
+
+// Adds a step that runs after every step in `dependsOn` (a mask built from
+// after()). Returns the step's id, or -1 when kMaxSteps are already added or a
+// dependency does not exist yet.
+int StartupSequencer::add(const char *name, StepFn fn, uint32_t dependsOn, uint32_t stackSize) {
+  if (count_ == kMaxSteps || dependsOn >= after(static_cast<int>(count_))) {
+    ESP_LOGE(TAG, "Cannot add step %s", name);
+    return -1;
+  }
+  const int id = static_cast<int>(count_++);
+  steps_[id] = Step{name, fn, dependsOn, stackSize, id, this};
+  return id;
+}
+
+// Starts every step and blocks until all have finished. Steps only depend on
+// earlier ones, so the order cannot deadlock. Returns false if a step's task
+// could not be created; steps that depend on it are then skipped.
+bool StartupSequencer::run() {
+  done_ = xEventGroupCreate();
+  if (!done_) {
+    ESP_LOGE(TAG, "Failed to create event group");
+    return false;
+  }
+
+  const UBaseType_t priority = uxTaskPriorityGet(nullptr);
+  failed_ = 0;
+  for (size_t i = 0; i < count_; ++i) {
+    Step &step = steps_[i];
+    if (xTaskCreate(&StartupSequencer::step_task, step.name, step.stackSize, &step, priority, nullptr) != pdPASS) {
+      ESP_LOGE(TAG, "Failed to create task for step %s", step.name);
+      failed_ |= after(step.id);
+    }
+  }
+
+  // Fail the dependents too, then release the steps. A step that never got a
+  // task is reported done here so nothing waits on it forever.
+  const uint32_t notStarted = failed_;
+  for (size_t i = 0; i < count_; ++i) {
+    const Step &step = steps_[i];
+    if (step.dependsOn & failed_) {
+      failed_ |= after(step.id);
+    }
+  }
+  xEventGroupSetBits(done_, kReleasedBit | notStarted);
+
+  // Wait for every created task before deleting the group they use.
+  const EventBits_t all = after(static_cast<int>(count_)) - 1;
+  xEventGroupWaitBits(done_, all, pdFALSE, pdTRUE, portMAX_DELAY);
+  vEventGroupDelete(done_);
+  done_ = nullptr;
+
+  ESP_LOGI(TAG, "Startup steps done at %lld ms", esp_timer_get_time() / 1000);
+  return failed_ == 0;
+}
+
+// Task body for one step: waits for its dependencies, runs it (unless one of
+// them failed) and reports it done.
+void StartupSequencer::step_task(void *arg) {
+  auto *step = static_cast<Step *>(arg);
+  StartupSequencer *owner = step->owner;
+  xEventGroupWaitBits(owner->done_, kReleasedBit | step->dependsOn, pdFALSE, pdTRUE, portMAX_DELAY);
+  if (owner->failed_ & after(step->id)) {
+    ESP_LOGE(TAG, "%s: skipped, a step it depends on failed", step->name);
+  } else {
+    const int64_t startUs = esp_timer_get_time();
+    step->fn();
+    ESP_LOGI(TAG, "%s: started at %lld ms, took %lld ms", step->name, startUs / 1000,
+             (esp_timer_get_time() - startUs) / 1000);
+  }
+  xEventGroupSetBits(owner->done_, after(step->id));
+  vTaskDelete(nullptr);
+}
+
+} // namespace utilities
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
+
+namespace utilities {
+
+// Runs boot steps concurrently, each on its own short-lived task that starts
+// as soon as the steps it depends on have finished. Independent work (radio,
+// panel, LVGL) therefore overlaps instead of running back to back, and no step
+// waits a fixed time for another. Each step logs when it started and how long
+// it took. Set up and run from one task.
+class StartupSequencer {
+public:
+  using StepFn = void (*)();
+  static constexpr size_t kMaxSteps = 16;
+
+  static constexpr uint32_t after(int step) { return 1u << step; }
+
+  int add(const char *name, StepFn fn, uint32_t dependsOn = 0, uint32_t stackSize = 4096);
+  bool run();
+
+private:
+  struct Step {
+    const char *name = nullptr;
+    StepFn fn = nullptr;
+    uint32_t dependsOn = 0;
+    uint32_t stackSize = 0;
+    int id = -1;
+    StartupSequencer *owner = nullptr;
+  };
+
+  // Set once every task is created; steps wait for it so failed_ is final.
+  static constexpr EventBits_t kReleasedBit = 1u << kMaxSteps;
+
+  static void step_task(void *arg);
+
+  std::array<Step, kMaxSteps> steps_{};
+  size_t count_ = 0;
+  EventGroupHandle_t done_ = nullptr;
+  uint32_t failed_ = 0; // steps that could not start or depend on one that could not
+};
+
+} // namespace utilities
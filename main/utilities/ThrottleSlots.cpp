@@ -0,0 +1,234 @@
+/**
+ * @file ThrottleSlots.cpp
+ * @brief Throttle slots for driving several locos and consists from one handset.
+ *
+ * Each slot holds a loco, or a consist of up to kMaxMembers locos that share
+ * one speed input, together with the speed, direction and function state last
+ * set on it. Speeds go out through WifiControl::requestConsistSpeed(), which
+ * sends every member's command in one write per protocol tick. Functions are
+ * sent to the lead loco only, the usual arrangement for a consist.
+ */
+#include "ThrottleSlots.h"
+
+#include <DCCEXProtocol.h>
+#include <algorithm>
+#include <esp_log.h>
+#include <esp_timer.h>
+
+namespace utilities {
+
+static const char *TAG = "THROTTLE_SLOTS";
+
+namespace {
+// Server broadcasts arriving this soon after a local change may still carry
+// the previous speed, so they are not allowed to move the slot back.
+constexpr int64_t kEchoHoldUs = 500 * 1000;
+} // namespace
+
+// Makes the slot driving `address` active, taking a free slot for it if it is
+// not driven yet. When all slots are used, the least recently used stopped
+// slot is reassigned. Returns the slot index, or -1 if every slot is moving.
+int ThrottleSlots::acquire(int address, const std::string &name) {
+  int index = slotOfAddress(address);
+  if (index < 0) {
+    for (size_t i = 0; i < slots_.size(); ++i) {
+      const Slot &candidate = slots_[i];
+      if (!candidate.inUse()) {
+        index = static_cast<int>(i);
+        break;
+      }
+      if (candidate.speed == 0 && (index < 0 || candidate.lastUsed < slots_[index].lastUsed)) {
+        index = static_cast<int>(i);
+      }
+    }
+    if (index < 0) {
+      ESP_LOGW(TAG, "No free throttle slot for loco %d", address);
+      return -1;
+    }
+    Slot &slot = slots_[index];
+    slot = Slot{};
+    slot.name = name;
+    slot.members[0] = ConsistMember{address, false};
+    slot.memberCount = 1;
+    syncFromLoco(index);
+  }
+  select(index);
+  return index;
+}
+
+// Frees a slot. Its locos keep running at their current speed, as they do when
+// a throttle is handed back on a real layout.
+void ThrottleSlots::release(int index) {
+  Slot *slot = mutableSlot(index);
+  if (!slot) {
+    return;
+  }
+  *slot = Slot{};
+  if (active_ == index) {
+    selectNext();
+  }
+}
+
+// Cycles `address` through the consist in slot `index`: absent -> added facing
+// forward -> reversed -> removed. A removed loco is stopped. Refused for the
+// lead, a loco driven in another slot, or a full consist.
+ThrottleSlots::ConsistChange ThrottleSlots::toggleConsistMember(int index, int address) {
+  Slot *slot = mutableSlot(index);
+  if (!slot || !slot->inUse() || slot->leadAddress() == address) {
+    return ConsistChange::Refused;
+  }
+
+  ConsistMember *end = slot->members.data() + slot->memberCount;
+  ConsistMember *member = std::find_if(
+      slot->members.data(), end, [address](const ConsistMember &candidate) { return candidate.address == address; });
+  if (member == end) {
+    if (slotOfAddress(address) >= 0 || slot->memberCount == kMaxMembers) {
+      return ConsistChange::Refused;
+    }
+    *member = ConsistMember{address, false};
+    ++slot->memberCount;
+    sendSpeed(*slot);
+    return ConsistChange::Added;
+  }
+  if (!member->reversed) {
+    member->reversed = true;
+    sendSpeed(*slot);
+    return ConsistChange::Reversed;
+  }
+
+  std::copy(member + 1, end, member);
+  --slot->memberCount;
+  slot->members[slot->memberCount] = ConsistMember{};
+  WifiControl::instance()->requestLocoSpeed(address, 0, slot->forward);
+  return ConsistChange::Removed;
+}
+
+// The consist member of slot `index` with `address`, or nullptr.
+const ConsistMember *ThrottleSlots::findMember(int index, int address) const {
+  const Slot *found = slot(index);
+  if (!found) {
+    return nullptr;
+  }
+  for (size_t i = 0; i < found->memberCount; ++i) {
+    if (found->members[i].address == address) {
+      return &found->members[i];
+    }
+  }
+  return nullptr;
+}
+
+void ThrottleSlots::select(int index) {
+  Slot *slot = mutableSlot(index);
+  if (!slot || !slot->inUse()) {
+    return;
+  }
+  active_ = index;
+  slot->lastUsed = ++useCounter_;
+}
+
+// Makes the next used slot after the active one active, wrapping round.
+// Returns the new active slot, or -1 when no slot is used.
+int ThrottleSlots::selectNext() {
+  const int count = static_cast<int>(slots_.size());
+  for (int step = 1; step <= count; ++step) {
+    const int index = (active_ + step + count) % count;
+    if (slots_[index].inUse()) {
+      select(index);
+      return active_;
+    }
+  }
+  active_ = -1;
+  return active_;
+}
+
+size_t ThrottleSlots::inUseCount() const {
+  return static_cast<size_t>(
+      std::count_if(slots_.begin(), slots_.end(), [](const Slot &slot) { return slot.inUse(); }));
+}
+
+const ThrottleSlots::Slot *ThrottleSlots::slot(int index) const {
+  if (index < 0 || static_cast<size_t>(index) >= slots_.size()) {
+    return nullptr;
+  }
+  return &slots_[index];
+}
+
+ThrottleSlots::Slot *ThrottleSlots::mutableSlot(int index) {
+  return const_cast<Slot *>(static_cast<const ThrottleSlots *>(this)->slot(index));
+}
+
+// Slot that has `address` as its lead or as a consist member, or -1.
+int ThrottleSlots::slotOfAddress(int address) const {
+  for (size_t i = 0; i < slots_.size(); ++i) {
+    if (findMember(static_cast<int>(i), address)) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+// Records a new speed and direction for the slot and queues it for every
+// member.
+bool ThrottleSlots::setSpeed(int index, int speed, bool forward) {
+  Slot *slot = mutableSlot(index);
+  if (!slot || !slot->inUse()) {
+    return false;
+  }
+  slot->speed = std::clamp(speed, 0, kMaxSpeed);
+  slot->forward = forward;
+  slot->lastLocalChangeUs = esp_timer_get_time();
+  return sendSpeed(*slot);
+}
+
+bool ThrottleSlots::sendSpeed(Slot &slot) {
+  if (!WifiControl::instance()->requestConsistSpeed(slot.members.data(), slot.memberCount, slot.speed, slot.forward)) {
+    ESP_LOGW(TAG, "Speed change for loco %d not sent", slot.leadAddress());
+    return false;
+  }
+  return true;
+}
+
+// Turns a function of the slot's lead loco on or off.
+bool ThrottleSlots::setFunction(int index, int function, bool on) {
+  Slot *slot = mutableSlot(index);
+  if (!slot || !slot->inUse() || !WifiControl::instance()->setLocoFunction(slot->leadAddress(), function, on)) {
+    return false;
+  }
+  slot->functionMap = on ? (slot->functionMap | (1 << function)) : (slot->functionMap & ~(1 << function));
+  return true;
+}
+
+// Takes speed, direction and functions from a broadcast for the slot's lead,
+// unless we changed speed ourselves a moment ago and the broadcast may be
+// stale. Returns true if anything changed.
+bool ThrottleSlots::applyServerState(int index, int speed, bool forward, int functionMap) {
+  Slot *slot = mutableSlot(index);
+  if (!slot || !slot->inUse()) {
+    return false;
+  }
+  bool changed = functionMap != slot->functionMap;
+  slot->functionMap = functionMap;
+  if (esp_timer_get_time() - slot->lastLocalChangeUs < kEchoHoldUs) {
+    return changed;
+  }
+  speed = std::clamp(speed, 0, kMaxSpeed);
+  changed = changed || speed != slot->speed || forward != slot->forward;
+  slot->speed = speed;
+  slot->forward = forward;
+  return changed;
+}
+
+// Refreshes the slot from the state DCCEXProtocol last reported for its lead
+// loco, which keeps following broadcasts while the throttle is not shown.
+void ThrottleSlots::syncFromLoco(int index) {
+  const Slot *slot = this->slot(index);
+  if (!slot || !slot->inUse()) {
+    return;
+  }
+  if (auto *loco = DCCExController::Loco::getByAddress(slot->leadAddress())) {
+    applyServerState(index, loco->getSpeed(), loco->getDirection() == DCCExController::Direction::Forward,
+                     loco->getFunctionStates());
+  }
+}
+
+} // namespace utilities
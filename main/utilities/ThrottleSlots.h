@@ -0,0 +1,83 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "connection/wifi_control.h"
+
+namespace utilities {
+
+// Locos being driven from this handset. Each slot holds one loco, or a consist
+// of several that share one speed, with its own speed, direction and function
+// state. Owned by the LVGL task; not thread-safe.
+class ThrottleSlots {
+public:
+  static constexpr size_t kMaxSlots = WifiControl::kMaxThrottles;
+  static constexpr size_t kMaxMembers = WifiControl::kMaxConsistMembers;
+
+  struct Slot {
+    std::string name; // roster name of the lead loco
+    std::array<ConsistMember, kMaxMembers> members{};
+    size_t memberCount = 0;
+    int speed = 0;
+    bool forward = true;
+    int functionMap = 0;
+    int64_t lastLocalChangeUs = 0; // server echoes older than our own changes are ignored for a moment
+    uint32_t lastUsed = 0;
+
+    bool inUse() const { return memberCount > 0; }
+    bool isConsist() const { return memberCount > 1; }
+    int leadAddress() const { return memberCount > 0 ? members[0].address : -1; }
+  };
+
+  // What toggleConsistMember() did with the loco.
+  enum class ConsistChange {
+    Added,
+    Reversed,
+    Removed,
+    Refused,
+  };
+
+  static std::shared_ptr<ThrottleSlots> instance() {
+    static std::shared_ptr<ThrottleSlots> s;
+    if (!s)
+      s.reset(new ThrottleSlots());
+    return s;
+  }
+  ThrottleSlots(const ThrottleSlots &) = delete;
+  ThrottleSlots &operator=(const ThrottleSlots &) = delete;
+
+  int acquire(int address, const std::string &name);
+  void release(int index);
+  ConsistChange toggleConsistMember(int index, int address);
+  const ConsistMember *findMember(int index, int address) const;
+
+  int active() const { return active_; }
+  void select(int index);
+  int selectNext();
+  size_t inUseCount() const;
+  const Slot *slot(int index) const;
+
+  bool setSpeed(int index, int speed, bool forward);
+  bool setFunction(int index, int function, bool on);
+  bool applyServerState(int index, int speed, bool forward, int functionMap);
+  void syncFromLoco(int index);
+
+  static constexpr int kMaxSpeed = 126;
+
+private:
+  ThrottleSlots() = default;
+
+  Slot *mutableSlot(int index);
+  int slotOfAddress(int address) const;
+  bool sendSpeed(Slot &slot);
+
+  std::array<Slot, kMaxSlots> slots_{};
+  int active_ = -1;
+  uint32_t useCounter_ = 0;
+};
+
+} // namespace utilities
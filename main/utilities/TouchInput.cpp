@@ -0,0 +1,224 @@
+/**
+ * @file TouchInput.cpp
+ * @brief Interrupt-driven XPT2046 touch sampling task.
+ *
+ * A dedicated FreeRTOS task reads the touch controller (under the display bus
+ * lock, once the flush DMA has finished), filters each reading with a
+ * 3-tap median followed by a first-order IIR, and pushes timestamped points
+ * into a queue. The LVGL pointer read callback only drains that queue. When a
+ * PENIRQ GPIO is configured the task and the LVGL read timer both sleep while
+ * the panel is untouched; the falling edge wakes them.
+ */
+#include "TouchInput.h"
+
+#include "display/DisplayManager.h"
+#include "display/LvglTask.h"
+#include <algorithm>
+#include <esp_log.h>
+#include <esp_timer.h>
+
+namespace utilities {
+
+static const char *TAG = "TouchInput";
+
+namespace {
+constexpr uint32_t kSamplePeriodMs = 10;   // while pressed
+constexpr uint32_t kIdlePollPeriodMs = 20; // no PENIRQ: polling rate while released
+constexpr UBaseType_t kQueueLength = 8;
+constexpr int kMedianTaps = 3;
+
+// Median of three without sorting.
+int32_t median3(int32_t a, int32_t b, int32_t c) { return std::max(std::min(a, b), std::min(std::max(a, b), c)); }
+} // namespace
+
+// PENIRQ falling-edge ISR: wakes the sampling task. Edges raised while the
+// task is already sampling are discarded by the task after release.
+void IRAM_ATTR TouchInput::pen_isr_handler(void *arg) {
+  auto *self = static_cast<TouchInput *>(arg);
+  BaseType_t higherPriorityTaskWoken = pdFALSE;
+  if (self->sampleTask_ != nullptr) {
+    vTaskNotifyGiveFromISR(self->sampleTask_, &higherPriorityTaskWoken);
+  }
+  portYIELD_FROM_ISR(higherPriorityTaskWoken);
+}
+
+// FreeRTOS entry point: forwards to run() and never returns.
+void TouchInput::sample_task_trampoline(void *arg) { static_cast<TouchInput *>(arg)->run(); }
+
+// Reads kMedianTaps raw points under the bus lock and folds their median into
+// the IIR filter. Returns false as soon as any read reports no touch. Flushes
+// return before their DMA completes, so the bus is taken with lockBusIdle().
+bool TouchInput::sampleFiltered(int32_t *x, int32_t *y) {
+  int32_t xs[kMedianTaps];
+  int32_t ys[kMedianTaps];
+
+  DisplayManager::lockBusIdle();
+  for (int i = 0; i < kMedianTaps; ++i) {
+    if (!DisplayManager::gfx.getTouch(&xs[i], &ys[i])) {
+      DisplayManager::unlockBus();
+      return false;
+    }
+  }
+  DisplayManager::unlockBus();
+
+  const int32_t mx = median3(xs[0], xs[1], xs[2]);
+  const int32_t my = median3(ys[0], ys[1], ys[2]);
+  if (!lastQueuedPressed_) {
+    // First sample of a press: start the filter on the measured point so the
+    // cursor does not slide in from the previous release position.
+    filteredX_ = mx;
+    filteredY_ = my;
+  } else {
+    filteredX_ += (mx - filteredX_) / 2;
+    filteredY_ += (my - filteredY_) / 2;
+  }
+  *x = filteredX_;
+  *y = filteredY_;
+  return true;
+}
+
+// Queues a point for the LVGL read callback. When the queue is full the oldest
+// point is dropped so the newest state always gets through.
+void TouchInput::publish(const TouchPoint &point) {
+  if (xQueueSend(queue_, &point, 0) != pdTRUE) {
+    TouchPoint dropped;
+    xQueueReceive(queue_, &dropped, 0);
+    xQueueSend(queue_, &point, 0);
+  }
+  lastQueuedPressed_ = point.pressed;
+}
+
+// Sampling loop. Idle: blocks on PENIRQ (or polls when none is configured).
+// Pressed: samples every kSamplePeriodMs until the controller reports release,
+// then queues a release point at the last filtered position.
+void TouchInput::run() {
+  while (true) {
+    if (lastQueuedPressed_) {
+      vTaskDelay(pdMS_TO_TICKS(kSamplePeriodMs));
+    } else if (penIrqGpio_ != GPIO_NUM_NC) {
+      if (gpio_get_level(penIrqGpio_) != 0) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+      }
+    } else {
+      vTaskDelay(pdMS_TO_TICKS(kIdlePollPeriodMs));
+    }
+
+    int32_t x = 0;
+    int32_t y = 0;
+    const bool wasPressed = lastQueuedPressed_;
+    if (sampleFiltered(&x, &y)) {
+      publish(TouchPoint{static_cast<int16_t>(x), static_cast<int16_t>(y), true, esp_timer_get_time()});
+      if (!wasPressed && penIrqGpio_ != GPIO_NUM_NC && indev_ != nullptr) {
+        // The read timer is paused while idle; run it now rather than on its
+        // next period so the press reaches LVGL immediately.
+        display::LvglLock lock;
+        if (lv_timer_t *readTimer = lv_indev_get_read_timer(indev_)) {
+          lv_timer_resume(readTimer);
+          lv_timer_ready(readTimer);
+        }
+      }
+    } else if (wasPressed) {
+      publish(TouchPoint{static_cast<int16_t>(filteredX_), static_cast<int16_t>(filteredY_), false,
+                         esp_timer_get_time()});
+      // Sampling toggles PENIRQ; drop the edges it produced.
+      ulTaskNotifyTake(pdTRUE, 0);
+    }
+  }
+}
+
+// Pops the next queued point. `more` reports whether further points are
+// waiting so the caller can ask LVGL to read again in the same cycle. Once a
+// release has been delivered and the queue is empty, the LVGL read timer is
+// paused until the next PENIRQ. Must be called from the LVGL read callback.
+bool TouchInput::readPoint(TouchPoint *point, bool *more) {
+  *more = false;
+  if (queue_ == nullptr || xQueueReceive(queue_, point, 0) != pdTRUE) {
+    if (penIrqGpio_ != GPIO_NUM_NC && indev_ != nullptr && !lastQueuedPressed_) {
+      if (lv_timer_t *readTimer = lv_indev_get_read_timer(indev_)) {
+        lv_timer_pause(readTimer);
+      }
+    }
+    return false;
+  }
+  *more = uxQueueMessagesWaiting(queue_) > 0;
+  return true;
+}
+
+// Destructor: calls deinit() to free the ISR, task and queue.
+TouchInput::~TouchInput() { deinit(); }
+
+// Creates the point queue, configures penIrqGpio (when valid) as a pulled-up
+// falling-edge interrupt and starts the sampling task next to the render task.
+bool TouchInput::init(lv_indev_t *indev, gpio_num_t penIrqGpio) {
+  if (initialized_) {
+    ESP_LOGI(TAG, "Touch input already initialized");
+    return true;
+  }
+
+  indev_ = indev;
+  penIrqGpio_ = penIrqGpio;
+
+  queue_ = xQueueCreate(kQueueLength, sizeof(TouchPoint));
+  if (queue_ == nullptr) {
+    ESP_LOGE(TAG, "Failed to create touch queue");
+    return false;
+  }
+
+  if (penIrqGpio_ != GPIO_NUM_NC) {
+    gpio_config_t io_conf = {};
+    io_conf.intr_type = GPIO_INTR_NEGEDGE;
+    io_conf.mode = GPIO_MODE_INPUT;
+    io_conf.pin_bit_mask = 1ULL << static_cast<uint32_t>(penIrqGpio_);
+    io_conf.pull_down_en = GPIO_PULLDOWN_DISABLE;
+    io_conf.pull_up_en = GPIO_PULLUP_ENABLE;
+
+    const esp_err_t isrServiceErr = gpio_install_isr_service(ESP_INTR_FLAG_IRAM);
+    if (gpio_config(&io_conf) != ESP_OK || (isrServiceErr != ESP_OK && isrServiceErr != ESP_ERR_INVALID_STATE) ||
+        gpio_isr_handler_add(penIrqGpio_, pen_isr_handler, this) != ESP_OK) {
+      ESP_LOGW(TAG, "PENIRQ on GPIO %d unavailable; falling back to polling", static_cast<int>(penIrqGpio_));
+      penIrqGpio_ = GPIO_NUM_NC;
+    }
+  }
+
+  if (xTaskCreatePinnedToCore(sample_task_trampoline, "touch_sample", 3072, this, CONFIG_LVGL_TASK_PRIORITY,
+                              &sampleTask_, CONFIG_LVGL_TASK_CORE) != pdPASS) {
+    ESP_LOGE(TAG, "Failed to create touch sampling task");
+    if (penIrqGpio_ != GPIO_NUM_NC) {
+      gpio_isr_handler_remove(penIrqGpio_);
+      penIrqGpio_ = GPIO_NUM_NC;
+    }
+    vQueueDelete(queue_);
+    queue_ = nullptr;
+    return false;
+  }
+
+  initialized_ = true;
+  ESP_LOGI(TAG, "Touch sampling task started (%s)", penIrqGpio_ != GPIO_NUM_NC ? "PENIRQ" : "polling");
+  return true;
+}
+
+// Removes the ISR, deletes the sampling task and releases the queue.
+void TouchInput::deinit() {
+  if (!initialized_) {
+    return;
+  }
+
+  if (penIrqGpio_ != GPIO_NUM_NC) {
+    gpio_isr_handler_remove(penIrqGpio_);
+    penIrqGpio_ = GPIO_NUM_NC;
+  }
+  if (sampleTask_ != nullptr) {
+    vTaskDelete(sampleTask_);
+    sampleTask_ = nullptr;
+  }
+  if (queue_ != nullptr) {
+    vQueueDelete(queue_);
+    queue_ = nullptr;
+  }
+
+  indev_ = nullptr;
+  lastQueuedPressed_ = false;
+  initialized_ = false;
+}
+
+} // namespace utilities
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include <driver/gpio.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+#include <lvgl.h>
+
+namespace utilities {
+
+// Samples the XPT2046 on a dedicated task and hands filtered, timestamped
+// points to the LVGL read callback through a queue, so LVGL never touches the
+// shared SPI bus itself. With a PENIRQ GPIO the task sleeps until the panel is
+// pressed; without one it polls at a fixed rate.
+class TouchInput {
+public:
+  struct TouchPoint {
+    int16_t x;
+    int16_t y;
+    bool pressed;
+    int64_t timestampUs; // esp_timer time the sample was taken
+  };
+
+  static std::shared_ptr<TouchInput> instance() {
+    static std::shared_ptr<TouchInput> s;
+    if (!s)
+      s.reset(new TouchInput());
+    return s;
+  }
+
+  TouchInput(const TouchInput &) = delete;
+  TouchInput &operator=(const TouchInput &) = delete;
+  ~TouchInput();
+
+  bool init(lv_indev_t *indev, gpio_num_t penIrqGpio = GPIO_NUM_NC);
+  void deinit();
+  bool readPoint(TouchPoint *point, bool *more);
+  bool isInitialized() const { return initialized_; }
+
+private:
+  TouchInput() = default;
+
+  static void IRAM_ATTR pen_isr_handler(void *arg);
+  static void sample_task_trampoline(void *arg);
+  void run();
+  bool sampleFiltered(int32_t *x, int32_t *y);
+  void publish(const TouchPoint &point);
+
+  lv_indev_t *indev_ = nullptr;
+  gpio_num_t penIrqGpio_ = GPIO_NUM_NC;
+  QueueHandle_t queue_ = nullptr;
+  TaskHandle_t sampleTask_ = nullptr;
+  int32_t filteredX_ = 0;
+  int32_t filteredY_ = 0;
+  std::atomic_bool lastQueuedPressed_{false};
+  bool initialized_ = false;
+};
+
+} // namespace utilities
@@ -3,22 +3,38 @@
  * @brief WiFi connection management and mDNS WiThrottle server discovery.
  *
  * Initialises the ESP32 WiFi station, connects using saved or manually entered
- * credentials and publishes lv_msg events for connection state changes. Also
- * runs a periodic mDNS query loop that discovers WiThrottle services on the
- * local network and maintains the withrottle_devices list.
+ * credentials and publishes lv_msg events for connection state changes.
+ * Several networks can be saved (see WifiNetworkStore); at boot the one
+ * joined last is rejoined directly, and if that fails one scan ranks the
+ * others, which are tried in turn. Also discovers WiThrottle services on the
+ * local network and maintains the registry of discovered devices (see
+ * DeviceRegistry).
+ *
+ * Discovery uses an mDNS browse: it sends one query when started, then the
+ * mdns task pushes every answer, announcement and goodbye as it arrives, so
+ * there is no polling. Each device keeps the TTL of its last answer; a light
+ * aging task drops devices that were not heard from within it and sends a
+ * single refresh query when a record is near expiry. TTLs are capped at
+ * MDNS_MAX_TTL_S so a command station that is switched off without a goodbye
+ * leaves the list within two minutes.
  */
 #include "WifiHandler.h"
+#include "BootTimeline.h"
 #include "definitions.h"
+#include "display/LvglTask.h"
 #include "display/MessageBox.h"
 #include "ui/lv_msg.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <esp_event.h>
 #include <esp_log.h>
 #include <esp_netif.h>
 #include <esp_task_wdt.h>
+#include <esp_timer.h>
 #include <freertos/event_groups.h>
 #include <lvgl.h>
 #include <lwip/inet.h>
-#include <map>
 #include <mdns.h>
 #include <memory>
 #include <nvs_flash.h>
@@ -26,9 +42,14 @@
 #include <string>
 #include <vector>
 
-#define MDNS_TIMEOUT 5000
-#define MDNS_QUERY_TIMEOUT 3000
+#define MDNS_SERVICE "_withrottle"
+#define MDNS_PROTO "_tcp"
+#define MDNS_AGING_INTERVAL_MS 500
+#define MDNS_QUERY_TIMEOUT 1000
 #define MDNS_MAX_RESULTS 10
+#define MDNS_MAX_TTL_S 120
+#define MDNS_REFRESH_PERCENT 80
+#define MDNS_STOP_TIMEOUT 2000
 
 // Short-lived FreeRTOS task that calls WifiHandler::WifiConnectTask and then
 // deletes itself.
@@ -49,15 +70,26 @@ static const char *TAG = "WifiHandler";
 
 EventGroupHandle_t WifiHandler::wifi_event_group;
 
-// --- New static variables used by the continuous mdns task (file-local) ---
+// State of the mDNS browse and its aging task (file-local).
 static volatile bool s_mdns_search_running = false;
 static TaskHandle_t s_mdns_search_task = nullptr;
-
-// Storage for discovered devices
-std::vector<WithrottleDevice> WifiHandler::withrottle_devices;
+static mdns_search_once_t *s_mdns_refresh_query = nullptr; // owned by the aging task
+
+// Traffic counters for the current search, logged when it stops.
+static std::atomic<uint32_t> s_mdns_queries_sent{0};
+static std::atomic<uint32_t> s_mdns_answers{0};
+static std::atomic<uint32_t> s_mdns_expired{0};
+static int64_t s_mdns_started_us = 0;
+
+// Discovered devices, shared by the mdns task, the aging task and the UI.
+DeviceRegistry &WifiHandler::withrottleDevices() {
+  static DeviceRegistry registry;
+  return registry;
+}
 
 // Initialises the esp_netif stack, creates the STA interface and configures
-// the WiFi driver with the project's default settings.
+// the WiFi driver with the project's default settings. Does not connect; call
+// loadAndConnect() once the UI is listening for the Wi-Fi messages.
 void WifiHandler::init_wifi() {
   ESP_LOGI(TAG, "Initializing WiFi");
   ESP_ERROR_CHECK(esp_netif_init());
@@ -69,8 +101,6 @@ void WifiHandler::init_wifi() {
   ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
 
   wifi_event_group_init();
-
-  loadAndConnect();
 }
 
 // esp_event_loop callback: handles WIFI_EVENT_STA_DISCONNECTED,
@@ -85,9 +115,9 @@ void WifiHandler::wifi_event_handler(void *arg, esp_event_base_t event_base, int
     self->connected = false;
     xEventGroupSetBits(wifi_event_group, WIFI_FAIL_BIT);
 
-    if (!self->manualConnectInProgress) {
+    if (!self->manualConnectInProgress && !self->fastRejoinInProgress && !self->candidatesRemaining) {
       ESP_LOGI(TAG, "Manual connect in progress, skipping disconnect handling");
-      lv_async_call(
+      display::LvglTask::asyncCall(
           [](void *arg) {
             auto payload =
                 new utilities::ReshowScreenData{"Connection Failed", "Please check your password and try again."};
@@ -96,11 +126,21 @@ void WifiHandler::wifi_event_handler(void *arg, esp_event_base_t event_base, int
           },
           self);
     }
+  } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_CONNECTED) {
+    if (self->fastRejoinInProgress && self->rejoinStaticIp) {
+      self->applyRejoinStaticIp();
+    }
   } else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
     ESP_LOGI(TAG, "WifiEventHandler: IP_EVENT_STA_GOT_IP");
+    self->logJoinTime();
+    BootTimeline::mark(BootTimeline::Milestone::WifiUp);
+#if CONFIG_WIFI_FAST_REJOIN
+    const auto *event = static_cast<ip_event_got_ip_t *>(event_data);
+    self->saveRejoinInfo(event->ip_info, event->esp_netif);
+#endif
     self->connected = true;
     xEventGroupSetBits(wifi_event_group, WIFI_CONNECTED_BIT);
-    lv_async_call(
+    display::LvglTask::asyncCall(
         [](void *) {
           lv_msg_send(MSG_WIFI_CONNECTED, NULL);
         },
@@ -117,64 +157,35 @@ void WifiHandler::wifi_event_group_init() {
   ESP_ERROR_CHECK(esp_event_handler_register(IP_EVENT, IP_EVENT_STA_GOT_IP, &wifi_event_handler, this));
 }
 
+// Adds the network in creds to the saved networks as the one joined last. A
+// store that cannot be read is replaced.
 esp_err_t WifiHandler::saveConfiguration() {
-  esp_err_t err;
   if (!creds) {
     ESP_LOGI(TAG, "creds is null");
     return ESP_FAIL;
   }
 
-  std::unique_ptr<nvs::NVSHandle> handle = nvs::open_nvs_handle(NVS_NAMESPACE_WIFI, NVS_READWRITE, &err);
-
-  if (err != ESP_OK) {
-    ESP_LOGE(TAG, "nvs_open failed: %s", esp_err_to_name(err));
-    return err;
-  }
-
-  err = handle->set_string(NVS_WIFI_SSID, creds->ssid);
-  if (err != ESP_OK) {
-    return err;
-  }
-
-  err = handle->set_string(NVS_WIFI_PWD, creds->password);
-  if (err != ESP_OK) {
-    return err;
-  }
-
-  err = handle->commit();
-  if (err != ESP_OK) {
-    return err;
-  }
-
-  return ESP_OK;
+  WifiNetworkStore store;
+  store.load();
+  return store.remember(creds->ssid, creds->password);
 }
 
-// Reads saved SSID/password from NVS and starts a connection task. If no
-// credentials are saved, calls noConnectionSaved().
+// Loads the saved networks and starts a connection task, handing it the one
+// joined last for the fast rejoin. If no networks are saved, calls
+// noConnectionSaved().
 void WifiHandler::loadAndConnect() {
-  esp_err_t err;
-
-  std::unique_ptr<nvs::NVSHandle> handle = nvs::open_nvs_handle(NVS_NAMESPACE_WIFI, NVS_READONLY, &err);
-  creds = std::make_shared<wifi_credentials_t>();
-  creds->wifiHandler = shared_from_this();
-
-  if (err != ESP_OK) {
-    ESP_LOGE(TAG, "nvs_open failed: %s", esp_err_to_name(err));
-    noConnectionSaved();
-    return;
-  }
-
-  err = handle->get_string(NVS_WIFI_SSID, creds->ssid, sizeof(creds->ssid));
-  if (err != ESP_OK) {
+  WifiNetworkStore store;
+  const KnownNetwork *latest = store.load() == ESP_OK ? store.mostRecent() : nullptr;
+  if (!latest) {
     noConnectionSaved();
     return;
   }
+  ESP_LOGI(TAG, "%u saved networks, last joined %s", (unsigned)store.networks().size(), latest->ssid);
 
-  err = handle->get_string(NVS_WIFI_PWD, creds->password, sizeof(creds->password));
-  if (err != ESP_OK) {
-    noConnectionSaved();
-    return;
-  }
+  creds = std::make_shared<wifi_credentials_t>();
+  creds->wifiHandler = shared_from_this();
+  strncpy(creds->ssid, latest->ssid, sizeof(creds->ssid));
+  strncpy(creds->password, latest->password, sizeof(creds->password));
 
   auto *taskCreds = new wifi_credentials_t(*creds);
   BaseType_t taskCreated =
@@ -188,15 +199,17 @@ void WifiHandler::loadAndConnect() {
 
 // Called when no saved WiFi credentials exist; publishes MSG_WIFI_NOT_SAVED.
 void WifiHandler::noConnectionSaved() {
-  lv_async_call(
+  display::LvglTask::asyncCall(
       [](void *) {
         lv_msg_send(MSG_WIFI_NOT_SAVED, NULL);
       },
       nullptr);
 }
 
-// FreeRTOS task body for automatic re-connection attempts using saved
-// credentials. Retries up to a fixed limit before publishing MSG_WIFI_FAILED.
+// FreeRTOS task body for automatic connection using the saved networks. Tries
+// a fast rejoin of the network joined last, then scans once and tries the
+// saved networks best first (see WifiNetworkStore::rank), moving on to the
+// next when one fails. Only a failure of the last one reaches the UI.
 void WifiHandler::WifiConnectTask(void *pvParameter) {
   manualConnectInProgress = false;
   stopMdnsSearchLoop();
@@ -204,11 +217,107 @@ void WifiHandler::WifiConnectTask(void *pvParameter) {
   connected = false;
   wifi_credentials_t *creds = (wifi_credentials_t *)pvParameter;
 
-  ESP_LOGI(TAG, "Connecting to SSID: %s", creds->ssid);
+#if CONFIG_WIFI_FAST_REJOIN
+  if (fastRejoin(creds)) {
+    vTaskDelete(NULL);
+    return;
+  }
+#endif
+
+  WifiNetworkStore store;
+  store.load();
+  std::vector<WifiCandidate> candidates =
+      store.networks().size() > 1 ? scanCandidates(store) : store.rank(nullptr, 0);
+  if (candidates.empty()) {
+    WifiCandidate candidate;
+    candidate.network = KnownNetwork{};
+    strncpy(candidate.network.ssid, creds->ssid, sizeof(candidate.network.ssid) - 1);
+    strncpy(candidate.network.password, creds->password, sizeof(candidate.network.password) - 1);
+    candidates.push_back(candidate);
+  }
+
+  for (size_t i = 0; i < candidates.size(); ++i) {
+    const bool lastCandidate = i + 1 == candidates.size();
+    const KnownNetwork &network = candidates[i].network;
+    esp_err_t err = joinCandidate(candidates[i], lastCandidate);
+    if (err == ESP_OK) {
+      store.remember(network.ssid, network.password);
+      break;
+    }
+    ESP_LOGW(TAG, "Could not join %s: %s", network.ssid, esp_err_to_name(err));
+    if (lastCandidate && err != ESP_FAIL && err != ESP_ERR_TIMEOUT) {
+      display::LvglTask::asyncCall(
+          [](void *arg) {
+            WifiFailedPayload payload{WifiFailedSource::ConnectAttempt, false};
+            lv_msg_send(MSG_WIFI_FAILED, &payload);
+          },
+          nullptr);
+    }
+  }
+  candidatesRemaining = false;
+
+  vTaskDelete(NULL);
+}
+
+// Scans once to rank the saved networks. If the scan fails they are tried
+// most recently joined first.
+std::vector<WifiCandidate> WifiHandler::scanCandidates(const WifiNetworkStore &store) {
+  const int64_t startUs = esp_timer_get_time();
+  wifi_scan_config_t scan_conf = {};
+  scan_conf.show_hidden = false;
+
+  std::vector<wifi_ap_record_t> records;
+  esp_err_t err = esp_wifi_start();
+  if (err == ESP_OK) {
+    err = esp_wifi_scan_start(&scan_conf, true);
+  }
+  if (err == ESP_OK) {
+    uint16_t count = DEFAULT_SCAN_LIST_SIZE;
+    records.resize(count);
+    err = esp_wifi_scan_get_ap_records(&count, records.data());
+    records.resize(err == ESP_OK ? count : 0);
+    esp_wifi_clear_ap_list();
+  }
+  if (err != ESP_OK) {
+    ESP_LOGW(TAG, "Scan for saved networks failed: %s", esp_err_to_name(err));
+  }
+
+  std::vector<WifiCandidate> candidates = store.rank(records.data(), records.size());
+  for (const auto &candidate : candidates) {
+    if (candidate.visible) {
+      ESP_LOGI(TAG, "Saved network %s: %d dBm on channel %u", candidate.network.ssid, candidate.rssi,
+               candidate.channel);
+    } else {
+      ESP_LOGI(TAG, "Saved network %s: not seen", candidate.network.ssid);
+    }
+  }
+  ESP_LOGI(TAG, "Scan for saved networks took %lld ms", (esp_timer_get_time() - startUs) / 1000);
+  return candidates;
+}
+
+// Full connect to one saved network, to the access point the scan found for
+// it if there was one. Returns ESP_OK once it has an address, ESP_FAIL when it
+// was disconnected, ESP_ERR_TIMEOUT when nothing happened within 10 s, or the
+// error from starting the connect.
+esp_err_t WifiHandler::joinCandidate(const WifiCandidate &candidate, bool lastCandidate) {
+  const KnownNetwork &network = candidate.network;
+  ESP_LOGI(TAG, "Connecting to SSID: %s", network.ssid);
+  startJoin(JoinPath::Full);
+
+  // saveRejoinInfo() records the access point under creds->ssid.
+  if (creds) {
+    strncpy(creds->ssid, network.ssid, sizeof(creds->ssid));
+    strncpy(creds->password, network.password, sizeof(creds->password));
+  }
 
   wifi_config_t wifi_config = {};
-  strncpy((char *)wifi_config.sta.ssid, creds->ssid, sizeof(wifi_config.sta.ssid));
-  strncpy((char *)wifi_config.sta.password, creds->password, sizeof(wifi_config.sta.password));
+  strncpy((char *)wifi_config.sta.ssid, network.ssid, sizeof(wifi_config.sta.ssid));
+  strncpy((char *)wifi_config.sta.password, network.password, sizeof(wifi_config.sta.password));
+  if (candidate.visible) {
+    wifi_config.sta.bssid_set = true;
+    memcpy(wifi_config.sta.bssid, candidate.bssid, sizeof(wifi_config.sta.bssid));
+    wifi_config.sta.channel = candidate.channel;
+  }
 
   ESP_ERROR_CHECK(esp_wifi_stop());
   vTaskDelay(pdMS_TO_TICKS(100));
@@ -218,28 +327,31 @@ void WifiHandler::WifiConnectTask(void *pvParameter) {
   ESP_ERROR_CHECK(esp_wifi_start());
   vTaskDelay(pdMS_TO_TICKS(100));
 
+  // Disconnects from a failed fast rejoin or an earlier network have been
+  // handled by now; from here on a disconnect is a real failure, unless
+  // another network is still to be tried.
+  fastRejoinInProgress = false;
+  candidatesRemaining = !lastCandidate;
+  xEventGroupClearBits(wifi_event_group, WIFI_CONNECTED_BIT | WIFI_FAIL_BIT);
+
   // Start connection
   esp_err_t err = esp_wifi_connect();
   if (err != ESP_OK) {
-    ESP_LOGE(TAG, "wifi connect failed: %s", esp_err_to_name(err));
-    lv_async_call(
-        [](void *arg) {
-          WifiFailedPayload payload{WifiFailedSource::ConnectAttempt, false};
-          lv_msg_send(MSG_WIFI_FAILED, &payload);
-        },
-        nullptr);
-    vTaskDelete(NULL);
-    return;
+    return err;
   }
 
   // Wait for result via events
-  // Optional: timeout (e.g., 10s)
   EventBits_t bits =
       xEventGroupWaitBits(wifi_event_group, WIFI_CONNECTED_BIT | WIFI_FAIL_BIT, pdTRUE, pdFALSE, pdMS_TO_TICKS(10000));
 
   connected = bits & WIFI_CONNECTED_BIT;
-
-  vTaskDelete(NULL);
+  if (connected) {
+    return ESP_OK;
+  }
+  if (!lastCandidate) {
+    esp_wifi_disconnect();
+  }
+  return (bits & WIFI_FAIL_BIT) ? ESP_FAIL : ESP_ERR_TIMEOUT;
 }
 
 // FreeRTOS task body for a manual connection attempt (user-supplied SSID +
@@ -253,6 +365,7 @@ void WifiHandler::WifiConnectManualTask(void *pvParameter) {
   wifi_credentials_t *creds = (wifi_credentials_t *)pvParameter;
 
   ESP_LOGI(TAG, "Manually Connecting to SSID: %s", creds->ssid);
+  startJoin(JoinPath::Manual);
 
   wifi_config_t wifi_config = {};
   strncpy((char *)wifi_config.sta.ssid, creds->ssid, sizeof(wifi_config.sta.ssid));
@@ -270,7 +383,7 @@ void WifiHandler::WifiConnectManualTask(void *pvParameter) {
   esp_err_t err = esp_wifi_connect();
   if (err != ESP_OK) {
     ESP_LOGE(TAG, "wifi connect failed: %s", esp_err_to_name(err));
-    lv_async_call(
+    display::LvglTask::asyncCall(
         [](void *arg) {
           auto payload =
               new utilities::ReshowScreenData{"Connection Failed", "Please check your password and try again."};
@@ -292,6 +405,162 @@ void WifiHandler::WifiConnectManualTask(void *pvParameter) {
   vTaskDelete(NULL);
 }
 
+#if CONFIG_WIFI_FAST_REJOIN
+// Joins the access point remembered from the last connection directly: no
+// stop/start delays and no scan, and with CONFIG_WIFI_FAST_REJOIN_STATIC_IP no
+// DHCP either. Returns false, with Wi-Fi left for the full connect, when
+// nothing is remembered for this SSID or no address arrives in time.
+bool WifiHandler::fastRejoin(const wifi_credentials_t *creds) {
+  if (!loadRejoinInfo(rejoinInfo, creds->ssid)) {
+    return false;
+  }
+
+  ESP_LOGI(TAG, "Fast rejoin to SSID: %s, channel %u", creds->ssid, rejoinInfo.channel);
+  startJoin(JoinPath::FastRejoin);
+  fastRejoinInProgress = true;
+#if CONFIG_WIFI_FAST_REJOIN_STATIC_IP
+  rejoinStaticIp = rejoinInfo.ip != 0;
+#endif
+
+  wifi_config_t wifi_config = {};
+  strncpy((char *)wifi_config.sta.ssid, creds->ssid, sizeof(wifi_config.sta.ssid));
+  strncpy((char *)wifi_config.sta.password, creds->password, sizeof(wifi_config.sta.password));
+  wifi_config.sta.bssid_set = true;
+  memcpy(wifi_config.sta.bssid, rejoinInfo.bssid, sizeof(wifi_config.sta.bssid));
+  wifi_config.sta.channel = rejoinInfo.channel;
+  wifi_config.sta.scan_method = WIFI_FAST_SCAN;
+
+  xEventGroupClearBits(wifi_event_group, WIFI_CONNECTED_BIT | WIFI_FAIL_BIT);
+  esp_err_t err = esp_wifi_set_config(WIFI_IF_STA, &wifi_config);
+  if (err == ESP_OK) {
+    err = esp_wifi_start();
+  }
+  if (err == ESP_OK) {
+    err = esp_wifi_connect();
+  }
+
+  EventBits_t bits = 0;
+  if (err == ESP_OK) {
+    bits = xEventGroupWaitBits(wifi_event_group, WIFI_CONNECTED_BIT | WIFI_FAIL_BIT, pdTRUE, pdFALSE,
+                               pdMS_TO_TICKS(CONFIG_WIFI_FAST_REJOIN_TIMEOUT_MS));
+  }
+  if (bits & WIFI_CONNECTED_BIT) {
+    connected = true;
+    fastRejoinInProgress = false;
+    return true;
+  }
+
+  ESP_LOGW(TAG, "Fast rejoin failed (%s), using full connect",
+           err != ESP_OK ? esp_err_to_name(err) : (bits & WIFI_FAIL_BIT) ? "disconnected" : "timed out");
+  esp_wifi_disconnect();
+  return false;
+}
+
+// Reads the remembered access point into `info`. False if there is none, or
+// it was remembered for a different SSID.
+bool WifiHandler::loadRejoinInfo(RejoinInfo &info, const char *ssid) {
+  esp_err_t err;
+  std::unique_ptr<nvs::NVSHandle> handle = nvs::open_nvs_handle(NVS_NAMESPACE_WIFI, NVS_READONLY, &err);
+  if (err != ESP_OK) {
+    return false;
+  }
+  RejoinInfo stored{};
+  err = handle->get_blob(NVS_WIFI_REJOIN, &stored, sizeof(stored));
+  if (err != ESP_OK || stored.channel == 0 || strncmp(stored.ssid, ssid, sizeof(stored.ssid)) != 0) {
+    return false;
+  }
+  info = stored;
+  return true;
+}
+
+// Remembers the access point and address of the connection that just got
+// `ipInfo`. Written only when something changed, to spare the flash.
+void WifiHandler::saveRejoinInfo(const esp_netif_ip_info_t &ipInfo, esp_netif_t *netif) {
+  wifi_ap_record_t ap;
+  if (!creds || esp_wifi_sta_get_ap_info(&ap) != ESP_OK) {
+    return;
+  }
+
+  RejoinInfo info{};
+  strncpy(info.ssid, creds->ssid, sizeof(info.ssid) - 1);
+  memcpy(info.bssid, ap.bssid, sizeof(info.bssid));
+  info.channel = ap.primary;
+  info.ip = ipInfo.ip.addr;
+  info.netmask = ipInfo.netmask.addr;
+  info.gateway = ipInfo.gw.addr;
+  esp_netif_dns_info_t dns;
+  if (netif && esp_netif_get_dns_info(netif, ESP_NETIF_DNS_MAIN, &dns) == ESP_OK && dns.ip.type == ESP_IPADDR_TYPE_V4) {
+    info.dns = dns.ip.u_addr.ip4.addr;
+  }
+  if (memcmp(&info, &rejoinInfo, sizeof(info)) == 0) {
+    return;
+  }
+  rejoinInfo = info;
+
+  esp_err_t err;
+  std::unique_ptr<nvs::NVSHandle> handle = nvs::open_nvs_handle(NVS_NAMESPACE_WIFI, NVS_READWRITE, &err);
+  if (err == ESP_OK) {
+    err = handle->set_blob(NVS_WIFI_REJOIN, &info, sizeof(info));
+  }
+  if (err == ESP_OK) {
+    err = handle->commit();
+  }
+  if (err != ESP_OK) {
+    ESP_LOGW(TAG, "Failed to save Wi-Fi rejoin info: %s", esp_err_to_name(err));
+  }
+}
+#endif
+
+// Called on association during a fast rejoin: stops DHCP and applies the
+// remembered address. Setting it raises IP_EVENT_STA_GOT_IP as DHCP would.
+void WifiHandler::applyRejoinStaticIp() {
+  esp_netif_t *netif = esp_netif_get_handle_from_ifkey("WIFI_STA_DEF");
+  if (!netif) {
+    return;
+  }
+  esp_netif_dhcpc_stop(netif);
+
+  esp_netif_ip_info_t ipInfo = {};
+  ipInfo.ip.addr = rejoinInfo.ip;
+  ipInfo.netmask.addr = rejoinInfo.netmask;
+  ipInfo.gw.addr = rejoinInfo.gateway;
+  esp_err_t err = esp_netif_set_ip_info(netif, &ipInfo);
+  if (err != ESP_OK) {
+    ESP_LOGW(TAG, "Static IP failed (%s), using DHCP", esp_err_to_name(err));
+    rejoinStaticIp = false;
+    esp_netif_dhcpc_start(netif);
+    return;
+  }
+  if (rejoinInfo.dns != 0) {
+    esp_netif_dns_info_t dns = {};
+    dns.ip.type = ESP_IPADDR_TYPE_V4;
+    dns.ip.u_addr.ip4.addr = rejoinInfo.dns;
+    esp_netif_set_dns_info(netif, ESP_NETIF_DNS_MAIN, &dns);
+  }
+}
+
+// Records which path is joining and when it started. Any other path than a
+// fast rejoin goes back to DHCP if a static address was applied.
+void WifiHandler::startJoin(JoinPath path) {
+  joinPath = path;
+  joinStartUs = esp_timer_get_time();
+  if (path != JoinPath::FastRejoin && rejoinStaticIp) {
+    rejoinStaticIp = false;
+    if (esp_netif_t *netif = esp_netif_get_handle_from_ifkey("WIFI_STA_DEF")) {
+      esp_netif_dhcpc_start(netif);
+    }
+  }
+}
+
+// Logs how long the current join took to get an address, and how long after
+// boot that was.
+void WifiHandler::logJoinTime() const {
+  static const char *const kPathNames[] = {"unknown path", "fast rejoin", "full connect", "manual connect"};
+  const int64_t now = esp_timer_get_time();
+  ESP_LOGI(TAG, "Got IP via %s%s in %lld ms, %lld ms after boot", kPathNames[static_cast<int>(joinPath)],
+           rejoinStaticIp ? " (static IP)" : "", (now - joinStartUs) / 1000, now / 1000);
+}
+
 // Spawns either WifiConnectTask or WifiConnectManualTask depending on
 // manualConnect, passing ssid and password.
 void WifiHandler::create_wifi_connect_task(const char *ssid, const char *password, bool manualConnect) {
@@ -331,70 +600,66 @@ std::string WifiHandler::getIpAddress() const {
   return {};
 }
 
-// New: start an mDNS search for _withrottle and populate withrottle_devices
-// Runs a single synchronous mDNS query for "_withrottle._tcp" services and
-// populates withrottle_devices with the results.
-void WifiHandler::searchMdnsWithrottle() {
-  ESP_LOGI(TAG, "Starting mDNS search for service '_withrottle'");
-  // mdns_init() is called once in startMdnsSearchLoop(). Calling it again here
-  // returns ESP_ERR_INVALID_STATE, which would abort via ESP_ERROR_CHECK.
 
-  // Query for PTR records of the service; service string usually includes proto, e.g. "_withrottle._tcp".
-  const char *service = "_withrottle";
-  mdns_result_t *results = nullptr;
-  esp_err_t err = mdns_query_ptr(service, "_tcp", 3000, 10, &results);
+// Browse callback, run on the mdns task whenever an answer for _withrottle._tcp
+// arrives or changes, including goodbyes (TTL 0). The results belong to mdns.
+static void mdns_browse_notifier(mdns_result_t *results) { WifiHandler::instance()->handleMdnsResults(results); }
 
-  if (err != ESP_OK) {
-    ESP_LOGE(TAG, "mdns_query_ptr('%s') failed: %s", service, esp_err_to_name(err));
+// Sends one PTR query for "_withrottle._tcp" without waiting for the answers;
+// the aging task collects them. Does nothing while a query is still out. Only
+// called from the aging task.
+void WifiHandler::searchMdnsWithrottle() {
+  if (s_mdns_refresh_query) {
     return;
   }
+  s_mdns_refresh_query = mdns_query_async_new(nullptr, MDNS_SERVICE, MDNS_PROTO, MDNS_TYPE_PTR, MDNS_QUERY_TIMEOUT,
+                                              MDNS_MAX_RESULTS, nullptr);
+  if (!s_mdns_refresh_query) {
+    ESP_LOGE(TAG, "mdns_query_async_new('%s') failed", MDNS_SERVICE);
+    return;
+  }
+  ++s_mdns_queries_sent;
+}
 
-  handleMdnsResults(results);
+// Hands the answers to a finished refresh query to handleMdnsResults() and
+// frees the query.
+static void mdns_collect_refresh_query(WifiHandler *self) {
+  mdns_result_t *results = nullptr;
+  uint8_t count = 0;
+  if (!s_mdns_refresh_query || !mdns_query_async_get_results(s_mdns_refresh_query, 0, &results, &count)) {
+    return;
+  }
+  self->handleMdnsResults(results);
   mdns_query_results_free(results);
+  mdns_query_async_delete(s_mdns_refresh_query);
+  s_mdns_refresh_query = nullptr;
 }
 
-// Background task entry used for continuous searching.
-// FreeRTOS task body: periodically calls searchMdnsWithrottle() and publishes
-// MSG_MDNS_SEARCH_UPDATED until the stop flag is set.
+// FreeRTOS task body: discovery itself is pushed by the browse, so this only
+// ages the device list, re-queries records that are close to expiring and
+// collects the answers, until the stop flag is set.
 static void mdns_search_task_fn(void *arg) {
-  struct TaskParams {
-    WifiHandler *self;
-    uint32_t interval_ms;
-    uint32_t query_timeout_ms;
-    size_t max_results;
-  };
-
-  TaskParams *p = static_cast<TaskParams *>(arg);
-  WifiHandler *self = p->self;
-  uint32_t interval = p->interval_ms;
-  uint32_t qtimeout = p->query_timeout_ms;
-  size_t maxr = p->max_results;
-
-  // ESP_LOGI(TAG, "mDNS search loop started with interval=%u ms, query_timeout=%u ms, max_results=%u", interval,
-  // qtimeout,
-  //          (unsigned)maxr);
-
-  // loop until stopped
+  WifiHandler *self = static_cast<WifiHandler *>(arg);
+
   while (s_mdns_search_running) {
-    self->searchMdnsWithrottle();
-    // wait interval while allowing task to be cancelled
-    for (uint32_t waited = 0; waited < interval && s_mdns_search_running; waited += 200) {
-      vTaskDelay(pdMS_TO_TICKS(200));
+    vTaskDelay(pdMS_TO_TICKS(MDNS_AGING_INTERVAL_MS));
+    mdns_collect_refresh_query(self);
+    if (self->expireWithrottleDevices() && s_mdns_search_running) {
+      self->searchMdnsWithrottle();
     }
-    // if (s_mdns_search_running)
-    //   ESP_LOGI(TAG, "mDNS search again");
   }
 
-  // ESP_LOGI(TAG, "mDNS search task exiting 1");
-  // cleanup
+  if (s_mdns_refresh_query) {
+    mdns_query_async_delete(s_mdns_refresh_query);
+    s_mdns_refresh_query = nullptr;
+  }
   s_mdns_search_task = nullptr;
-  free(p);
   vTaskDelete(nullptr);
-  // ESP_LOGI(TAG, "mDNS search task exiting 2");
 }
 
-// Start continuous mDNS search loop. Safe to call repeatedly.
-// Starts the mDNS discovery loop task if it is not already running.
+// Starts browsing for WiThrottle servers and the aging task. The browse sends
+// its first query straight away and reports answers as they arrive, so known
+// servers show within a few hundred milliseconds. Safe to call repeatedly.
 void WifiHandler::startMdnsSearchLoop() {
   if (s_mdns_search_running) {
     ESP_LOGI(TAG, "mDNS search loop already running");
@@ -408,41 +673,39 @@ void WifiHandler::startMdnsSearchLoop() {
     // still proceed — mdns may be unavailable
   }
 
+  s_mdns_queries_sent = 0;
+  s_mdns_answers = 0;
+  s_mdns_expired = 0;
+  s_mdns_started_us = esp_timer_get_time();
   s_mdns_search_running = true;
 
-  // allocate params for task
-  struct TaskParams {
-    WifiHandler *self;
-    uint32_t interval_ms;
-    uint32_t query_timeout_ms;
-    size_t max_results;
-  };
-
-  TaskParams *p = (TaskParams *)malloc(sizeof(TaskParams));
-  p->self = this;
-  p->interval_ms = MDNS_TIMEOUT;
-  p->query_timeout_ms = MDNS_QUERY_TIMEOUT;
-  p->max_results = MDNS_MAX_RESULTS;
-
-  BaseType_t ok = xTaskCreate(&mdns_search_task_fn, "mdns_search", 6144, p, tskIDLE_PRIORITY + 1, &s_mdns_search_task);
+  BaseType_t ok =
+      xTaskCreate(&mdns_search_task_fn, "mdns_search", 6144, this, tskIDLE_PRIORITY + 1, &s_mdns_search_task);
   if (ok != pdPASS) {
     ESP_LOGE(TAG, "Failed to create mdns_search task");
     s_mdns_search_running = false;
-    free(p);
+    return;
+  }
+
+  if (mdns_browse_new(MDNS_SERVICE, MDNS_PROTO, &mdns_browse_notifier) == nullptr) {
+    ESP_LOGE(TAG, "mdns_browse_new('%s') failed", MDNS_SERVICE);
+  } else {
+    ++s_mdns_queries_sent;
   }
 }
 
-// Stop the continuous mDNS search loop.
-// Signals the mDNS task to stop and blocks until it exits.
+// Stops the browse, signals the aging task to stop and blocks until it exits,
+// then logs how much mDNS traffic the session caused.
 void WifiHandler::stopMdnsSearchLoop() {
   ESP_LOGI(TAG, "Stopping mDNS search loop");
   if (!s_mdns_search_running)
     return;
 
   s_mdns_search_running = false;
+  mdns_browse_delete(MDNS_SERVICE, MDNS_PROTO);
 
   // wait briefly for task to exit
-  const TickType_t deadline = xTaskGetTickCount() + pdMS_TO_TICKS(MDNS_TIMEOUT);
+  const TickType_t deadline = xTaskGetTickCount() + pdMS_TO_TICKS(MDNS_STOP_TIMEOUT);
   while (s_mdns_search_task != nullptr && xTaskGetTickCount() < deadline) {
     vTaskDelay(pdMS_TO_TICKS(50));
   }
@@ -452,32 +715,50 @@ void WifiHandler::stopMdnsSearchLoop() {
   } else {
     ESP_LOGI(TAG, "mdns search loop stopped");
   }
+  ESP_LOGI(TAG, "mDNS traffic: %u queries sent, %u answers, %u devices expired in %lld s",
+           static_cast<unsigned>(s_mdns_queries_sent), static_cast<unsigned>(s_mdns_answers),
+           static_cast<unsigned>(s_mdns_expired), (esp_timer_get_time() - s_mdns_started_us) / 1000000);
 }
 
-// New: parse a linked list of mdns_result_t and add devices to the list
-// Iterates over raw mdns_result_t records and calls addWithrottleDeviceFromResult
-// for each one, then frees the result list.
+// Iterates over raw mdns_result_t records and calls
+// addWithrottleDeviceFromResult for each one. The caller frees the list.
 void WifiHandler::handleMdnsResults(mdns_result_t *results) {
   for (mdns_result_t *r = results; r != nullptr; r = r->next) {
+    ++s_mdns_answers;
     addWithrottleDeviceFromResult(r);
   }
-
-  // ESP_LOGI(TAG, "mDNS: found %u _withrottle device(s)", (unsigned)withrottle_devices.size());
 }
 
 // Logs a discovered WiThrottle device's hostname, IP and port.
-void WifiHandler::logMDNSResult(WithrottleDevice &dev) {
+void WifiHandler::logMDNSResult(const WithrottleDevice &dev) {
   ESP_LOGI(TAG, "MDNS Instance: %s", dev.instance.c_str());
   ESP_LOGI(TAG, "MDNS Hostname: %s", dev.hostname.c_str());
-  ESP_LOGI(TAG, "MDNS IP Address: %s:%d", dev.ip.c_str(), dev.port);
+  ESP_LOGI(TAG, "MDNS IP Address: %s:%d", dev.ipString().c_str(), dev.port);
   for (auto &txt : dev.txt) {
     ESP_LOGI(TAG, "MDNS TXT: %s = %s", txt.first.c_str(), txt.second.c_str());
   }
 }
 
-// New: convert a single mdns_result_t into a WithrottleDevice and append to list
-// Extracts hostname, IP address, port and instance name from a single
-// mdns_result_t record and upserts it into withrottle_devices.
+static void post_mdns_device_added() {
+  display::LvglTask::asyncCall(
+      [](void *) {
+        lv_msg_send(MSG_MDNS_DEVICE_ADDED, NULL);
+      },
+      nullptr);
+}
+
+static void post_mdns_device_changed() {
+  display::LvglTask::asyncCall(
+      [](void *) {
+        lv_msg_send(MSG_MDNS_DEVICE_CHANGED, NULL);
+      },
+      nullptr);
+}
+
+// Extracts hostname, IP address, port, instance name and TTL from a single
+// mdns_result_t record and records it in the device registry. A TTL of 0 is
+// a goodbye and removes the device. Answers without an IPv4 address yet only
+// refresh a known device; the browse reports again once the address arrives.
 void WifiHandler::addWithrottleDeviceFromResult(mdns_result_t *r) {
   if (!r)
     return;
@@ -492,57 +773,67 @@ void WifiHandler::addWithrottleDeviceFromResult(mdns_result_t *r) {
   // port
   dev.port = r->port;
 
-  // IP (IPv4)
-  if (r->addr && r->addr->addr.type == IPADDR_TYPE_V4) {
-    esp_ip4_addr_t ipaddr = r->addr->addr.u_addr.ip4;
-    dev.ip = std::to_string(esp_ip4_addr1_16(&ipaddr)) + '.' + std::to_string(esp_ip4_addr2_16(&ipaddr)) + '.' +
-             std::to_string(esp_ip4_addr3_16(&ipaddr)) + '.' + std::to_string(esp_ip4_addr4_16(&ipaddr));
-  } else if (r->addr && r->addr->addr.type == IPADDR_TYPE_V6) {
-    dev.ip = "<ipv6>";
+  // IP (IPv4), kept in network byte order
+  for (mdns_ip_addr_t *addr = r->addr; addr != nullptr; addr = addr->next) {
+    if (addr->addr.type == IPADDR_TYPE_V4) {
+      dev.ipv4 = addr->addr.u_addr.ip4.addr;
+      break;
+    }
   }
 
   // TXT items
-  for (size_t i = 0; i < r->txt_count; ++i) {
-    if (r->txt && r->txt[i].key) {
-      std::string key = r->txt[i].key;
-      std::string value = r->txt[i].value ? r->txt[i].value : "";
-      dev.txt.emplace(key, value);
+  if (r->txt) {
+    dev.txt.reserve(r->txt_count);
+    for (size_t i = 0; i < r->txt_count; ++i) {
+      if (r->txt[i].key) {
+        dev.txt.emplace_back(r->txt[i].key, r->txt[i].value ? r->txt[i].value : "");
+      }
     }
   }
 
-  // Ensure only unique hosts are kept: match by hostname (prefer) or IP.
-  for (auto &existing : withrottle_devices) {
-    if (!dev.ip.empty() && !existing.ip.empty() && dev.ip == existing.ip) {
-      if (dev.instance != existing.instance || dev.port != existing.port || dev.hostname != existing.hostname) {
-        ESP_LOGI(TAG, "mDNS: IP match but different values, updating existing device (ip): %s", existing.ip.c_str());
-        logMDNSResult(dev);
-        // update existing entry (IP match)
-        existing.instance = dev.instance;
-        existing.port = dev.port;
-        existing.hostname = dev.hostname;
-        existing.txt = dev.txt;
-        lv_async_call(
-            [](void *) {
-              lv_msg_send(MSG_MDNS_DEVICE_CHANGED, NULL);
-            },
-            nullptr);
-      }
-      return;
+  if (r->ttl == 0) {
+    if (withrottleDevices().remove(dev) == DeviceRegistry::Change::Removed) {
+      ESP_LOGI(TAG, "mDNS: device said goodbye: %s", dev.instance.c_str());
+      post_mdns_device_changed();
     }
+    return;
   }
 
-  // not found => append
-  ESP_LOGI(TAG, "mDNS: adding new device (ip): %s", dev.ip.c_str());
-  logMDNSResult(dev);
-  withrottle_devices.push_back(std::move(dev));
-  lv_async_call(
-      [](void *) {
-        lv_msg_send(MSG_MDNS_DEVICE_ADDED, NULL);
-      },
-      nullptr);
+  const uint32_t ttl = std::min<uint32_t>(r->ttl, MDNS_MAX_TTL_S);
+  switch (withrottleDevices().upsert(dev, ttl, esp_timer_get_time())) {
+  case DeviceRegistry::Change::Added:
+    ESP_LOGI(TAG, "mDNS: adding new device (ip): %s", dev.ipString().c_str());
+    logMDNSResult(dev);
+    post_mdns_device_added();
+    break;
+  case DeviceRegistry::Change::Changed:
+    ESP_LOGI(TAG, "mDNS: IP match but different values, updating existing device (ip): %s", dev.ipString().c_str());
+    logMDNSResult(dev);
+    post_mdns_device_changed();
+    break;
+  default:
+    break;
+  }
 }
 
-// New: getter for the discovered devices
-// Returns a copy of the current withrottle_devices list.
-std::vector<WithrottleDevice> WifiHandler::getWithrottleDevices() const { return withrottle_devices; }
+// Drops devices whose TTL ran out without a fresh answer. Returns true when a
+// device has passed MDNS_REFRESH_PERCENT of its TTL, so it should be queried
+// again before it expires (RFC 6762 section 5.2 does the same).
+bool WifiHandler::expireWithrottleDevices() {
+  size_t expired = 0;
+  const bool refresh = withrottleDevices().expire(esp_timer_get_time(), MDNS_REFRESH_PERCENT, &expired);
+  if (expired > 0) {
+    ESP_LOGI(TAG, "mDNS: %u device(s) expired", static_cast<unsigned>(expired));
+    s_mdns_expired += expired;
+    post_mdns_device_changed();
+  }
+  return refresh;
+}
+
+// Returns the current device list. The snapshot is shared, not copied, and
+// stays valid while held.
+DeviceRegistry::Snapshot WifiHandler::getWithrottleDevices() const { return withrottleDevices().snapshot(); }
+
+// Bumped whenever a device is added, changed or removed.
+uint32_t WifiHandler::withrottleDevicesVersion() const { return withrottleDevices().version(); }
 } // namespace utilities
@@ -1,10 +1,10 @@
 #pragma once
 #include <memory>
 
+#include "DeviceRegistry.h"
+#include "WifiNetworkStore.h"
 #include <esp_wifi.h>
-#include <map>
 #include <mdns.h>
-#include <vector>
 
 namespace utilities {
 
@@ -15,14 +15,6 @@ typedef struct {
   std::shared_ptr<WifiHandler> wifiHandler;
 } wifi_credentials_t;
 
-struct WithrottleDevice {
-  std::string instance;
-  std::string hostname;
-  std::string ip;
-  uint16_t port = 0;
-  std::map<std::string, std::string> txt;
-};
-
 struct ReshowScreenData {
   std::string status;
   std::string subtitle;
@@ -66,16 +58,53 @@ public:
   void searchMdnsWithrottle();
   void handleMdnsResults(mdns_result_t *results);
   void addWithrottleDeviceFromResult(mdns_result_t *r);
-  std::vector<WithrottleDevice> getWithrottleDevices() const;
+  bool expireWithrottleDevices();
+  DeviceRegistry::Snapshot getWithrottleDevices() const;
+  uint32_t withrottleDevicesVersion() const;
   void startMdnsSearchLoop();
   void stopMdnsSearchLoop();
 
 private:
-  static std::vector<WithrottleDevice> withrottle_devices;
+  // The access point and address of the last connection, kept in NVS so the
+  // next boot can join without scanning (see fastRejoin()).
+  struct RejoinInfo {
+    char ssid[33];
+    uint8_t bssid[6];
+    uint8_t channel;
+    uint32_t ip; // network byte order, like the three below
+    uint32_t netmask;
+    uint32_t gateway;
+    uint32_t dns;
+  };
+
+  // How the current connection attempt is joining, for the boot-to-IP log.
+  enum class JoinPath {
+    None,
+    FastRejoin,
+    Full,
+    Manual,
+  };
+
+  static DeviceRegistry &withrottleDevices();
   bool connected = false;
   bool manualConnectInProgress = false;
-
-  void logMDNSResult(WithrottleDevice &r);
+  bool fastRejoinInProgress = false; // also covers the fallback, so its disconnects raise no popup
+  bool candidatesRemaining = false;   // another saved network will be tried if this one fails
+  bool rejoinStaticIp = false;
+  RejoinInfo rejoinInfo{};
+  JoinPath joinPath = JoinPath::None;
+  int64_t joinStartUs = 0;
+
+  bool fastRejoin(const wifi_credentials_t *creds);
+  std::vector<WifiCandidate> scanCandidates(const WifiNetworkStore &store);
+  esp_err_t joinCandidate(const WifiCandidate &candidate, bool lastCandidate);
+  bool loadRejoinInfo(RejoinInfo &info, const char *ssid);
+  void saveRejoinInfo(const esp_netif_ip_info_t &ipInfo, esp_netif_t *netif);
+  void applyRejoinStaticIp();
+  void startJoin(JoinPath path);
+  void logJoinTime() const;
+
+  void logMDNSResult(const WithrottleDevice &r);
 
 protected:
   WifiHandler() = default;
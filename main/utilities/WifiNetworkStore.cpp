@@ -0,0 +1,178 @@
+/**
+ * @file WifiNetworkStore.cpp
+ * @brief Known Wi-Fi networks and how to rank them at boot.
+ *
+ * The networks are stored as one fixed-size blob. Each successful join gets
+ * the next number in a sequence rather than a time, since there is no clock at
+ * boot; the highest number is the network joined last. Joining the same
+ * network again does not write to flash.
+ */
+#include "WifiNetworkStore.h"
+#include "definitions.h"
+
+#include <algorithm>
+#include <cstring>
+#include <esp_log.h>
+#include <memory>
+#include <nvs_handle.hpp>
+
+namespace utilities {
+
+static const char *TAG = "WIFI_NETWORKS";
+
+namespace {
+// NVS layout of the store.
+struct StoredNetworks {
+  uint32_t count;
+  KnownNetwork networks[WifiNetworkStore::kMaxNetworks];
+};
+} // namespace
+
+// Reads the networks from NVS. With no store saved yet, takes the single
+// network saved by earlier firmware, if any. Returns ESP_OK when nothing is
+// saved at all, leaving the store empty.
+esp_err_t WifiNetworkStore::load() {
+  networks_.clear();
+  esp_err_t err;
+  std::unique_ptr<nvs::NVSHandle> handle = nvs::open_nvs_handle(NVS_NAMESPACE_WIFI, NVS_READONLY, &err);
+  if (err == ESP_ERR_NVS_NOT_FOUND) {
+    return ESP_OK;
+  }
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "nvs_open failed: %s", esp_err_to_name(err));
+    return err;
+  }
+
+  auto stored = std::make_unique<StoredNetworks>();
+  err = handle->get_blob(NVS_WIFI_NETWORKS, stored.get(), sizeof(StoredNetworks));
+  if (err == ESP_OK) {
+    const size_t count = std::min<size_t>(stored->count, kMaxNetworks);
+    for (size_t i = 0; i < count; ++i) {
+      KnownNetwork network = stored->networks[i];
+      network.ssid[sizeof(network.ssid) - 1] = '\0';
+      network.password[sizeof(network.password) - 1] = '\0';
+      networks_.push_back(network);
+    }
+    return ESP_OK;
+  }
+  if (err != ESP_ERR_NVS_NOT_FOUND) {
+    ESP_LOGE(TAG, "Failed to read networks: %s", esp_err_to_name(err));
+    return err;
+  }
+
+  KnownNetwork legacy{};
+  if (handle->get_string(NVS_WIFI_SSID, legacy.ssid, sizeof(legacy.ssid)) == ESP_OK &&
+      handle->get_string(NVS_WIFI_PWD, legacy.password, sizeof(legacy.password)) == ESP_OK && legacy.ssid[0]) {
+    legacy.lastSuccess = 1;
+    networks_.push_back(legacy);
+  }
+  return ESP_OK;
+}
+
+// Records a successful join of `ssid`, adding it or updating its password.
+// When the store is full the network joined longest ago is dropped. Writes to
+// NVS only if something changed.
+esp_err_t WifiNetworkStore::remember(const char *ssid, const char *password) {
+  uint32_t newest = 0;
+  for (const auto &network : networks_) {
+    newest = std::max(newest, network.lastSuccess);
+  }
+
+  auto it = std::find_if(networks_.begin(), networks_.end(), [&](const KnownNetwork &network) {
+    return strncmp(network.ssid, ssid, sizeof(network.ssid)) == 0;
+  });
+  if (it != networks_.end() && it->lastSuccess == newest && newest != 0 &&
+      strncmp(it->password, password, sizeof(it->password)) == 0) {
+    return ESP_OK;
+  }
+
+  if (it == networks_.end()) {
+    if (networks_.size() == kMaxNetworks) {
+      it = std::min_element(networks_.begin(), networks_.end(), [](const KnownNetwork &a, const KnownNetwork &b) {
+        return a.lastSuccess < b.lastSuccess;
+      });
+      ESP_LOGI(TAG, "Store full, forgetting %s", it->ssid);
+    } else {
+      it = networks_.insert(networks_.end(), KnownNetwork{});
+    }
+    *it = KnownNetwork{};
+    strncpy(it->ssid, ssid, sizeof(it->ssid) - 1);
+  }
+  memset(it->password, 0, sizeof(it->password));
+  strncpy(it->password, password, sizeof(it->password) - 1);
+  it->lastSuccess = newest + 1;
+  return save();
+}
+
+// The network joined last, or nullptr when the store is empty.
+const KnownNetwork *WifiNetworkStore::mostRecent() const {
+  auto it = std::max_element(networks_.begin(), networks_.end(), [](const KnownNetwork &a, const KnownNetwork &b) {
+    return a.lastSuccess < b.lastSuccess;
+  });
+  return it == networks_.end() ? nullptr : &*it;
+}
+
+// Orders the known networks for connecting, given the access points a scan
+// found. Networks the scan saw come first, strongest first with
+// kLastNetworkBonusDb added for the one joined last, and use their strongest
+// access point. The rest follow, most recently joined first, in case they
+// are hidden or the scan missed them.
+std::vector<WifiCandidate> WifiNetworkStore::rank(const wifi_ap_record_t *records, size_t count) const {
+  const KnownNetwork *last = mostRecent();
+  std::vector<WifiCandidate> candidates;
+  candidates.reserve(networks_.size());
+  for (const auto &network : networks_) {
+    WifiCandidate candidate;
+    candidate.network = network;
+    for (size_t i = 0; i < count; ++i) {
+      const wifi_ap_record_t &ap = records[i];
+      if (strncmp(reinterpret_cast<const char *>(ap.ssid), network.ssid, sizeof(network.ssid)) != 0 ||
+          (candidate.visible && ap.rssi <= candidate.rssi)) {
+        continue;
+      }
+      candidate.visible = true;
+      candidate.rssi = ap.rssi;
+      memcpy(candidate.bssid, ap.bssid, sizeof(candidate.bssid));
+      candidate.channel = ap.primary;
+    }
+    candidates.push_back(candidate);
+  }
+
+  auto score = [&](const WifiCandidate &candidate) {
+    return candidate.rssi + (last && candidate.network.lastSuccess == last->lastSuccess ? kLastNetworkBonusDb : 0);
+  };
+  std::stable_sort(candidates.begin(), candidates.end(), [&](const WifiCandidate &a, const WifiCandidate &b) {
+    if (a.visible != b.visible) {
+      return a.visible;
+    }
+    if (a.visible && score(a) != score(b)) {
+      return score(a) > score(b);
+    }
+    return a.network.lastSuccess > b.network.lastSuccess;
+  });
+  return candidates;
+}
+
+// Writes all networks to NVS.
+esp_err_t WifiNetworkStore::save() const {
+  esp_err_t err;
+  std::unique_ptr<nvs::NVSHandle> handle = nvs::open_nvs_handle(NVS_NAMESPACE_WIFI, NVS_READWRITE, &err);
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "nvs_open failed: %s", esp_err_to_name(err));
+    return err;
+  }
+
+  auto stored = std::make_unique<StoredNetworks>();
+  stored->count = networks_.size();
+  std::copy(networks_.begin(), networks_.end(), stored->networks);
+  err = handle->set_blob(NVS_WIFI_NETWORKS, stored.get(), sizeof(StoredNetworks));
+  if (err == ESP_OK) {
+    err = handle->commit();
+  }
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to save networks: %s", esp_err_to_name(err));
+  }
+  return err;
+}
+
+} // namespace utilities
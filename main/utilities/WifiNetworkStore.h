@@ -0,0 +1,55 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <esp_err.h>
+#include <esp_wifi_types.h>
+
+namespace utilities {
+
+// Credentials for a network the controller has joined before.
+struct KnownNetwork {
+  char ssid[33];
+  char password[65];
+  uint32_t lastSuccess; // order of the last successful join, higher is more recent; 0 when never
+};
+
+// A known network to try, with what the boot scan saw of it.
+struct WifiCandidate {
+  KnownNetwork network{};
+  bool visible = false; // seen by the scan; the fields below are only set then
+  int8_t rssi = -127;
+  uint8_t bssid[6] = {};
+  uint8_t channel = 0;
+};
+
+// Up to kMaxNetworks Wi-Fi networks, kept as one blob in NVS so the controller
+// can move between sites without retyping passwords. A value type: load() a
+// copy where it is needed; remember() writes through to NVS. Credentials saved
+// by earlier firmware under the single SSID/password keys are read as one
+// network.
+class WifiNetworkStore {
+public:
+  static constexpr size_t kMaxNetworks = 8;
+  // The network joined last is preferred unless another is this much stronger,
+  // so two similar networks do not take turns.
+  static constexpr int kLastNetworkBonusDb = 10;
+
+  esp_err_t load();
+  esp_err_t remember(const char *ssid, const char *password);
+
+  const std::vector<KnownNetwork> &networks() const { return networks_; }
+  bool empty() const { return networks_.empty(); }
+  const KnownNetwork *mostRecent() const;
+  std::vector<WifiCandidate> rank(const wifi_ap_record_t *records, size_t count) const;
+
+private:
+  esp_err_t save() const;
+
+  std::vector<KnownNetwork> networks_;
+};
+
+} // namespace utilities